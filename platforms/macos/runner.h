@@ -7,6 +7,7 @@
 #include "platforms/macos/soundscope.h"
 #include "synth/core/config.h"
 #include "synth/core/cfg-output.h"
+#include "synth/filt/resampler.h"
 
 template <class Target>
 class Runner {
@@ -25,12 +26,21 @@ public:
 
     Runner& default_duration(float dur) { m_duration = dur; return *this; }
 
+    // Render at a different rate than the output.  The runner inserts
+    // a sample rate converter after the timbre outputs.
+    Runner& internal_sample_rate(Config::sample_rate_type rate)
+    {
+        m_config.set_sample_rate(rate);
+        return *this;
+    }
+
     Runner& invocation(int /*argc*/, char **/*argv*/)
     {
         // XXX insert godawful getopt stuff here.
         // usage:
         //    --duration=SECONDS
         //    --sample-rate=...
+        //    --internal-sample-rate=...
         //    --sample-format=...
         //    --channel-config=...
         //    --parallel / --serial
@@ -65,7 +75,8 @@ template <class Target>
 int
 Runner<Target>::run_serial()
 {
-    Soundscope out;
+    ResampleStage<Soundscope> out;
+    out.output_rate(m_output_config.sample_rate);
     Target target(m_config, out);
 
     int nframes = int(m_duration * m_config.sample_rate());
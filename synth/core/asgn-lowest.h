@@ -0,0 +1,94 @@
+#ifndef ASGN_LOWEST_included
+#define ASGN_LOWEST_included
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+
+#include "synth/core/asgn-track.h"
+
+// LowestPriorityAssigner steals the lowest priority voice.  Releasing
+// voices go before sounding ones.
+//
+// Unlike PriorityAssigner, the priority is computed once, when the
+// note starts, and must be less than LEVELS.  (E.g., the prioritizer
+// could return the velocity divided by 4, so soft notes are stolen
+// first.)  Each level keeps a VoiceBits of its voices, and a mask
+// tracks which levels are occupied, so choosing a voice is two bit
+// scans.
+//
+// It assigns the voice that has been idle longest.
+class LowestPriorityAssigner : public TrackingAssigner {
+
+public:
+
+    typedef std::function<unsigned(const Voice&)> prioritizer;
+
+    static const size_t LEVELS = 32;
+
+    LowestPriorityAssigner(Synth& synth, const prioritizer& f)
+    : TrackingAssigner{synth},
+      m_prio{f},
+      m_level{},
+      m_mask{}
+    {}
+
+    Voice *assign_idle_voice() override
+    {
+        return voice_or_null(take_idle());
+    }
+
+    Voice *choose_voice_to_steal() override
+    {
+        for (size_t r = 0; r < 2; r++) {
+            if (std::uint32_t mask = m_mask[r]) {
+                size_t level = __builtin_ctz(mask);
+                size_t i = m_voices[r][level].find_next(0);
+                assert(i != VoiceBits::NONE);
+                return &voice(i);
+            }
+        }
+        return nullptr;
+    }
+
+protected:
+
+    void state_changed(size_t i, State old, State s) override
+    {
+        // Remove at the old level before a retrigger sets the new one.
+        if (old == State::SOUNDING || old == State::RELEASING)
+            remove(i, old == State::RELEASING ? 0 : 1);
+        if (s == State::SOUNDING) {
+            unsigned p = m_prio(voice(i));
+            assert(p < LEVELS);
+            m_level[i] = p;
+        }
+        if (s == State::SOUNDING || s == State::RELEASING)
+            add(i, s == State::RELEASING ? 0 : 1);
+    }
+
+private:
+
+    // Row 0 is releasing voices, row 1 is sounding.
+    void add(size_t i, size_t row)
+    {
+        m_voices[row][m_level[i]].set(i);
+        m_mask[row] |= std::uint32_t(1) << m_level[i];
+    }
+
+    void remove(size_t i, size_t row)
+    {
+        auto& level = m_voices[row][m_level[i]];
+        level.reset(i);
+        if (!level.any())
+            m_mask[row] &= ~(std::uint32_t(1) << m_level[i]);
+    }
+
+    prioritizer m_prio;
+    std::uint8_t m_level[MAX_POLYPHONY];
+    std::uint32_t m_mask[2];
+    VoiceBits m_voices[2][LEVELS];
+
+};
+
+#endif /* !ASGN_LOWEST_included */
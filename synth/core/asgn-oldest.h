@@ -0,0 +1,29 @@
+#ifndef ASGN_OLDEST_included
+#define ASGN_OLDEST_included
+
+#include "synth/core/asgn-track.h"
+
+// OldestAssigner assigns the voice that has been idle longest, so
+// release tails ring as long as possible.  It steals the oldest
+// releasing note, or failing that, the oldest sounding note.
+class OldestAssigner : public TrackingAssigner {
+
+public:
+
+    OldestAssigner(Synth& synth)
+    : TrackingAssigner{synth}
+    {}
+
+    Voice *assign_idle_voice() override
+    {
+        return voice_or_null(take_idle());
+    }
+
+    Voice *choose_voice_to_steal() override
+    {
+        return voice_or_null(oldest_active());
+    }
+
+};
+
+#endif /* !ASGN_OLDEST_included */
@@ -0,0 +1,55 @@
+#ifndef ASGN_QUIET_included
+#define ASGN_QUIET_included
+
+#include <functional>
+
+#include "synth/core/asgn-track.h"
+
+// QuietestAssigner steals the quietest releasing voice.  A voice in
+// its release tail that has nearly faded is the least audible to
+// steal.  If no voice is releasing, it steals the oldest sounding
+// voice.  It assigns the voice that has been idle longest.
+//
+// The level comes from a meter function, e.g.,
+// `LevelFollower::voice_level`, which should be cheap: the meter is
+// read once per releasing voice, and only when a voice must be
+// stolen.
+class QuietestAssigner : public TrackingAssigner {
+
+public:
+
+    typedef std::function<float(const Voice&)> level_meter;
+
+    QuietestAssigner(Synth& synth, const level_meter& meter)
+    : TrackingAssigner{synth},
+      m_meter{meter}
+    {}
+
+    Voice *assign_idle_voice() override
+    {
+        return voice_or_null(take_idle());
+    }
+
+    Voice *choose_voice_to_steal() override
+    {
+        size_t quietest = NIL;
+        float min_level = 0;
+        for (size_t i = oldest(State::RELEASING); i != NIL; i = next(i)) {
+            float level = m_meter(voice(i));
+            if (quietest == NIL || level < min_level) {
+                quietest = i;
+                min_level = level;
+            }
+        }
+        if (quietest == NIL)
+            quietest = oldest(State::SOUNDING);
+        return voice_or_null(quietest);
+    }
+
+private:
+
+    level_meter m_meter;
+
+};
+
+#endif /* !ASGN_QUIET_included */
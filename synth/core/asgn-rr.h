@@ -0,0 +1,52 @@
+#ifndef ASGN_RR_included
+#define ASGN_RR_included
+
+#include "synth/core/asgn-track.h"
+
+// RoundRobinAssigner cycles through the voices in index order,
+// skipping busy ones.  It steals like OldestAssigner.
+class RoundRobinAssigner : public TrackingAssigner {
+
+public:
+
+    RoundRobinAssigner(Synth& synth)
+    : TrackingAssigner{synth},
+      m_rotor{0}
+    {
+        for (size_t i = 0; i < synth.polyphony; i++)
+            m_idle.set(i);
+    }
+
+    Voice *assign_idle_voice() override
+    {
+        size_t i = m_idle.find_next_cyclic(m_rotor);
+        if (i == VoiceBits::NONE)
+            return nullptr;
+        m_rotor = i + 1;
+        take_idle(i);
+        return &voice(i);
+    }
+
+    Voice *choose_voice_to_steal() override
+    {
+        return voice_or_null(oldest_active());
+    }
+
+protected:
+
+    void state_changed(size_t i, State, State s) override
+    {
+        if (s == State::IDLE)
+            m_idle.set(i);
+        else
+            m_idle.reset(i);
+    }
+
+private:
+
+    VoiceBits m_idle;
+    size_t m_rotor;
+
+};
+
+#endif /* !ASGN_RR_included */
@@ -0,0 +1,86 @@
+#ifndef ASGN_SAME_included
+#define ASGN_SAME_included
+
+#include <cassert>
+#include <cstdint>
+
+#include "synth/core/asgn-track.h"
+
+// SameNoteAssigner reuses the voice that last played the same note.
+// If that voice is idle, it is assigned again, so a repeated note
+// keeps its voice's per-voice variation.  If it is still active, it
+// is the one stolen, so a repeated note cuts itself off instead of
+// another note.  Otherwise it behaves like OldestAssigner.
+//
+// The note comes from `next_note`.  The last voice to play each note
+// is a table lookup.
+class SameNoteAssigner : public TrackingAssigner {
+
+public:
+
+    static const size_t NOTE_COUNT = 128;
+
+    SameNoteAssigner(Synth& synth)
+    : TrackingAssigner{synth},
+      m_next_note{0}
+    {
+        for (auto& v: m_note_voice)
+            v = NIL;
+        for (auto& n: m_voice_note)
+            n = NO_NOTE;
+    }
+
+    void next_note(std::uint8_t note) override
+    {
+        assert(note < NOTE_COUNT);
+        m_next_note = note;
+    }
+
+    Voice *assign_idle_voice() override
+    {
+        size_t i = same_note_voice();
+        if (i != NIL && state(i) == State::IDLE) {
+            take_idle(i);
+            return &voice(i);
+        }
+        return voice_or_null(take_idle());
+    }
+
+    Voice *choose_voice_to_steal() override
+    {
+        size_t i = same_note_voice();
+        if (i != NIL &&
+            (state(i) == State::SOUNDING || state(i) == State::RELEASING))
+            return &voice(i);
+        return voice_or_null(oldest_active());
+    }
+
+protected:
+
+    void state_changed(size_t i, State, State s) override
+    {
+        if (s == State::SOUNDING) {
+            auto old_note = m_voice_note[i];
+            if (old_note != NO_NOTE && m_note_voice[old_note] == i)
+                m_note_voice[old_note] = NIL;
+            m_voice_note[i] = m_next_note;
+            m_note_voice[m_next_note] = i;
+        }
+    }
+
+private:
+
+    static const std::uint8_t NO_NOTE = 0xFF;
+
+    size_t same_note_voice() const
+    {
+        return m_note_voice[m_next_note];
+    }
+
+    std::uint8_t m_next_note;
+    std::uint16_t m_note_voice[NOTE_COUNT];
+    std::uint8_t m_voice_note[MAX_POLYPHONY];
+
+};
+
+#endif /* !ASGN_SAME_included */
@@ -0,0 +1,230 @@
+#ifndef ASGN_TRACK_included
+#define ASGN_TRACK_included
+
+#include <cassert>
+#include <cstdint>
+
+#include "synth/core/assigners.h"
+#include "synth/core/sizes.h"
+#include "synth/core/synth.h"
+#include "synth/core/voice.h"
+
+
+// -- Voice Bits -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// VoiceBits is a set of voice indices in an array of words.  Finding
+// the next member is one bit scan per word, so a scan of 256 voices
+// touches at most four words.
+
+class VoiceBits {
+
+    typedef std::uint64_t word;
+    static const size_t WORD_BITS = 64;
+    static const size_t WORDS = (MAX_POLYPHONY + WORD_BITS - 1) / WORD_BITS;
+
+public:
+
+    static const size_t NONE = ~size_t(0);
+
+    VoiceBits()
+    : m_words{}
+    {}
+
+    bool test(size_t i) const
+    {
+        assert(i < MAX_POLYPHONY);
+        return m_words[i / WORD_BITS] >> i % WORD_BITS & 1;
+    }
+
+    void set(size_t i)
+    {
+        assert(i < MAX_POLYPHONY);
+        m_words[i / WORD_BITS] |= word(1) << i % WORD_BITS;
+    }
+
+    void reset(size_t i)
+    {
+        assert(i < MAX_POLYPHONY);
+        m_words[i / WORD_BITS] &= ~(word(1) << i % WORD_BITS);
+    }
+
+    bool any() const
+    {
+        for (auto w: m_words)
+            if (w)
+                return true;
+        return false;
+    }
+
+    // Lowest member >= i, or NONE.
+    size_t find_next(size_t i) const
+    {
+        if (i >= MAX_POLYPHONY)
+            return NONE;
+        size_t wi = i / WORD_BITS;
+        word w = m_words[wi] & ~word(0) << i % WORD_BITS;
+        while (true) {
+            if (w)
+                return wi * WORD_BITS + __builtin_ctzll(w);
+            if (++wi == WORDS)
+                return NONE;
+            w = m_words[wi];
+        }
+    }
+
+    // First member at or after i, wrapping around.
+    size_t find_next_cyclic(size_t i) const
+    {
+        size_t j = find_next(i);
+        return j == NONE ? find_next(0) : j;
+    }
+
+private:
+
+    word m_words[WORDS];
+
+};
+
+
+// -- Tracking Assigner  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// TrackingAssigner is a base for assigners that never scan the
+// voices.  It installs itself as the synth's assigner, so each voice
+// reports its state changes, and it keeps the voices in one intrusive
+// list per state, in the order they entered that state.  So the list
+// heads are the longest idle voice, the oldest sounding note, and so
+// on, and every update is constant time.
+//
+// Subclasses choose the policy, using the list heads and, if they
+// need more, the `state_changed` hook.
+
+class TrackingAssigner : public Assigner {
+
+public:
+
+    typedef Voice::State State;
+
+    TrackingAssigner(Synth& synth)
+    : m_synth{synth},
+      m_head{},
+      m_tail{}
+    {
+        assert(synth.polyphony < NIL);
+        for (auto& h: m_head)
+            h = NIL;
+        for (auto& t: m_tail)
+            t = NIL;
+        for (size_t i = 0; i < synth.polyphony; i++) {
+            m_state[i] = State::IDLE;
+            append(i);
+        }
+        synth.assigner(this);
+    }
+
+    TrackingAssigner(const TrackingAssigner&) = delete;
+    TrackingAssigner& operator = (const TrackingAssigner&) = delete;
+
+    ~TrackingAssigner()
+    {
+        if (m_synth.assigner() == this)
+            m_synth.assigner(nullptr);
+    }
+
+    void voice_state_changed(Voice& v) override
+    {
+        size_t i = &v - m_synth.voices().data();
+        assert(i < m_synth.polyphony);
+        State old = m_state[i];
+        unlink(i);
+        m_state[i] = v.state();
+        append(i);
+        state_changed(i, old, v.state());
+    }
+
+    // Voice index of the voice that entered state s longest ago, or
+    // NIL.
+    size_t oldest(State s) const { return m_head[index(s)]; }
+
+    // The voice that entered the same state after voice i, or NIL.
+    size_t next(size_t i) const { return m_next[i]; }
+
+    State state(size_t i) const { return m_state[i]; }
+
+    static const size_t NIL = 0xFFFF;
+
+protected:
+
+    // Subclasses hook in here.
+    virtual void state_changed(size_t /*i*/, State /*old*/, State /*s*/) {}
+
+    Voice& voice(size_t i) { return m_synth.voices()[i]; }
+    Voice *voice_or_null(size_t i) { return i == NIL ? nullptr : &voice(i); }
+
+    // The voice that has been idle longest, or NIL.  It goes to the
+    // back of the idle list so that a voice assigned but not yet
+    // started is not handed out again.
+    size_t take_idle()
+    {
+        size_t i = oldest(State::IDLE);
+        if (i != NIL)
+            take_idle(i);
+        return i;
+    }
+
+    void take_idle(size_t i)
+    {
+        assert(m_state[i] == State::IDLE);
+        unlink(i);
+        append(i);
+    }
+
+    // The oldest releasing voice, or failing that, the oldest sounding
+    // voice, or NIL.  Stopping voices are never stolen.
+    size_t oldest_active() const
+    {
+        size_t i = oldest(State::RELEASING);
+        return i != NIL ? i : oldest(State::SOUNDING);
+    }
+
+    Synth& m_synth;
+
+private:
+
+    static const size_t STATE_COUNT = 4;
+
+    static size_t index(State s) { return static_cast<size_t>(s); }
+
+    void append(size_t i)
+    {
+        size_t si = index(m_state[i]);
+        m_prev[i] = m_tail[si];
+        m_next[i] = NIL;
+        if (m_tail[si] == NIL)
+            m_head[si] = i;
+        else
+            m_next[m_tail[si]] = i;
+        m_tail[si] = i;
+    }
+
+    void unlink(size_t i)
+    {
+        size_t si = index(m_state[i]);
+        if (m_prev[i] == NIL)
+            m_head[si] = m_next[i];
+        else
+            m_next[m_prev[i]] = m_next[i];
+        if (m_next[i] == NIL)
+            m_tail[si] = m_prev[i];
+        else
+            m_prev[m_next[i]] = m_prev[i];
+    }
+
+    std::uint16_t m_head[STATE_COUNT];
+    std::uint16_t m_tail[STATE_COUNT];
+    std::uint16_t m_prev[MAX_POLYPHONY];
+    std::uint16_t m_next[MAX_POLYPHONY];
+    State m_state[MAX_POLYPHONY];
+
+};
+
+#endif /* !ASGN_TRACK_included */
@@ -1,6 +1,8 @@
 #ifndef ASSIGNERS_included
 #define ASSIGNERS_included
 
+#include <cstdint>
+
 class Voice;
 
 class Assigner {
@@ -13,6 +15,14 @@ public:
     virtual Voice *assign_idle_voice() = 0;
     virtual Voice *choose_voice_to_steal() = 0;
 
+    // The note manager announces the note it is about to assign a
+    // voice for.
+    virtual void next_note(std::uint8_t /*note*/) {}
+
+    // A voice calls this after its state changes, if the synth has
+    // an assigner.  Assigners that track voice states override it.
+    virtual void voice_state_changed(Voice&) {}
+
 };
 
 #endif /* !ASSIGNERS_included */
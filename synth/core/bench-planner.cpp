@@ -0,0 +1,110 @@
+// Planner benchmark.
+//
+// Builds patches with growing module counts and times construction
+// of a Planner plus make_plan.  Each patch has a chain of pre-voice
+// timbre modules feeding a voice section, where every voice module
+// takes two inputs and a control, and a chain of post-voice timbre
+// modules twinned to the last voice module.  Reports microseconds
+// per plan against module and link counts.  Build with BUILD=release
+// for meaningful numbers.
+//
+// The Makefile raises the size limits for this program, so it must
+// be linked with a planner.o built with the same limits.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "synth/core/controls.h"
+#include "synth/core/modules.h"
+#include "synth/core/planner.h"
+
+class BenchControl : public ControlType<BenchControl> {
+public:
+    void render(size_t) {}
+};
+
+class BenchModule : public ModuleType<BenchModule> {
+public:
+    BenchModule() : m_twin{nullptr} { ports(in, out); }
+    Input<> in;
+    Output<> out;
+    void render(size_t) {}
+    Module *twin() const override { return m_twin; }
+    Module *m_twin;
+};
+
+struct Patch {
+
+    Patch(size_t module_count)
+    : tm(module_count / 4), vm(module_count - tm.size()),
+      tc(MAX_TIMBRE_CONTROLS), vc(MAX_VOICE_CONTROLS)
+    {
+        const size_t pre = tm.size() / 2;
+        for (auto& c: tc)
+            tcv.push_back(&c);
+        for (auto& c: vc)
+            vcv.push_back(&c);
+        for (auto& m: tm)
+            tmv.push_back(&m);
+        for (auto& m: vm)
+            vmv.push_back(&m);
+
+        for (size_t i = 1; i < pre; i++) {
+            auto *ctl = &tc[i % tc.size()].out;
+            links.emplace_back(&tm[i].in, &tm[i - 1].out, ctl);
+        }
+        for (size_t i = 0; i < vm.size(); i++) {
+            auto *src = i ? &vm[i - 1].out : &tm[pre - 1].out;
+            links.emplace_back(&vm[i].in, src, &vc[i % vc.size()].out);
+            if (i)
+                links.emplace_back(&vm[i].in, &vm[i / 2].out, nullptr);
+        }
+        tm[pre].m_twin = &vm.back();
+        for (size_t i = pre + 1; i < tm.size(); i++)
+            links.emplace_back(&tm[i].in, &tm[i - 1].out, nullptr);
+        om.push_back(&tm.back());
+    }
+
+    std::vector<BenchModule> tm, vm;
+    std::vector<BenchControl> tc, vc;
+    Planner::tc_vec tcv;
+    Planner::tm_vec tmv;
+    Planner::vc_vec vcv;
+    Planner::vm_vec vmv;
+    Planner::link_vec links;
+    Planner::om_vec om;
+
+};
+
+static void bench(size_t module_count)
+{
+    std::unique_ptr<Patch> patch(new Patch(module_count));
+    const int repeat = int(20000 / module_count);
+
+    size_t steps = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        std::unique_ptr<Planner> planner(
+            new Planner(patch->tcv, patch->tmv, patch->vcv, patch->vmv,
+                        patch->links, patch->om));
+        std::unique_ptr<Plan> plan(new Plan(planner->make_plan()));
+        steps += plan->v_render().size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> dt = t1 - t0;
+    std::cout << module_count << " modules, "
+              << patch->links.size() << " links: "
+              << dt.count() / repeat * 1e6 << " usec/plan, "
+              << steps / repeat << " voice steps"
+              << std::endl;
+}
+
+int main()
+{
+    for (size_t n = 8; n <= MAX_MODULES; n *= 2)
+        bench(n);
+    return 0;
+}
@@ -32,4 +32,8 @@
 #define NOTE_SHUTDOWN_TIME 0.010 // seconds
 #endif
 
+#ifndef DEFAULT_SMOOTHING_TIME
+#define DEFAULT_SMOOTHING_TIME 0.005 // seconds
+#endif
+
 #endif /* CORE_DEFS_included */
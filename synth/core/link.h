@@ -92,7 +92,6 @@ public:
                 auto dest_buf = static_cast<Input<D> *>(dest)->buf();
                 auto src_buf = static_cast<Output<S> *>(src)->buf();
                 auto ctl_buf = static_cast<Output<C> *>(ctl)->buf();
-                auto scale = m_scale;
                 return [=] (size_t frame_count) {
                     for (size_t i = 0; i < frame_count; i++)
                         dest_buf[i] = src_buf[i] * ctl_buf[i] * scale;
@@ -107,7 +106,6 @@ public:
                 auto dest_buf = static_cast<Input<D> *>(dest)->buf();
                 auto src_buf = static_cast<Output<S> *>(src)->buf();
                 auto ctl_buf = static_cast<Output<C> *>(ctl)->buf();
-                auto scale = m_scale;
                 return [=] (size_t frame_count) {
                     for (size_t i = 0; i < frame_count; i++)
                         dest_buf[i] += src_buf[i] * ctl_buf[i] * scale;
@@ -156,7 +154,6 @@ public:
                 assert(src && dynamic_cast<Output<S> *>(src));
                 auto dest_buf = static_cast<Input<D> *>(dest)->buf();
                 auto src_buf = static_cast<Output<S> *>(src)->buf();
-                auto scale = m_scale;
                 return [=] (size_t frame_count) {
                     for (size_t i = 0; i < frame_count; i++)
                         dest_buf[i] = src_buf[i] * scale;
@@ -169,7 +166,6 @@ public:
                 assert(src && dynamic_cast<Output<S> *>(src));
                 auto dest_buf = static_cast<Input<D> *>(dest)->buf();
                 auto src_buf = static_cast<Output<S> *>(src)->buf();
-                auto scale = m_scale;
                 return [=] (size_t frame_count) {
                     for (size_t i = 0; i < frame_count; i++)
                         dest_buf[i] += src_buf[i] * scale;
@@ -218,7 +214,6 @@ public:
                 assert(ctl && dynamic_cast<Output<C> *>(ctl));
                 auto dest_buf = static_cast<Input<D> *>(dest)->buf();
                 auto ctl_buf = static_cast<Output<C> *>(ctl)->buf();
-                auto scale = m_scale;
                 return [=] (size_t frame_count) {
                     for (size_t i = 0; i < frame_count; i++)
                         dest_buf[i] = ctl_buf[i] * scale;
@@ -231,7 +226,6 @@ public:
                 assert(ctl && dynamic_cast<Output<C> *>(ctl));
                 auto dest_buf = static_cast<Input<D> *>(dest)->buf();
                 auto ctl_buf = static_cast<Output<C> *>(ctl)->buf();
-                auto scale = m_scale;
                 return [=] (size_t frame_count) {
                     for (size_t i = 0; i < frame_count; i++)
                         dest_buf[i] += ctl_buf[i] * scale;
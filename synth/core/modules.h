@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <string>
+#include <type_traits>
 
 #include "synth/core/action.h"
 #include "synth/core/ported.h"
@@ -82,6 +83,11 @@ public:
         return true;
     }
 
+    // True if the module handles any of the note events above.  The
+    // planner may render a voice module that doesn't once per timbre
+    // instead of once per voice.
+    virtual bool tracks_notes() const { return true; }
+
 protected:
 
     Module()
@@ -125,6 +131,20 @@ public:
         };
     }
 
+    // M tracks notes if it overrides any note handler.  `&M::start_note`
+    // has type `void (Module::*)()` only if neither M nor a base
+    // between it and Module overrides it.
+    bool tracks_notes() const override
+    {
+        typedef void (Module::*event)();
+        typedef bool (Module::*query)() const;
+        return !std::is_same<decltype(&M::start_note), event>::value ||
+               !std::is_same<decltype(&M::release_note), event>::value ||
+               !std::is_same<decltype(&M::kill_note), event>::value ||
+               !std::is_same<decltype(&M::idle), event>::value ||
+               !std::is_same<decltype(&M::note_is_done), query>::value;
+    }
+
     friend class modules_unit_test;
 
 };
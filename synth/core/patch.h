@@ -1,6 +1,8 @@
 #ifndef PATCH_included
 #define PATCH_included
 
+#include <cassert>
+
 #include "synth/core/defs.h"
 #include "synth/core/controls.h"
 #include "synth/core/link.h"
@@ -80,7 +82,14 @@ public:
         return *this;
     }
 
-    // XXX need disconnect methods?
+    // Remove a link.  Later links move down one.  To rescale a
+    // link, disconnect it and connect it again.
+    Patch& disconnect(size_t index)
+    {
+        assert(index < m_links.size());
+        m_links.erase(m_links.begin() + index);
+        return *this;
+    }
 
 private:
 
@@ -0,0 +1,455 @@
+#ifndef PLAN_CODEC_included
+#define PLAN_CODEC_included
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "synth/core/defs.h"
+#include "synth/core/link.h"
+#include "synth/core/modules.h"
+#include "synth/core/patch.h"
+#include "synth/core/plan.h"
+#include "synth/core/resolver.h"
+#include "synth/core/sizes.h"
+#include "synth/core/steps.h"
+
+
+// -- Plan Codec -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// PlanCodec converts a Plan to a compact binary blob and back, so a
+// product can ship the plans for its factory patches and skip the
+// Planner at startup and patch recall.
+//
+// A blob has a header
+//
+//     "MVSP"      magic
+//     u8          version
+//     u8          sizeof (SCALE_TYPE)
+//     u64         graph hash
+//
+// followed by the hoisted voice modules (a u16 count and u16
+// indices) and the five step sequences (a u16 count each, then the
+// steps).  A step is a u8 tag and its fields: indices are u16,
+// optional indices are i16, and scales are their bits.  Copy and add
+// steps store their Link's index in the patch.  Everything is little
+// endian.
+//
+// The graph hash covers the synth's archetype controls, modules and
+// ports, its output modules, and the patch's links.  A blob only
+// decodes against the graph it was encoded for.  Modules and ports
+// are known by their names and shapes, not their C++ types, so name
+// them if two graphs must not share plans.
+
+class PlanCodec {
+
+public:
+
+    typedef Patch::link_vector link_vector;
+    typedef fixed_vector<Module *, MAX_OUTPUT_MODULES> om_vector;
+
+    constexpr static const std::uint8_t VERSION = 1;
+
+    // Write the blob into buf if it fits in `size` bytes.  Returns
+    // the blob's size either way.
+    static size_t encode(const Plan& plan,
+                         const link_vector& links,
+                         std::uint64_t graph_hash,
+                         std::uint8_t *buf,
+                         size_t size)
+    {
+        writer w{buf, size, 0};
+        w.bytes(magic(), MAGIC_SIZE);
+        w.u8(VERSION);
+        w.u8(sizeof (SCALE_TYPE));
+        w.u64(graph_hash);
+
+        const auto& hoisted = plan.hoisted();
+        w.u16(hoisted.count());
+        for (size_t i = 0; i < hoisted.size(); i++)
+            if (hoisted.test(i))
+                w.u16(i);
+
+        encode_prep(w, plan.t_prep());
+        encode_prep(w, plan.v_prep());
+        encode_render(w, plan.pre_render(), links);
+        encode_render(w, plan.v_render(), links);
+        encode_render(w, plan.post_render(), links);
+        return w.pos;
+    }
+
+    // Replace `plan` with the blob's plan.  Returns false, leaving
+    // `plan` unchanged, if the blob is malformed, has another version
+    // or was made for another graph.
+    static bool decode(const std::uint8_t *blob,
+                       size_t size,
+                       const link_vector& links,
+                       std::uint64_t graph_hash,
+                       Plan& plan)
+    {
+        reader r{blob, size, 0, true};
+        char m[MAGIC_SIZE];
+        r.bytes(m, sizeof m);
+        if (!r.ok || std::memcmp(m, magic(), MAGIC_SIZE))
+            return false;
+        if (r.u8() != VERSION || r.u8() != sizeof (SCALE_TYPE))
+            return false;
+        if (r.u64() != graph_hash)
+            return false;
+
+        Plan p;
+        size_t hoisted_count = r.u16();
+        for (size_t i = 0; r.ok && i < hoisted_count; i++) {
+            size_t index = r.u16();
+            if (index >= p.hoisted().size())
+                return false;
+            p.hoisted().set(index);
+        }
+
+        if (!decode_prep(r, p.t_prep()) ||
+            !decode_prep(r, p.v_prep()) ||
+            !decode_render(r, p.pre_render(), links) ||
+            !decode_render(r, p.v_render(), links) ||
+            !decode_render(r, p.post_render(), links))
+            return false;
+        if (!r.ok || r.pos != size)
+            return false;
+        plan = p;
+        return true;
+    }
+
+    // FNV-1a hash of everything a plan depends on besides itself.
+    // The resolver must hold the archetype timbre controls, timbre
+    // modules, voice controls and voice modules, in that order, as
+    // the Planner's does.
+    static std::uint64_t graph_hash(const Resolver& resolver,
+                                    const om_vector& output_modules,
+                                    const link_vector& links)
+    {
+        hasher h;
+        const auto& controls = resolver.controls();
+        const auto& modules = resolver.modules();
+        const auto& ports = resolver.ports();
+        h.u64(controls.size());
+        for (size_t i = 0; i < controls.size(); i++)
+            hash_ported(h, "", *controls[i]);
+        h.u64(modules.size());
+        for (size_t i = 0; i < modules.size(); i++)
+            hash_ported(h, modules[i]->name(), *modules[i]);
+
+        h.u64(output_modules.size());
+        for (auto *m: output_modules)
+            h.u64(modules.find(m));
+
+        h.u64(links.size());
+        for (auto& link: links) {
+            h.u64(ports.find(link.dest()));
+            h.u64(ports.find(link.src()));
+            h.u64(ports.find(link.ctl()));
+            h.u64(scale_bits(link.scale()));
+        }
+        return h.value;
+    }
+
+private:
+
+    constexpr static const size_t MAGIC_SIZE = 4;
+
+    static const char *magic() { return "MVSP"; }
+
+    static_assert(step_util::max_index <= UINT16_MAX &&
+                  MAX_PORTS <= INT16_MAX &&
+                  MAX_LINKS <= UINT16_MAX,
+                  "indices don't fit in 16 bits");
+    static_assert(sizeof (SCALE_TYPE) <= sizeof (std::uint64_t),
+                  "SCALE_TYPE too big");
+
+    struct writer {
+
+        std::uint8_t *buf;
+        size_t size;
+        size_t pos;
+
+        void bytes(const void *p, size_t n)
+        {
+            if (pos + n <= size)
+                std::memcpy(buf + pos, p, n);
+            pos += n;
+        }
+
+        void put(std::uint64_t value, size_t n)
+        {
+            for (size_t i = 0; i < n; i++, pos++)
+                if (pos < size)
+                    buf[pos] = std::uint8_t(value >> 8 * i);
+        }
+
+        void u8(std::uint8_t value) { put(value, 1); }
+        void u16(std::uint16_t value) { put(value, 2); }
+        void i16(std::int16_t value) { put(std::uint16_t(value), 2); }
+        void u64(std::uint64_t value) { put(value, 8); }
+
+        void scale(SCALE_TYPE value)
+        {
+            put(scale_bits(value), sizeof value);
+        }
+
+    };
+
+    struct reader {
+
+        const std::uint8_t *buf;
+        size_t size;
+        size_t pos;
+        bool ok;
+
+        void bytes(void *p, size_t n)
+        {
+            ok = ok && pos + n <= size;
+            if (ok)
+                std::memcpy(p, buf + pos, n);
+            pos += n;
+        }
+
+        std::uint64_t get(size_t n)
+        {
+            ok = ok && pos + n <= size;
+            std::uint64_t value = 0;
+            for (size_t i = 0; ok && i < n; i++)
+                value |= std::uint64_t(buf[pos + i]) << 8 * i;
+            pos += n;
+            return value;
+        }
+
+        std::uint8_t u8() { return std::uint8_t(get(1)); }
+        std::uint16_t u16() { return std::uint16_t(get(2)); }
+        std::int16_t i16() { return std::int16_t(get(2)); }
+        std::uint64_t u64() { return get(8); }
+
+        SCALE_TYPE scale()
+        {
+            std::uint64_t bits = get(sizeof (SCALE_TYPE));
+            SCALE_TYPE value;
+            std::memcpy(&value, &bits, sizeof value);
+            return value;
+        }
+
+    };
+
+    struct hasher {
+
+        std::uint64_t value = 0xcbf29ce484222325;
+
+        void bytes(const void *p, size_t n)
+        {
+            auto *b = static_cast<const std::uint8_t *>(p);
+            for (size_t i = 0; i < n; i++) {
+                value ^= b[i];
+                value *= 0x100000001b3;
+            }
+        }
+
+        void u64(std::uint64_t n)
+        {
+            for (size_t i = 0; i < 8; i++) {
+                std::uint8_t b = std::uint8_t(n >> 8 * i);
+                bytes(&b, 1);
+            }
+        }
+
+        void str(const char *s) { bytes(s, std::strlen(s) + 1); }
+
+    };
+
+    // The scale's bits, in the low bytes.  Assumes a little endian
+    // host, like the rest of the synth.
+    static std::uint64_t scale_bits(SCALE_TYPE scale)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &scale, sizeof scale);
+        return bits;
+    }
+
+    // Only portable facts are hashed: names, port directions and
+    // element sizes.  C++ type names differ between compilers.
+    static void hash_ported(hasher& h,
+                            const std::string& name,
+                            const Ported& p)
+    {
+        h.str(name.c_str());
+        h.u64(p.ports().size());
+        for (auto *port: p.ports()) {
+            h.str(port->name().c_str());
+            h.u64(dynamic_cast<InputPort *>(port) != nullptr);
+            h.u64(port->data_size());
+        }
+    }
+
+    static void encode_prep(writer& w, const Plan::prep_step_sequence& seq)
+    {
+        w.u16(seq.size());
+        for (auto& step: seq) {
+            w.u8(std::uint8_t(step.m_tag));
+            switch (step.m_tag) {
+
+            case PrepStep::Tag::CLEAR:
+                w.u16(step.m_u.clear.m_dest_port_index);
+                w.scale(step.m_u.clear.m_scale);
+                break;
+
+            case PrepStep::Tag::ALIAS:
+                w.u16(step.m_u.alias.m_dest_port_index);
+                w.i16(step.m_u.alias.m_src_port_index);
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    static void encode_render(writer& w,
+                              const Plan::render_step_sequence& seq,
+                              const link_vector& links)
+    {
+        w.u16(seq.size());
+        for (auto& step: seq) {
+            w.u8(std::uint8_t(step.m_tag));
+            switch (step.m_tag) {
+
+            case RenderStep::Tag::CONTROL_RENDER:
+                w.u16(step.m_u.crend.m_ctl_index);
+                break;
+
+            case RenderStep::Tag::MODULE_RENDER:
+                w.u16(step.m_u.mrend.m_mod_index);
+                break;
+
+            case RenderStep::Tag::COPY:
+                encode_link_step(w, step.m_u.copy, links);
+                break;
+
+            case RenderStep::Tag::ADD:
+                encode_link_step(w, step.m_u.add, links);
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    template <class Step>
+    static void encode_link_step(writer& w,
+                                 const Step& step,
+                                 const link_vector& links)
+    {
+        assert(links.data() <= step.m_link &&
+               step.m_link < links.data() + links.size());
+        w.u16(step.m_dest_port_index);
+        w.i16(step.m_src_port_index);
+        w.i16(step.m_ctl_port_index);
+        w.u16(step.m_link - links.data());
+    }
+
+    static bool valid_port(ssize_t index, bool optional)
+    {
+        return (optional && index == -1) ||
+               (index >= 0 && size_t(index) < MAX_PORTS);
+    }
+
+    static bool decode_prep(reader& r, Plan::prep_step_sequence& seq)
+    {
+        size_t count = r.u16();
+        if (count > seq.max_size())
+            return false;
+        for (size_t i = 0; r.ok && i < count; i++) {
+            auto tag = PrepStep::Tag(r.u8());
+            switch (tag) {
+
+            case PrepStep::Tag::CLEAR:
+                {
+                    size_t dest = r.u16();
+                    SCALE_TYPE scale = r.scale();
+                    if (!valid_port(dest, false))
+                        return false;
+                    seq.push_back(ClearStep(dest, scale));
+                }
+                break;
+
+            case PrepStep::Tag::ALIAS:
+                {
+                    size_t dest = r.u16();
+                    ssize_t src = r.i16();
+                    if (!valid_port(dest, false) || !valid_port(src, true))
+                        return false;
+                    seq.push_back(AliasStep(dest, src));
+                }
+                break;
+
+            default:
+                return false;
+            }
+        }
+        return r.ok;
+    }
+
+    static bool decode_render(reader& r,
+                              Plan::render_step_sequence& seq,
+                              const link_vector& links)
+    {
+        size_t count = r.u16();
+        if (count > seq.max_size())
+            return false;
+        for (size_t i = 0; r.ok && i < count; i++) {
+            auto tag = RenderStep::Tag(r.u8());
+            switch (tag) {
+
+            case RenderStep::Tag::CONTROL_RENDER:
+                {
+                    size_t ctl = r.u16();
+                    if (ctl >= MAX_CONTROLS)
+                        return false;
+                    seq.push_back(ControlRenderStep(ctl));
+                }
+                break;
+
+            case RenderStep::Tag::MODULE_RENDER:
+                {
+                    size_t mod = r.u16();
+                    if (mod >= MAX_MODULES)
+                        return false;
+                    seq.push_back(ModuleRenderStep(mod));
+                }
+                break;
+
+            case RenderStep::Tag::COPY:
+            case RenderStep::Tag::ADD:
+                {
+                    size_t dest = r.u16();
+                    ssize_t src = r.i16();
+                    ssize_t ctl = r.i16();
+                    size_t link = r.u16();
+                    if (!valid_port(dest, false) ||
+                        !valid_port(src, true) ||
+                        !valid_port(ctl, true) ||
+                        link >= links.size())
+                        return false;
+                    if (tag == RenderStep::Tag::COPY)
+                        seq.push_back(CopyStep(dest, src, ctl, &links[link]));
+                    else
+                        seq.push_back(AddStep(dest, src, ctl, &links[link]));
+                }
+                break;
+
+            default:
+                return false;
+            }
+        }
+        return r.ok;
+    }
+
+};
+
+#endif /* !PLAN_CODEC_included */
@@ -1,6 +1,7 @@
 #ifndef PLAN_included
 #define PLAN_included
 
+#include <bitset>
 #include <iostream>
 
 #include "synth/core/sizes.h"
@@ -8,6 +9,10 @@
 #include "synth/util/fixed-vector.h"
 
 // A Plan has five sequences of Steps.
+//
+// It also has the set of hoisted voice modules, by index among the
+// voice modules.  Hoisted modules are rendered once per timbre, in
+// the pre-voice steps, and every voice reads their outputs.
 
 class Plan {
 
@@ -15,6 +20,7 @@ public:
 
     typedef fixed_vector<PrepStep, MAX_PREP_STEPS> prep_step_sequence;
     typedef fixed_vector<RenderStep, MAX_RENDER_STEPS> render_step_sequence;
+    typedef std::bitset<MAX_VOICE_MODULES> module_set;
 
     const prep_step_sequence&   t_prep()      const { return m_t_prep; }
     const prep_step_sequence&   v_prep()      const { return m_v_prep; }
@@ -28,6 +34,9 @@ public:
     render_step_sequence&       v_render()          { return m_v_render; }
     render_step_sequence&       post_render()       { return m_post_render; }
 
+    const module_set&           hoisted()     const { return m_hoisted; }
+    module_set&                 hoisted()           { return m_hoisted; }
+
 private:
 
     prep_step_sequence          m_t_prep;
@@ -35,6 +44,7 @@ private:
     render_step_sequence        m_pre_render;
     render_step_sequence        m_v_render;
     render_step_sequence        m_post_render;
+    module_set                  m_hoisted;
 
 };
 
@@ -10,11 +10,14 @@ Plan
 Planner::make_plan()
 {
     // Partition reachable modules into pre, voice, and post;
-    // define other useful module subsets.
+    // define other useful module subsets.  Hoisted voice modules
+    // render with the pre-voice modules.
     auto mod_parts = partition_modules_used();
-    auto timbre_mods = mod_parts.pre | mod_parts.post;
-    auto voice_mods = mod_parts.voice;
-    auto mods_used = timbre_mods | voice_mods;
+    auto hoisted = mod_parts.hoisted;
+    auto pre_mods = mod_parts.pre | hoisted;
+    auto timbre_mods = pre_mods | mod_parts.post;
+    auto voice_mods = mod_parts.voice - hoisted;
+    auto mods_used = mod_parts.pre | mod_parts.voice | mod_parts.post;
     auto no_mods = m_resolver.modules().none;
 
     // Find reachable controls.
@@ -23,6 +26,8 @@ Planner::make_plan()
 
     // Build a plan.
     Plan plan;
+    for (auto mi: hoisted.indices())
+        plan.hoisted().set(mi - m_tmodules.size());
 
     // Assemble timbre prep steps.
     auto t_prep_appender = std::back_inserter(plan.t_prep());
@@ -35,7 +40,8 @@ Planner::make_plan()
     // Assemble pre-voice render steps.
     auto pre_render_appender = std::back_inserter(plan.pre_render());
     assemble_render_steps(controls_used.timbre,
-                          mod_parts.pre,
+                          pre_mods,
+                          no_mods,
                           no_mods,
                           pre_render_appender);
 
@@ -43,14 +49,16 @@ Planner::make_plan()
     auto v_render_appender = std::back_inserter(plan.v_render());
     assemble_render_steps(controls_used.voice,
                           voice_mods,
-                          mod_parts.pre,
+                          pre_mods,
+                          hoisted,
                           v_render_appender);
 
     // Assemble post-voice render steps.
     auto post_render_appender = std::back_inserter(plan.post_render());
     assemble_render_steps(no_controls,
                           mod_parts.post,
-                          mod_parts.pre | mod_parts.voice,
+                          pre_mods | voice_mods,
+                          no_mods,
                           post_render_appender);
 
     return plan;
@@ -73,18 +81,18 @@ Planner::partition_modules_used()
     auto post_mods = outputs_used | collect_pred(outputs_used, all_tmods);
     auto voice_mods = collect_pred(post_mods, all_vmods);
     auto pre_mods = collect_pred(voice_mods, all_tmods);
+    auto hoisted = find_hoistable(voice_mods);
     assert(voice_mods <= all_vmods);
     assert((pre_mods & post_mods) == 0);
     assert((pre_mods | post_mods) <= all_tmods);
-    return mod_partition{pre_mods, voice_mods, post_mods};
+    assert(hoisted <= voice_mods);
+    return mod_partition{pre_mods, voice_mods, post_mods, hoisted};
 }
 
 Planner::module_subset
 Planner::collect_pred(module_subset succ, module_subset candidates)
 {
-    auto& mod_u = m_resolver.modules();
-    auto pred = mod_u.none;
-    auto cur = succ;
+    auto pred = m_resolver.modules().none;
 
     // Hackery alert!
     //
@@ -97,19 +105,60 @@ Planner::collect_pred(module_subset succ, module_subset candidates)
         }
     }
 
-    while (true) {
-        auto prev = mod_u.none;
-        for (auto mi: cur.indices())
-            prev |= m_mod_predecessors->at(mi);
-        prev &= candidates - pred;
-        if (prev == 0)
-            break;
-        pred |= prev;
-        cur = prev;
-    }
+    // Then add everything reachable from succ and the twins through
+    // the candidates.
+    auto reach = m_mod_predecessors->closure(candidates);
+    auto starts = succ | pred;
+    for (auto mi: starts.indices())
+        pred |= reach.at(mi);
     return pred;
 }
 
+// find_hoistable - find the voice modules that compute the same
+// signal in every voice.  Their inputs come only from timbre modules
+// and timbre controls, possibly through other such voice modules.
+//
+// A voice module can't be hoisted if
+//    - it handles note events (e.g., an envelope),
+//    - a voice control drives one of its inputs,
+//    - it is a timbre module's twin (e.g., a Summer's voice side),
+//    - it depends on a voice module that can't be hoisted.
+Planner::module_subset
+Planner::find_hoistable(const module_subset& voice_mods)
+{
+    auto& mod_u = m_resolver.modules();
+    auto& ctl_u = m_resolver.controls();
+    auto all_vmods = mod_u.subset(m_vmodules.begin(), m_vmodules.end());
+    auto fixed = mod_u.none;            // voice modules that stay put
+
+    for (auto mi: all_vmods.indices())
+        if (mod_u[mi]->tracks_notes())
+            fixed.set(mi);
+    for (auto *m: m_tmodules) {
+        ssize_t ti = m->twin() ? mod_u.find(m->twin()) : -1;
+        if (ti >= 0)
+            fixed.set(ti);
+    }
+    for (auto& link: m_links.all.members()) {
+        if (!link.ctl())
+            continue;
+        auto ctl = dynamic_cast<Control *>(link.ctl()->owner());
+        if (!ctl)
+            continue;
+        ssize_t ci = ctl_u.find(ctl);
+        if (ci >= ssize_t(m_tcontrols.size()))
+            fixed.add(static_cast<Module *>(link.dest()->owner()));
+    }
+
+    auto reach = m_mod_predecessors->closure(mod_u.all);
+    auto candidates = voice_mods - fixed;
+    auto hoisted = mod_u.none;
+    for (auto mi: candidates.indices())
+        if ((reach.at(mi) & fixed) == 0)
+            hoisted.set(mi);
+    return hoisted;
+}
+
 Planner::fcu_result
 Planner::find_controls_used(const module_subset& modules)
 {
@@ -177,10 +226,14 @@ Planner::assemble_prep_steps(const module_subset& modules,
     }
 }
 
+// `shared` modules are rendered elsewhere, but links from them are
+// copied in this section.  (Links from other modules outside the
+// section are not.)
 void
 Planner::assemble_render_steps(const control_subset& controls,
                                module_subset section,
                                module_subset done,
+                               const module_subset& shared,
                                render_appender& add_step)
 {
     auto mod_u = m_resolver.modules();
@@ -217,13 +270,14 @@ Planner::assemble_render_steps(const control_subset& controls,
                     if (link.src()) {
                         assert(dynamic_cast<Module *>(link.src()->owner()));
                         auto mod = static_cast<Module *>(link.src()->owner());
-                        if (!section.contains(mod))
+                        if (!section.contains(mod) && !shared.contains(mod))
                             break;
                     }
                     // If ctl is not in this section, don't emit the action.
                     if (link.ctl()) {
                         auto mod = dynamic_cast<Module *>(link.ctl()->owner());
-                        if (mod && !section.contains(mod))
+                        if (mod && !section.contains(mod) &&
+                            !shared.contains(mod))
                             break;
                     }
 
@@ -98,6 +98,7 @@ private:
         module_subset pre;
         module_subset voice;
         module_subset post;
+        module_subset hoisted;          // subset of voice
     };
 
     struct fcu_result {
@@ -119,6 +120,7 @@ private:
     assemble_render_steps(const control_subset&,
                           module_subset section,
                           module_subset done,
+                          const module_subset& shared,
                           render_appender&);
 
     void
@@ -130,6 +132,9 @@ private:
     module_subset
     collect_pred(module_subset succ, module_subset candidates);
 
+    module_subset
+    find_hoistable(const module_subset& voice_mods);
+
     bool
     link_is_aliasable(const Link&);
 
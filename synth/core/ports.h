@@ -60,6 +60,7 @@ public:
     }
 
     virtual std::type_index data_type() const = 0;
+    virtual size_t data_size() const = 0;
 
 protected:
 
@@ -121,6 +122,7 @@ public:
     {}
 
     std::type_index data_type() const override { return typeid(ElementType); }
+    size_t data_size() const override { return sizeof (ElementType); }
 
     void clear(SCALE_TYPE value) override
     {
@@ -146,6 +148,9 @@ public:
 
     ElementType *buf() { return m_buf; }
 
+    // The data consumers read, wherever it lives.
+    const ElementType *data() const { return m_data; }
+
 private:
 
     const ElementType *m_data;
@@ -162,6 +167,7 @@ class Output : public OutputPort {
 public:
 
     std::type_index data_type() const override { return typeid(ElementType); }
+    size_t data_size() const override { return sizeof (ElementType); }
 
     ElementType& operator [] (size_t i)
     {
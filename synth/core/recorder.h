@@ -0,0 +1,51 @@
+#ifndef RECORDER_included
+#define RECORDER_included
+
+#include <cassert>
+#include <cstddef>
+
+#include "synth/core/defs.h"
+#include "synth/core/modules.h"
+
+// A Recorder is an output module that adds its input into a buffer
+// in memory, e.g., for offline rendering.  Copies share the buffer,
+// so when the synth clones it for each timbre, the timbres are
+// summed.  Each copy keeps its own position.
+
+class Recorder : public ModuleType<Recorder> {
+
+public:
+
+    typedef DEFAULT_SAMPLE_TYPE sample_type;
+
+    Recorder(sample_type *buffer, size_t size)
+    : m_buffer{buffer},
+      m_size{size},
+      m_pos{0}
+    {
+        in.name("in");
+        ports(in);
+    }
+
+    Input<sample_type> in;
+
+    size_t position() const { return m_pos; }
+
+    void render(size_t frame_count)
+    {
+        assert(m_pos + frame_count <= m_size);
+        sample_type *p = m_buffer + m_pos;
+        for (size_t i = 0; i < frame_count; i++)
+            p[i] += in[i];
+        m_pos += frame_count;
+    }
+
+private:
+
+    sample_type *m_buffer;
+    size_t m_size;
+    size_t m_pos;
+
+};
+
+#endif /* !RECORDER_included */
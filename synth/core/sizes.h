@@ -68,7 +68,7 @@
 #endif
 
 #ifndef MODULE_MAX_PORTS
-#define MODULE_MAX_PORTS 4
+#define MODULE_MAX_PORTS 6
 #endif
 
 #ifndef MAX_CONTROLS
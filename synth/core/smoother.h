@@ -0,0 +1,201 @@
+#ifndef SMOOTHER_included
+#define SMOOTHER_included
+
+#include <cassert>
+#include <cmath>
+
+#include "synth/core/defs.h"
+#include "synth/core/ports.h"
+#include "synth/core/sizes.h"
+
+
+// -- Smoother  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// A Smoother turns a stepwise control value (e.g., from a MIDI
+// message) into a zipper-free signal.  It has three curves.
+//
+//   STEP     - jump to the new value at the next block.
+//   LINEAR   - ramp to the new value in `time` seconds.
+//   ONE_POLE - approach the new value exponentially with time
+//              constant `time`.
+//
+// The curve is evaluated once per block, at the block's last frame,
+// and the frames in between are interpolated linearly.  So a control
+// costs one add per frame while it moves, and for ONE_POLE there is
+// no per-frame exponential.
+//
+// When the value settles, `render` fills the whole output buffer with
+// it once, then stops writing.  `is_constant` tells whether the
+// output buffer already holds the settled value.
+
+class Smoother {
+
+public:
+
+    enum class Curve {
+        STEP,
+        LINEAR,
+        ONE_POLE,
+    };
+
+    Smoother(Curve curve = Curve::ONE_POLE,
+             float time = DEFAULT_SMOOTHING_TIME)
+    : m_curve{curve},
+      m_time{time},
+      m_Fs{0},
+      m_coef{0},
+      m_block_coef{0},
+      m_block_size{0},
+      m_step{0},
+      m_value{0},
+      m_target{0},
+      m_is_instant{true},
+      m_is_settled{true},
+      m_is_constant{false}
+    {}
+
+    Curve curve() const { return m_curve; }
+    float time() const { return m_time; }
+    float value() const { return m_value; }
+    float target() const { return m_target; }
+    bool is_settled() const { return m_is_settled; }
+    bool is_constant() const { return m_is_constant; }
+
+    void curve(Curve c)
+    {
+        m_curve = c;
+        recalc();
+    }
+
+    void time(float t)
+    {
+        m_time = t;
+        recalc();
+    }
+
+    void configure(float sample_rate)
+    {
+        m_Fs = sample_rate;
+        recalc();
+    }
+
+    // Glide to a new value.
+    void set(float target)
+    {
+        if (target == m_target && m_is_settled)
+            return;
+        m_target = target;
+        m_is_settled = false;
+        if (m_curve == Curve::LINEAR && !m_is_instant)
+            m_step = (m_target - m_value) / (m_time * m_Fs);
+    }
+
+    // Go to a new value at the next block.
+    void jump(float value)
+    {
+        m_target = value;
+        settle();
+    }
+
+    // Skip to the end of the glide.
+    void settle()
+    {
+        if (m_value != m_target)
+            m_is_constant = false;
+        m_value = m_target;
+        m_is_settled = true;
+    }
+
+    // Advance one block.  Sets `from` to the value before the block
+    // and `to` to the value at the block's last frame.  A step has
+    // no "before".
+    void advance(size_t frame_count, float& from, float& to)
+    {
+        from = m_value;
+        if (!m_is_settled) {
+            switch (m_is_instant ? Curve::STEP : m_curve) {
+
+            case Curve::STEP:
+                from = m_value = m_target;
+                break;
+
+            case Curve::LINEAR:
+                m_value += m_step * frame_count;
+                if ((m_step >= 0) == (m_value >= m_target))
+                    m_value = m_target;
+                break;
+
+            case Curve::ONE_POLE:
+                if (frame_count != m_block_size) {
+                    m_block_size = frame_count;
+                    m_block_coef = std::pow(m_coef, float(frame_count));
+                }
+                m_value = m_target + (m_value - m_target) * m_block_coef;
+                if (std::fabs(m_value - m_target) < SETTLED_THRESHOLD)
+                    m_value = m_target;
+                break;
+            }
+            if (m_value == m_target)
+                m_is_settled = true;
+        }
+        to = m_value;
+    }
+
+    template <class ElementType>
+    void render(Output<ElementType>& out, size_t frame_count)
+    {
+        assert(frame_count);
+        if (m_is_settled && m_is_constant)
+            return;
+        float from, to;
+        advance(frame_count, from, to);
+        if (m_is_settled && from == to) {
+            for (size_t i = 0; i < MAX_FRAMES; i++)
+                out[i] = to;
+            m_is_constant = true;
+            return;
+        }
+        m_is_constant = false;
+        float inc = (to - from) / frame_count;
+        float v = from;
+        for (size_t i = 0; i < frame_count; i++)
+            out[i] = v += inc;
+        out[frame_count - 1] = to;
+    }
+
+private:
+
+    // Close enough to call it done: -100 dB of full scale.
+    static constexpr float SETTLED_THRESHOLD = 1.0e-5f;
+
+    // Glides shorter than a frame (or before the sample rate is known)
+    // are steps.
+    void recalc()
+    {
+        float frames = m_time * m_Fs;
+        m_is_instant = m_curve == Curve::STEP || frames < 1;
+        if (m_is_instant)
+            return;
+        if (m_curve == Curve::ONE_POLE)
+            m_coef = std::exp(-1 / frames);
+        if (m_curve == Curve::LINEAR)
+            m_step = (m_target - m_value) / frames;
+        m_block_size = 0;
+    }
+
+    Curve m_curve;
+    float m_time;
+    float m_Fs;
+    float m_coef;
+    float m_block_coef;
+    size_t m_block_size;
+    float m_step;
+    float m_value;
+    float m_target;
+    bool m_is_instant;
+    bool m_is_settled;
+    bool m_is_constant;
+
+};
+
+#endif /* !SMOOTHER_included */
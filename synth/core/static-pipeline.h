@@ -0,0 +1,517 @@
+#ifndef STATIC_PIPELINE_included
+#define STATIC_PIPELINE_included
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include "synth/core/config.h"
+#include "synth/core/defs.h"
+#include "synth/core/ports.h"
+
+
+// -- Static Pipelines -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// A StaticPipeline is a graph of modules and controls (units) whose
+// links are known at compile time.  It is the static counterpart of
+// a Patch applied by the Planner: the render order is computed by
+// the compiler, links are typed, and `render` calls each unit's
+// `render` directly, so there is no Resolver, no render_action, and
+// no virtual call per block.  Fixed targets can use one pipeline per
+// voice (and one for the timbre) instead of a Synth.
+//
+// Units are listed in a tuple and referred to by index.  A port is
+// named by its unit's index and the port member:
+//
+//     STATIC_PORT(1, NaiveSquare, freq)
+//
+// Links are listed in another tuple.
+//
+//     StaticLink<Dest, Src>               dest = src
+//     StaticLink<Dest, Src, Ctl>          dest = src * ctl
+//     StaticLink<Dest, NoPort, Ctl>       dest = ctl
+//     ScaledLink<Dest, Src, Ctl>          ... times the link's scale
+//     ScaledLink<Dest>                    dest = scale
+//
+// A scaled link's scale is a member of the link; set it through
+// `link<I>().scale`.  As with the Planner, an input with one unscaled
+// link from an output of the same type is aliased to that output,
+// an input with several links gets the first link's copy and the
+// others' sums, and an unconnected input is cleared to zero.
+//
+// Units are rendered by rank, the length of the longest chain of
+// links into them, and by index within a rank.  A graph with a cycle
+// doesn't compile.  The rank is found by a search as deep as the
+// number of units, so pipelines should be small.
+
+namespace static_util {
+
+    constexpr static const size_t npos = ~size_t(0);
+
+    constexpr size_t max_of() { return 0; }
+
+    template <class... Rest>
+    constexpr size_t max_of(size_t a, Rest... rest)
+    {
+        return a < max_of(rest...) ? max_of(rest...) : a;
+    }
+
+    constexpr size_t sum_of() { return 0; }
+
+    template <class... Rest>
+    constexpr size_t sum_of(size_t a, Rest... rest)
+    {
+        return a + sum_of(rest...);
+    }
+
+    template <size_t... I>
+    struct index_list {};
+
+    template <size_t N, size_t... I>
+    struct make_index_list : make_index_list<N - 1, N - 1, I...> {};
+
+    template <size_t... I>
+    struct make_index_list<0, I...> {
+        typedef index_list<I...> type;
+    };
+
+    template <class Member>
+    struct member_type;
+
+    template <class C, class T>
+    struct member_type<T C::*> {
+        typedef T type;
+    };
+
+    template <class P>
+    struct port_element;
+
+    template <class T>
+    struct port_element<Input<T>> {
+        typedef T type;
+        static const bool is_input = true;
+    };
+
+    template <class T>
+    struct port_element<Output<T>> {
+        typedef T type;
+        static const bool is_input = false;
+    };
+
+    // `sample` multiplies the factors a link has.
+    inline SCALE_TYPE sample(std::nullptr_t, std::nullptr_t, size_t)
+    {
+        return 1;
+    }
+
+    template <class S>
+    inline S sample(const S *src, std::nullptr_t, size_t i)
+    {
+        return src[i];
+    }
+
+    template <class C>
+    inline C sample(std::nullptr_t, const C *ctl, size_t i)
+    {
+        return ctl[i];
+    }
+
+    template <class S, class C>
+    inline auto sample(const S *src, const C *ctl, size_t i)
+    -> decltype(src[i] * ctl[i])
+    {
+        return src[i] * ctl[i];
+    }
+
+    template <class T>
+    inline T scaled(T value, SCALE_TYPE, std::false_type)
+    {
+        return value;
+    }
+
+    template <class T>
+    inline auto scaled(T value, SCALE_TYPE scale, std::true_type)
+    -> decltype(value * scale)
+    {
+        return value * scale;
+    }
+
+}
+
+
+// -- Static Ports -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+template <size_t Unit, class Member, Member M>
+class StaticPort {
+
+public:
+
+    typedef typename static_util::member_type<Member>::type port_type;
+    typedef typename static_util::port_element<port_type>::type
+        element_type;
+
+    constexpr static const size_t unit = Unit;
+    constexpr static const bool is_input =
+        static_util::port_element<port_type>::is_input;
+
+    template <class Units>
+    static port_type& get(Units& units)
+    {
+        return std::get<Unit>(units).*M;
+    }
+
+    template <class Units>
+    static const element_type *buf(Units& units)
+    {
+        return get(units).buf();
+    }
+
+};
+
+class NoPort {
+
+public:
+
+    typedef void element_type;
+
+    constexpr static const size_t unit = static_util::npos;
+    constexpr static const bool is_input = false;
+
+    template <class Units>
+    static std::nullptr_t buf(Units&) { return nullptr; }
+
+};
+
+#define STATIC_PORT(unit, Type, port)                                   \
+    StaticPort<(unit), decltype(&Type::port), &Type::port>
+
+
+// -- Static Links -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+template <class Dest, class Src, class Ctl, bool Scaled>
+class BasicStaticLink {
+
+public:
+
+    typedef Dest dest;
+    typedef Src src;
+    typedef Ctl ctl;
+
+    static_assert(Dest::is_input, "link destination must be an Input");
+    static_assert(!Src::is_input && !Ctl::is_input,
+                  "link source and control must be Outputs");
+    static_assert(Scaled ||
+                  !std::is_same<Src, NoPort>::value ||
+                  !std::is_same<Ctl, NoPort>::value,
+                  "link has no source, no control and no scale");
+
+    // True if the link could be an alias, if it is alone.
+    constexpr static const bool is_simple =
+        !Scaled &&
+        std::is_same<Src, NoPort>::value != std::is_same<Ctl, NoPort>::value
+        && std::is_same<typename Dest::element_type,
+                        typename std::conditional<
+                            std::is_same<Src, NoPort>::value,
+                            Ctl, Src>::type::element_type>::value;
+
+    BasicStaticLink() : scale{DEFAULT_SCALE} {}
+
+    SCALE_TYPE scale;
+
+    template <class Units>
+    void alias(Units& units) const
+    {
+        typedef typename std::conditional<std::is_same<Src, NoPort>::value,
+                                          Ctl, Src>::type source;
+        Dest::get(units).alias(source::get(units).void_buf());
+    }
+
+    template <class Units>
+    void copy(Units& units, size_t frame_count) const
+    {
+        auto *dest_buf = Dest::get(units).buf();
+        auto src_buf = Src::buf(units);
+        auto ctl_buf = Ctl::buf(units);
+        std::integral_constant<bool, Scaled> is_scaled;
+        for (size_t i = 0; i < frame_count; i++)
+            dest_buf[i] = static_util::scaled(
+                static_util::sample(src_buf, ctl_buf, i), scale, is_scaled);
+    }
+
+    template <class Units>
+    void add(Units& units, size_t frame_count) const
+    {
+        auto *dest_buf = Dest::get(units).buf();
+        auto src_buf = Src::buf(units);
+        auto ctl_buf = Ctl::buf(units);
+        std::integral_constant<bool, Scaled> is_scaled;
+        for (size_t i = 0; i < frame_count; i++)
+            dest_buf[i] += static_util::scaled(
+                static_util::sample(src_buf, ctl_buf, i), scale, is_scaled);
+    }
+
+};
+
+template <class Dest, class Src, class Ctl = NoPort>
+using StaticLink = BasicStaticLink<Dest, Src, Ctl, false>;
+
+template <class Dest, class Src = NoPort, class Ctl = NoPort>
+using ScaledLink = BasicStaticLink<Dest, Src, Ctl, true>;
+
+
+// -- Static Pipeline  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+template <class Units, class Links>
+class StaticPipeline;
+
+template <class... Units, class... Links>
+class StaticPipeline<std::tuple<Units...>, std::tuple<Links...>> {
+
+public:
+
+    typedef std::tuple<Units...> unit_tuple;
+    typedef std::tuple<Links...> link_tuple;
+
+    constexpr static const size_t unit_count = sizeof...(Units);
+    constexpr static const size_t link_count = sizeof...(Links);
+
+    template <size_t U>
+    using unit_type = typename std::tuple_element<U, unit_tuple>::type;
+
+    template <size_t I>
+    using link_type = typename std::tuple_element<I, link_tuple>::type;
+
+private:
+
+    typedef typename static_util::make_index_list<unit_count>::type
+        unit_indices;
+    typedef typename static_util::make_index_list<link_count>::type
+        link_indices;
+
+    // rank<U, D>::value is the length of the longest chain of links
+    // into unit U, searching D links deep.  The search stops at
+    // unit_count links, which only a cycle reaches.
+    template <size_t U, size_t D, bool Stop = (D >= unit_count)>
+    struct rank {
+        constexpr static const size_t value = unit_count;
+    };
+
+    template <size_t V, size_t D>
+    struct rank_after {
+        constexpr static const size_t value = rank<V, D + 1>::value + 1;
+    };
+
+    template <size_t D>
+    struct rank_after<static_util::npos, D> {
+        constexpr static const size_t value = 0;
+    };
+
+    template <class L, size_t U, size_t D>
+    struct link_rank {
+        constexpr static const size_t value =
+            L::dest::unit != U
+                ? 0
+                : static_util::max_of(
+                      rank_after<L::src::unit, D>::value,
+                      rank_after<L::ctl::unit, D>::value);
+    };
+
+    template <size_t U, size_t D>
+    struct rank<U, D, false> {
+        constexpr static const size_t value =
+            static_util::max_of(link_rank<Links, U, D>::value...);
+    };
+
+    template <size_t U>
+    struct unit_rank {
+        constexpr static const size_t value = rank<U, 0>::value;
+        static_assert(value < unit_count, "static pipeline has a cycle");
+    };
+
+    template <size_t U, size_t V>
+    struct renders_before {
+        constexpr static const bool value =
+            unit_rank<V>::value < unit_rank<U>::value ||
+            (unit_rank<V>::value == unit_rank<U>::value && V < U);
+    };
+
+    template <size_t U, class = unit_indices>
+    struct position;
+
+    template <size_t U, size_t... V>
+    struct position<U, static_util::index_list<V...>> {
+        constexpr static const size_t value =
+            static_util::sum_of(renders_before<U, V>::value...);
+    };
+
+    template <size_t K, class = unit_indices>
+    struct unit_at;
+
+    template <size_t K, size_t... U>
+    struct unit_at<K, static_util::index_list<U...>> {
+        constexpr static const size_t value =
+            static_util::sum_of((position<U>::value == K ? U : 0)...);
+    };
+
+    // Links into the same input as link I.
+    template <size_t I, size_t... J>
+    constexpr static size_t links_into(static_util::index_list<J...>)
+    {
+        return static_util::sum_of(
+            std::is_same<typename link_type<I>::dest,
+                         typename link_type<J>::dest>::value...);
+    }
+
+    // Links into the same input as link I, before link I.
+    template <size_t I, size_t... J>
+    constexpr static size_t links_before(static_util::index_list<J...>)
+    {
+        return static_util::sum_of(
+            (J < I &&
+             std::is_same<typename link_type<I>::dest,
+                          typename link_type<J>::dest>::value)...);
+    }
+
+    template <size_t I>
+    struct link_info {
+        constexpr static const bool is_alias =
+            link_type<I>::is_simple && links_into<I>(link_indices()) == 1;
+        constexpr static const bool is_first =
+            links_before<I>(link_indices()) == 0;
+    };
+
+public:
+
+    StaticPipeline() { prep(unit_indices(), link_indices()); }
+
+    explicit StaticPipeline(const Units&... units)
+    : m_units{units...}
+    {
+        prep(unit_indices(), link_indices());
+    }
+
+    StaticPipeline(const StaticPipeline&) = delete;
+    StaticPipeline& operator = (const StaticPipeline&) = delete;
+
+    template <size_t U>
+    unit_type<U>& unit() { return std::get<U>(m_units); }
+
+    template <size_t U>
+    const unit_type<U>& unit() const { return std::get<U>(m_units); }
+
+    template <size_t I>
+    link_type<I>& link() { return std::get<I>(m_links); }
+
+    template <size_t I>
+    const link_type<I>& link() const { return std::get<I>(m_links); }
+
+    // The index of the Kth unit rendered.
+    template <size_t K>
+    constexpr static size_t render_order()
+    {
+        return unit_at<K>::value;
+    }
+
+    void configure(const Config& cfg)
+    {
+        configure(cfg, unit_indices());
+    }
+
+    void render(size_t frame_count)
+    {
+        render(frame_count, unit_indices());
+    }
+
+private:
+
+    template <size_t... U, size_t... I>
+    void prep(static_util::index_list<U...>, static_util::index_list<I...>)
+    {
+        int clear[] = {0, (clear_inputs(std::get<U>(m_units)), 0)...};
+        int alias[] = {0, (alias_link<I>(
+            std::integral_constant<bool, link_info<I>::is_alias>()), 0)...};
+        (void)clear;
+        (void)alias;
+    }
+
+    template <class Unit>
+    static void clear_inputs(Unit& unit)
+    {
+        for (auto *p: unit.ports()) {
+            InputPort *in = dynamic_cast<InputPort *>(p);
+            if (in)
+                in->clear(0);
+        }
+    }
+
+    template <size_t I>
+    void alias_link(std::true_type)
+    {
+        std::get<I>(m_links).alias(m_units);
+    }
+
+    template <size_t I>
+    void alias_link(std::false_type) {}
+
+    template <size_t... U>
+    void configure(const Config& cfg, static_util::index_list<U...>)
+    {
+        int configured[] = {0, (configure_unit(cfg, std::get<U>(m_units)),
+                                0)...};
+        (void)configured;
+    }
+
+    template <class Unit>
+    static void configure_unit(const Config& cfg, Unit& unit)
+    {
+        cfg.pre_configure(unit);
+        unit.configure(cfg);
+        cfg.post_configure(unit);
+    }
+
+    template <size_t... K>
+    void render(size_t frame_count, static_util::index_list<K...>)
+    {
+        int rendered[] = {0, (render_unit<unit_at<K>::value>(
+                                  frame_count, link_indices()), 0)...};
+        (void)rendered;
+    }
+
+    // Copy the links into unit U, then render it.
+    template <size_t U, size_t... I>
+    void render_unit(size_t frame_count, static_util::index_list<I...>)
+    {
+        int copied[] = {0, (copy_link<I>(
+            frame_count,
+            std::integral_constant<bool,
+                link_type<I>::dest::unit == U &&
+                !link_info<I>::is_alias>(),
+            std::integral_constant<bool, link_info<I>::is_first>()), 0)...};
+        (void)copied;
+        std::get<U>(m_units).render(frame_count);
+    }
+
+    template <size_t I, bool IsFirst>
+    void copy_link(size_t,
+                   std::false_type,
+                   std::integral_constant<bool, IsFirst>)
+    {}
+
+    template <size_t I>
+    void copy_link(size_t frame_count, std::true_type, std::true_type)
+    {
+        std::get<I>(m_links).copy(m_units, frame_count);
+    }
+
+    template <size_t I>
+    void copy_link(size_t frame_count, std::true_type, std::false_type)
+    {
+        std::get<I>(m_links).add(m_units, frame_count);
+    }
+
+    unit_tuple m_units;
+    link_tuple m_links;
+
+};
+
+#endif /* !STATIC_PIPELINE_included */
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <iostream>
 #include <limits>
+#include <type_traits>
 
 #include "synth/core/action.h"
 #include "synth/core/defs.h"
@@ -18,8 +19,32 @@
 
 namespace step_util {
 
-    typedef std::uint8_t index_type;
-    typedef std::int8_t opt_index_type;
+    // Indices are stored in the smallest type that holds them, so
+    // small synths keep small steps and big patches still fit.
+
+    template <size_t N>
+    using unsigned_for =
+        typename std::conditional<
+            (N <= UINT8_MAX), std::uint8_t,
+            typename std::conditional<
+                (N <= UINT16_MAX), std::uint16_t,
+                std::uint32_t>::type>::type;
+
+    template <size_t N>
+    using signed_for =
+        typename std::conditional<
+            (N <= INT8_MAX), std::int8_t,
+            typename std::conditional<
+                (N <= INT16_MAX), std::int16_t,
+                std::int32_t>::type>::type;
+
+    constexpr static const size_t max_index =
+        MAX_PORTS > MAX_MODULES
+            ? (MAX_PORTS > MAX_CONTROLS ? MAX_PORTS : MAX_CONTROLS)
+            : (MAX_MODULES > MAX_CONTROLS ? MAX_MODULES : MAX_CONTROLS);
+
+    typedef unsigned_for<max_index> index_type;
+    typedef signed_for<MAX_PORTS> opt_index_type;
 
     constexpr static const index_type imax
         = std::numeric_limits<index_type>::max();
@@ -91,6 +116,12 @@ public:
         dest->clear(m_scale);
     }
 
+    friend bool operator == (const ClearStep& a, const ClearStep& b)
+    {
+        return a.m_dest_port_index == b.m_dest_port_index &&
+               a.m_scale == b.m_scale;
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const ClearStep& s)
     {
@@ -107,6 +138,7 @@ private:
     SCALE_TYPE            m_scale;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -130,6 +162,12 @@ public:
             dest->alias(nullptr);
     }
 
+    friend bool operator == (const AliasStep& a, const AliasStep& b)
+    {
+        return a.m_dest_port_index == b.m_dest_port_index &&
+               a.m_src_port_index == b.m_src_port_index;
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const AliasStep& s)
     {
@@ -146,6 +184,7 @@ private:
     step_util::opt_index_type m_src_port_index;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -186,6 +225,28 @@ public:
         }
     }
 
+    friend bool operator == (const PrepStep& a, const PrepStep& b)
+    {
+        if (a.m_tag != b.m_tag)
+            return false;
+        switch (a.m_tag) {
+
+        case Tag::CLEAR:
+            return a.m_u.clear == b.m_u.clear;
+
+        case Tag::ALIAS:
+            return a.m_u.alias == b.m_u.alias;
+
+        default:
+            return true;
+        }
+    }
+
+    friend bool operator != (const PrepStep& a, const PrepStep& b)
+    {
+        return !(a == b);
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const PrepStep& s)
     {
@@ -217,6 +278,7 @@ private:
     } m_u;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -237,6 +299,12 @@ public:
         return ctl->make_render_action();
     }
 
+    friend bool
+    operator == (const ControlRenderStep& a, const ControlRenderStep& b)
+    {
+        return a.m_ctl_index == b.m_ctl_index;
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const ControlRenderStep s)
     {
@@ -248,6 +316,7 @@ private:
     step_util::index_type m_ctl_index;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -266,6 +335,12 @@ public:
         return mod->make_render_action();
     }
 
+    friend bool
+    operator == (const ModuleRenderStep& a, const ModuleRenderStep& b)
+    {
+        return a.m_mod_index == b.m_mod_index;
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const ModuleRenderStep s)
     {
@@ -277,6 +352,7 @@ private:
     step_util::index_type m_mod_index;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -292,7 +368,8 @@ public:
     : m_dest_port_index{step_util::index_type(dest_port_index)},
       m_src_port_index{step_util::opt_index_type(src_port_index)},
       m_ctl_port_index{step_util::opt_index_type(ctl_port_index)},
-      m_link{link}
+      m_link{link},
+      m_scale{link->scale()}
     {}
 
     render_action make_action(const Resolver& res) const
@@ -304,6 +381,16 @@ public:
         return m_link->make_copy_action(dest, src, ctl);
     }
 
+    // Steps are equal if their actions would be: same ports, same
+    // scale.  The Link itself doesn't matter.
+    friend bool operator == (const CopyStep& a, const CopyStep& b)
+    {
+        return a.m_dest_port_index == b.m_dest_port_index &&
+               a.m_src_port_index == b.m_src_port_index &&
+               a.m_ctl_port_index == b.m_ctl_port_index &&
+               a.m_scale == b.m_scale;
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const CopyStep& s)
     {
@@ -322,8 +409,10 @@ private:
     step_util::opt_index_type m_src_port_index;
     step_util::opt_index_type m_ctl_port_index;
     const Link               *m_link;
+    SCALE_TYPE                m_scale;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -339,7 +428,8 @@ public:
     : m_dest_port_index{step_util::index_type(dest_port_index)},
       m_src_port_index{step_util::opt_index_type(src_port_index)},
       m_ctl_port_index{step_util::opt_index_type(ctl_port_index)},
-      m_link{link}
+      m_link{link},
+      m_scale{link->scale()}
     {}
 
     render_action make_action(const Resolver& res) const
@@ -352,6 +442,16 @@ public:
 
     }
 
+    // Steps are equal if their actions would be: same ports, same
+    // scale.  The Link itself doesn't matter.
+    friend bool operator == (const AddStep& a, const AddStep& b)
+    {
+        return a.m_dest_port_index == b.m_dest_port_index &&
+               a.m_src_port_index == b.m_src_port_index &&
+               a.m_ctl_port_index == b.m_ctl_port_index &&
+               a.m_scale == b.m_scale;
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const AddStep& s)
     {
@@ -370,8 +470,10 @@ private:
     step_util::opt_index_type m_src_port_index;
     step_util::opt_index_type m_ctl_port_index;
     const Link               *m_link;
+    SCALE_TYPE                m_scale;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
@@ -426,6 +528,34 @@ public:
         }
     }
 
+    friend bool operator == (const RenderStep& a, const RenderStep& b)
+    {
+        if (a.m_tag != b.m_tag)
+            return false;
+        switch (a.m_tag) {
+
+        case Tag::CONTROL_RENDER:
+            return a.m_u.crend == b.m_u.crend;
+
+        case Tag::MODULE_RENDER:
+            return a.m_u.mrend == b.m_u.mrend;
+
+        case Tag::COPY:
+            return a.m_u.copy == b.m_u.copy;
+
+        case Tag::ADD:
+            return a.m_u.add == b.m_u.add;
+
+        default:
+            return true;
+        }
+    }
+
+    friend bool operator != (const RenderStep& a, const RenderStep& b)
+    {
+        return !(a == b);
+    }
+
     friend std::ostream&
     operator << (std::ostream& o, const RenderStep& s)
     {
@@ -467,6 +597,7 @@ private:
     } m_u;
 
     friend class steps_unit_test;
+    friend class PlanCodec;
 
 };
 
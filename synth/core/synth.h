@@ -1,12 +1,15 @@
 #ifndef SYNTH_included
 #define SYNTH_included
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 
 #include "synth/core/action.h"
 #include "synth/core/assigners.h"
 #include "synth/core/sizes.h"
 #include "synth/core/patch.h"
+#include "synth/core/plan-codec.h"
 #include "synth/core/planner.h"
 #include "synth/core/resolver.h"
 #include "synth/core/sizes.h"
@@ -32,9 +35,11 @@ class Module;
 //     a list of output modules
 //     a set of timbres
 //     a set of voices
+//     a shared voice per timbre, for hoisted voice modules
 //
 // A Synth can:
 //     apply a patch to a timbre
+//     save a timbre's plan and apply a saved plan
 //     allocate a voice
 //     attach a voice to a timbre
 //     detach a voice from a timbre
@@ -63,6 +68,18 @@ public:
         m_voices.emplace_back(false);
     }
 
+    Synth(const Synth&) = delete;
+    Synth& operator = (const Synth&) = delete;
+
+    ~Synth()
+    {
+        const auto& arch = m_voices.front().modules();
+        for (auto& shared: m_shared_modules)
+            for (size_t i = 0; i < shared.size(); i++)
+                if (shared[i] != arch[i])
+                    delete shared[i];
+    }
+
     const timbre_vector& timbres() const { return m_timbres; }
     timbre_vector& timbres() { return m_timbres; }
 
@@ -70,7 +87,12 @@ public:
     voice_vector& voices() { return m_voices; }
 
     const Assigner *assigner() const { return m_assigner; }
-    void assigner(Assigner *a) { m_assigner = a; }
+    void assigner(Assigner *a)
+    {
+        m_assigner = a;
+        for (auto& voice: m_voices)
+            voice.assigner(a);
+    }
 
     Synth& add_timbre_control(Control& ctl)
     {
@@ -135,30 +157,161 @@ public:
             voice.configure(cfg);
             cfg.post_configure(voice);
         }
+        make_shared_modules(cfg);
         cfg.post_configure(*this);
     }
 
     void apply_patch(Patch& patch, Timbre& timbre)
     {
         assert(m_finalized);
+        apply_plan(patch, timbre, make_plan(patch));
+    }
+
+    // The graph hash a saved plan for `patch` must match.  See
+    // PlanCodec.
+    std::uint64_t graph_hash(const Patch& patch) const
+    {
         auto& arch_timbre = m_timbres.front();
         auto& arch_voice = m_voices.front();
-        timbre.set_patch(&patch);
-        auto planner = Planner(arch_timbre.controls(),
-                               arch_timbre.modules(),
-                               arch_voice.controls(),
-                               arch_voice.modules(),
-                               patch.links(),
-                               m_output_modules);
-        auto plan = planner.make_plan();
+        Resolver resolver;
+        resolver.add_controls(arch_timbre.controls().begin(),
+                              arch_timbre.controls().end())
+                .add_modules(arch_timbre.modules().begin(),
+                             arch_timbre.modules().end())
+                .add_controls(arch_voice.controls().begin(),
+                              arch_voice.controls().end())
+                .add_modules(arch_voice.modules().begin(),
+                             arch_voice.modules().end())
+                .finalize();
+        return PlanCodec::graph_hash(resolver, m_output_modules,
+                                     patch.links());
+    }
+
+    // Save the timbre's plan into buf if it fits in `size` bytes.
+    // Returns the saved plan's size either way.
+    size_t save_plan(const Timbre& timbre,
+                     std::uint8_t *buf,
+                     size_t size) const
+    {
+        const Patch *patch = timbre.current_patch();
+        assert(patch);
+        return PlanCodec::encode(timbre.plan(), patch->links(),
+                                 graph_hash(*patch), buf, size);
+    }
+
+    // Apply a patch with a plan saved by `save_plan` instead of
+    // running the Planner.  Returns false, changing nothing, if the
+    // plan was saved for another synth or patch.
+    bool apply_saved_plan(Patch& patch,
+                          Timbre& timbre,
+                          const std::uint8_t *blob,
+                          size_t size)
+    {
+        assert(m_finalized);
+        Plan plan;
+        if (!PlanCodec::decode(blob, size, patch.links(),
+                               graph_hash(patch), plan))
+            return false;
+        apply_plan(patch, timbre, plan);
+        return true;
+    }
+
+    // Reapply a timbre's patch after its links changed.  When the
+    // modules' render order and the hoisted modules are the same,
+    // only the changed prep steps are run, and only the actions of
+    // changed steps are remade; the timbre's and its voices' other
+    // actions are kept.  Otherwise the patch is applied again and
+    // the attached voices are reattached.  Returns the number of
+    // actions made.
+    size_t update_patch(Patch& patch, Timbre& timbre)
+    {
+        assert(m_finalized);
+        const Plan old_plan = timbre.plan();
+        Plan plan = make_plan(patch);
+        if (plan.hoisted() != old_plan.hoisted() ||
+            !same_order(old_plan.pre_render(), plan.pre_render()) ||
+            !same_order(old_plan.v_render(), plan.v_render()) ||
+            !same_order(old_plan.post_render(), plan.post_render())) {
+            apply_patch(patch, timbre);
+            size_t made = plan.pre_render().size() +
+                          plan.post_render().size();
+            for (size_t vi = 0; vi < m_voices.size(); vi++) {
+                if (timbre.attached_voices().test(vi)) {
+                    attach_voice_to_timbre(timbre, m_voices[vi]);
+                    made += plan.v_render().size();
+                }
+            }
+            return made;
+        }
+
         timbre.set_patch(&patch);
         timbre.plan(plan);
+        size_t made = 0;
+        {
+            Resolver resolver;
+            resolve_timbre(timbre, resolver);
+            update_prep(old_plan.t_prep(), plan.t_prep(), resolver);
+            auto pre = timbre.pre_actions();
+            made += update_actions(old_plan.pre_render(), plan.pre_render(),
+                                   pre, resolver);
+            timbre.pre_actions(pre);
+            auto post = timbre.post_actions();
+            made += update_actions(old_plan.post_render(),
+                                   plan.post_render(),
+                                   post, resolver);
+            timbre.post_actions(post);
+        }
+        for (size_t vi = 0; vi < m_voices.size(); vi++) {
+            if (!timbre.attached_voices().test(vi))
+                continue;
+            Voice& voice = m_voices[vi];
+            Resolver resolver;
+            resolve_voice(timbre, voice, resolver);
+            update_prep(old_plan.v_prep(), plan.v_prep(), resolver);
+            auto actions = voice.actions();
+            made += update_actions(old_plan.v_render(), plan.v_render(),
+                                   actions, resolver);
+            voice.actions(actions);
+        }
+        return made;
+    }
+
+    void attach_voice_to_timbre(Timbre& timbre, Voice& voice)
+    {
+        assert(m_finalized);
+        auto& plan = timbre.plan();
         Resolver resolver;
-        resolver.add_controls(timbre.controls().begin(),
-                              timbre.controls().end())
-                .add_modules(timbre.modules().begin(),
-                             timbre.modules().end())
-                .finalize();
+        resolve_voice(timbre, voice, resolver);
+
+        voice.timbre(&timbre);
+        timbre.add_voice(&voice - m_voices.data());
+
+        // perform the prep steps.
+        for (auto& step: plan.v_prep())
+            step.prep(resolver);
+
+        // create the voice action sequence.
+        render_action_sequence actions;
+        for (auto& step: plan.v_render())
+            actions.push_back(step.make_action(resolver));
+        voice.actions(actions);
+    }
+
+    void detach_voice_from_timbre(Timbre& timbre, Voice& voice)
+    {
+        voice.timbre(nullptr);
+        timbre.remove_voice(&voice - m_voices.data());
+    }
+
+private:
+
+    void apply_plan(Patch& patch, Timbre& timbre, const Plan& new_plan)
+    {
+        timbre.set_patch(&patch);
+        timbre.plan(new_plan);
+        auto& plan = timbre.plan();
+        Resolver resolver;
+        resolve_timbre(timbre, resolver);
 
         // perform the prep steps.
         for (auto& step: plan.t_prep())
@@ -177,49 +330,181 @@ public:
         timbre.post_actions(post);   // XXX should construct in place
     }
 
-    void attach_voice_to_timbre(Timbre& timbre, Voice& voice)
+    Plan make_plan(const Patch& patch) const
+    {
+        auto& arch_timbre = m_timbres.front();
+        auto& arch_voice = m_voices.front();
+        auto planner = Planner(arch_timbre.controls(),
+                               arch_timbre.modules(),
+                               arch_voice.controls(),
+                               arch_voice.modules(),
+                               patch.links(),
+                               m_output_modules);
+        return planner.make_plan();
+    }
+
+    void resolve_timbre(Timbre& timbre, Resolver& resolver)
     {
-        assert(m_finalized);
-        // populate the resolver.
-        Resolver resolver;
+        resolver.add_controls(timbre.controls().begin(),
+                              timbre.controls().end())
+                .add_modules(timbre.modules().begin(),
+                             timbre.modules().end());
+        if (timbre.plan().hoisted().any()) {
+            // Hoisted modules are the timbre's shared modules.
+            const Voice& arch = m_voices.front();
+            const auto& shared = shared_modules(timbre);
+            resolver.add_controls(arch.controls().begin(),
+                                  arch.controls().end())
+                    .add_modules(shared.begin(), shared.end());
+        }
+        resolver.finalize();
+    }
+
+    // Hoisted modules resolve to the timbre's shared voice, so the
+    // voice reads their outputs.
+    void resolve_voice(Timbre& timbre, Voice& voice, Resolver& resolver)
+    {
+        auto& plan = timbre.plan();
+        Voice::module_vector modules = voice.modules();
+        if (plan.hoisted().any()) {
+            const auto& shared = shared_modules(timbre);
+            for (size_t i = 0; i < modules.size(); i++) {
+                if (plan.hoisted().test(i)) {
+                    assert(!modules[i]->tracks_notes());
+                    modules[i] = shared[i];
+                }
+            }
+        }
         resolver.add_controls(timbre.controls().begin(),
                               timbre.controls().end())
                 .add_modules(timbre.modules().begin(),
                              timbre.modules().end())
                 .add_controls(voice.controls().begin(),
                               voice.controls().end())
-                .add_modules(voice.modules().begin(),
-                             voice.modules().end())
+                .add_modules(modules.begin(), modules.end())
                 .finalize();
+    }
 
-        auto& plan = timbre.plan();
+    static bool is_link_step(const RenderStep& step)
+    {
+        return step.tag() == RenderStep::Tag::COPY ||
+               step.tag() == RenderStep::Tag::ADD;
+    }
 
-        voice.timbre(&timbre);
-        timbre.add_voice(&voice - m_voices.data());
+    // True if two render sequences render the same controls and
+    // modules in the same order.  Their link steps may differ.
+    static bool same_order(const Plan::render_step_sequence& a,
+                           const Plan::render_step_sequence& b)
+    {
+        size_t i = 0, j = 0;
+        while (true) {
+            while (i < a.size() && is_link_step(a[i]))
+                i++;
+            while (j < b.size() && is_link_step(b[j]))
+                j++;
+            if (i == a.size() || j == b.size())
+                return i == a.size() && j == b.size();
+            if (a[i++] != b[j++])
+                return false;
+        }
+    }
 
-        // perform the prep steps.
-        for (auto& step: plan.v_prep())
-            step.prep(resolver);
+    // Run the prep steps that differ from the old ones.  There is one
+    // prep step per input port, so the sequences line up unless the
+    // modules changed.
+    static void update_prep(const Plan::prep_step_sequence& old_steps,
+                            const Plan::prep_step_sequence& new_steps,
+                            const Resolver& resolver)
+    {
+        bool lined_up = old_steps.size() == new_steps.size();
+        for (size_t i = 0; i < new_steps.size(); i++)
+            if (!lined_up || new_steps[i] != old_steps[i])
+                new_steps[i].prep(resolver);
+    }
 
-        // create the voice action sequence.
-        render_action_sequence actions;
-        for (auto& step: plan.v_render())
-            actions.push_back(step.make_action(resolver));
-        voice.actions(actions);
+    // Remake a section's actions for new steps in the same order.
+    // Each module's render step is preceded by the link steps into
+    // its inputs; where those line up with the old ones, the old
+    // actions of equal steps are kept.  Returns the number of actions
+    // made.
+    static size_t update_actions(const Plan::render_step_sequence& old_steps,
+                                 const Plan::render_step_sequence& new_steps,
+                                 render_action_sequence& actions,
+                                 const Resolver& resolver)
+    {
+        assert(actions.size() == old_steps.size());
+        render_action_sequence new_actions;
+        size_t made = 0;
+        size_t i = 0, j = 0;
+        while (j < new_steps.size()) {
+            size_t i_end = i, j_end = j;
+            while (i_end < old_steps.size() && is_link_step(old_steps[i_end]))
+                i_end++;
+            while (j_end < new_steps.size() && is_link_step(new_steps[j_end]))
+                j_end++;
+            bool lined_up = i_end - i == j_end - j;
+            for (size_t k = 0; j + k < j_end; k++) {
+                if (lined_up && new_steps[j + k] == old_steps[i + k])
+                    new_actions.push_back(actions[i + k]);
+                else {
+                    new_actions.push_back(
+                        new_steps[j + k].make_action(resolver));
+                    made++;
+                }
+            }
+            // The render steps are the same.
+            if (j_end < new_steps.size())
+                new_actions.push_back(actions[i_end++]);
+            i = i_end;
+            j = j_end + 1;
+        }
+        actions = new_actions;
+        return made;
     }
 
-    void detach_voice_from_timbre(Timbre& timbre, Voice& voice)
+    // Each timbre has its own copy of the voice modules that could
+    // be hoisted, i.e., those that don't track notes and aren't
+    // twins.  (Twins are never hoisted and may not be cloned
+    // freely.)  The other slots hold the archetype's modules, so
+    // indices match the voices'.  Only hoisted modules are ever
+    // rendered.  The copies are made and configured at finalize
+    // time, so applying a patch never allocates or configures.
+    void make_shared_modules(const Config& cfg)
     {
-        voice.timbre(nullptr);
-        timbre.remove_voice(&voice - m_voices.data());
+        const auto& arch = m_voices.front().modules();
+        Voice::module_vector twins;
+        for (auto *m: m_timbres.front().modules())
+            if (m->twin())
+                twins.push_back(m->twin());
+        for (size_t i = 0; i < timbrality; i++) {
+            m_shared_modules.emplace_back();
+            for (auto *m: arch) {
+                if (m->tracks_notes() ||
+                    std::find(twins.begin(), twins.end(), m) !=
+                    twins.end()) {
+                    m_shared_modules.back().push_back(m);
+                    continue;
+                }
+                Module *copy = m->clone();
+                cfg.pre_configure(*copy);
+                copy->configure(cfg);
+                cfg.post_configure(*copy);
+                m_shared_modules.back().push_back(copy);
+            }
+        }
     }
 
-private:
+    const Voice::module_vector& shared_modules(const Timbre& timbre) const
+    {
+        assert(m_finalized);
+        return m_shared_modules[&timbre - m_timbres.data()];
+    }
 
     bool m_finalized;
     fixed_vector<Module *, MAX_OUTPUT_MODULES> m_output_modules;
     timbre_vector m_timbres;
     voice_vector m_voices;
+    fixed_vector<Voice::module_vector, MAX_TIMBRALITY> m_shared_modules;
     Assigner *m_assigner;
 
     friend class synth_unit_test;
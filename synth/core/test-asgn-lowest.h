@@ -0,0 +1,76 @@
+#include "asgn-lowest.h"
+
+#include <cxxtest/TestSuite.h>
+
+class lowest_priority_assigner_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        Synth s("TestSynth", 1, 1);
+        (void)LowestPriorityAssigner(s, [] (const Voice&) { return 0u; });
+    }
+
+    void test_steal()
+    {
+        Synth s("TestSynth", 4, 1);
+        unsigned prio[4] = { 5, 2, 7, 2 };
+        LowestPriorityAssigner a(s, [&] (const Voice& v) {
+            return prio[&v - s.voices().data()];
+        });
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+        auto& v = s.voices();
+
+        for (size_t i = 0; i < 4; i++) {
+            Voice *vi = a.assign_idle_voice();
+            TS_ASSERT_EQUALS(vi, &v[i]);
+            vi->start_note();
+        }
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), nullptr);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+
+        v[1].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[3]);
+
+        // A releasing voice goes first, whatever its priority.
+        v[2].release_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[2]);
+
+        v[2].kill_note();
+        v[3].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+        v[0].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), nullptr);
+    }
+
+    void test_retrigger()
+    {
+        Synth s("TestSynth", 2, 1);
+        unsigned prio[2] = { 3, 9 };
+        LowestPriorityAssigner a(s, [&] (const Voice& v) {
+            return prio[&v - s.voices().data()];
+        });
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+        auto& v = s.voices();
+
+        a.assign_idle_voice()->start_note();
+        a.assign_idle_voice()->start_note();
+        v[0].release_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+
+        // Retrigger at a new priority; no releasing voice is left.
+        prio[0] = 12;
+        v[0].start_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+        v[1].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+        v[0].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), nullptr);
+    }
+
+};
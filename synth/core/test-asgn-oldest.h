@@ -0,0 +1,46 @@
+#include "asgn-oldest.h"
+
+#include <cxxtest/TestSuite.h>
+
+class oldest_assigner_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        Synth s("TestSynth", 1, 1);
+        (void)OldestAssigner(s);
+    }
+
+    void test_assign()
+    {
+        Synth s("TestSynth", 3, 1);
+        OldestAssigner a(s);
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+        auto& v = s.voices();
+
+        Voice *v0 = a.assign_idle_voice();
+        TS_ASSERT_EQUALS(v0, &v[0]);
+        v0->start_note();
+        Voice *v1 = a.assign_idle_voice();
+        TS_ASSERT_EQUALS(v1, &v[1]);
+        v1->start_note();
+
+        // Voice 0 finishes.  Voice 2 has been idle longer.
+        v0->release_note();
+        v0->render(1);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[2]);
+        v[2].start_note();
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[0]);
+        v[0].start_note();
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), nullptr);
+
+        // Oldest is voice 1, but releasing voices go first.
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+        v[0].release_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+    }
+
+};
@@ -0,0 +1,47 @@
+#include "asgn-quiet.h"
+
+#include <cxxtest/TestSuite.h>
+
+class quietest_assigner_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        Synth s("TestSynth", 1, 1);
+        (void)QuietestAssigner(s, [] (const Voice&) { return 0.0f; });
+    }
+
+    void test_steal()
+    {
+        Synth s("TestSynth", 4, 1);
+        float level[4] = { 0.5f, 0.1f, 0.3f, 0.05f };
+        QuietestAssigner a(s, [&] (const Voice& v) {
+            return level[&v - s.voices().data()];
+        });
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+        auto& v = s.voices();
+
+        for (size_t i = 0; i < 4; i++) {
+            Voice *vi = a.assign_idle_voice();
+            TS_ASSERT_EQUALS(vi, &v[i]);
+            vi->start_note();
+        }
+
+        // Nothing releasing: oldest.
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+
+        v[0].release_note();
+        v[2].release_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[2]);
+        v[1].release_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+
+        // Voice 3 is quietest, but it is not releasing.
+        v[1].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[2]);
+    }
+
+};
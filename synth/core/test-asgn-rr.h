@@ -0,0 +1,44 @@
+#include "asgn-rr.h"
+
+#include <cxxtest/TestSuite.h>
+
+class round_robin_assigner_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        Synth s("TestSynth", 1, 1);
+        (void)RoundRobinAssigner(s);
+    }
+
+    void test_assign()
+    {
+        Synth s("TestSynth", 3, 1);
+        RoundRobinAssigner a(s);
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+        auto& v = s.voices();
+
+        for (size_t i = 0; i < 3; i++) {
+            Voice *vi = a.assign_idle_voice();
+            TS_ASSERT_EQUALS(vi, &v[i]);
+            vi->start_note();
+        }
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), nullptr);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+
+        // Free 2 then 0.  The rotor is past 2, so 0 comes first.
+        v[2].release_note();
+        v[2].render(1);
+        v[0].release_note();
+        v[0].render(1);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[0]);
+        v[0].start_note();
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[2]);
+        v[2].start_note();
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), nullptr);
+    }
+
+};
@@ -0,0 +1,57 @@
+#include "asgn-same.h"
+
+#include <cxxtest/TestSuite.h>
+
+class same_note_assigner_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        Synth s("TestSynth", 1, 1);
+        (void)SameNoteAssigner(s);
+    }
+
+    void test_reuse()
+    {
+        Synth s("TestSynth", 3, 1);
+        SameNoteAssigner a(s);
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+        auto& v = s.voices();
+
+        a.next_note(60);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[0]);
+        v[0].start_note();
+        a.next_note(64);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[1]);
+        v[1].start_note();
+
+        // Note 60 ends; playing it again gets voice 0 back, although
+        // voice 2 has been idle longer.
+        v[0].release_note();
+        v[0].render(1);
+        a.next_note(60);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[0]);
+        v[0].start_note();
+
+        a.next_note(67);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &v[2]);
+        v[2].start_note();
+
+        // Full.  Note 64 steals its own voice; a new note steals the
+        // oldest.
+        a.next_note(64);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), nullptr);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+        a.next_note(72);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+        a.next_note(60);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+        a.next_note(67);
+        v[2].kill_note();
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+    }
+
+};
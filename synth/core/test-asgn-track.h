@@ -0,0 +1,114 @@
+#include "asgn-track.h"
+
+#include <cxxtest/TestSuite.h>
+
+class tracking_assigner_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    class FooAssigner : public TrackingAssigner {
+    public:
+        FooAssigner(Synth& s) : TrackingAssigner{s} {}
+        Voice *assign_idle_voice() override
+        {
+            return voice_or_null(take_idle());
+        }
+        Voice *choose_voice_to_steal() override
+        {
+            return voice_or_null(oldest_active());
+        }
+    };
+
+    static void finalize(Synth& s)
+    {
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        s.finalize(cfg);
+    }
+
+    void test_instantiate()
+    {
+        (void)VoiceBits();
+        Synth s("TestSynth", 1, 1);
+        (void)FooAssigner(s);
+    }
+
+    void test_voice_bits()
+    {
+        VoiceBits b;
+        TS_ASSERT(!b.any());
+        TS_ASSERT_EQUALS(b.find_next(0), VoiceBits::NONE);
+        b.set(1);
+        b.set(3);
+        TS_ASSERT(b.any());
+        TS_ASSERT(b.test(1));
+        TS_ASSERT(!b.test(2));
+        TS_ASSERT_EQUALS(b.find_next(0), 1);
+        TS_ASSERT_EQUALS(b.find_next(2), 3);
+        TS_ASSERT_EQUALS(b.find_next(4), VoiceBits::NONE);
+        TS_ASSERT_EQUALS(b.find_next_cyclic(2), 3);
+        TS_ASSERT_EQUALS(b.find_next_cyclic(3), 3);
+        b.reset(3);
+        TS_ASSERT_EQUALS(b.find_next_cyclic(2), 1);
+    }
+
+    void test_installs_itself()
+    {
+        Synth s("TestSynth", 2, 1);
+        {
+            FooAssigner a(s);
+            TS_ASSERT_EQUALS(s.assigner(), &a);
+            finalize(s);
+            TS_ASSERT_EQUALS(s.voices()[1].assigner(), &a);
+        }
+        TS_ASSERT_EQUALS(s.assigner(), nullptr);
+    }
+
+    void test_lists()
+    {
+        Synth s("TestSynth", 3, 1);
+        FooAssigner a(s);
+        finalize(s);
+        auto& v = s.voices();
+
+        TS_ASSERT_EQUALS(a.oldest(Voice::State::IDLE), 0);
+        TS_ASSERT_EQUALS(a.next(0), 1);
+        TS_ASSERT_EQUALS(a.next(1), 2);
+
+        v[1].start_note();
+        v[0].start_note();
+        TS_ASSERT_EQUALS(a.oldest(Voice::State::IDLE), 2);
+        TS_ASSERT_EQUALS(a.oldest(Voice::State::SOUNDING), 1);
+        TS_ASSERT_EQUALS(a.next(1), 0);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+
+        v[0].release_note();
+        TS_ASSERT_EQUALS(a.state(0), Voice::State::RELEASING);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[0]);
+
+        v[0].render(1);                 // no lifetime monitors; done.
+        TS_ASSERT_EQUALS(a.state(0), Voice::State::IDLE);
+        TS_ASSERT_EQUALS(a.next(2), 0);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), &v[1]);
+
+        v[1].kill_note();
+        TS_ASSERT_EQUALS(a.state(1), Voice::State::STOPPING);
+        TS_ASSERT_EQUALS(a.choose_voice_to_steal(), nullptr);
+        for (size_t i = 0; i < 1000; i++)
+            v[1].render(1);
+        TS_ASSERT_EQUALS(a.state(1), Voice::State::IDLE);
+    }
+
+    void test_take_idle()
+    {
+        Synth s("TestSynth", 2, 1);
+        FooAssigner a(s);
+        finalize(s);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &s.voices()[0]);
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), &s.voices()[1]);
+        s.voices()[0].start_note();
+        s.voices()[1].start_note();
+        TS_ASSERT_EQUALS(a.assign_idle_voice(), nullptr);
+    }
+
+};
@@ -1,6 +1,7 @@
 #include "link.h"
 
 #include <string>
+#include <memory>
 #include <vector>
 
 #include <cxxtest/TestSuite.h>
@@ -110,6 +111,20 @@ public:
         TS_ASSERT_EQUALS(actual1, expected1);
     }
 
+    void test_copy_outlives_original()
+    {
+        std::unique_ptr<Link> link(new Link{&dest0, &src0, &ctl0.out, 0.5f});
+        Link l2(*link);
+        link.reset();
+
+        load_data();
+        render_action copy = l2.make_copy_action(&dest, &src, &ctl.out);
+        copy(2);
+        std::vector<D> actual1{dest.buf(), dest.buf() + N};
+        std::vector<D> expected1{0.0, 0.5, 42, 42};
+        TS_ASSERT_EQUALS(actual1, expected1);
+    }
+
     void test_assignment()
     {
         Input<double> other_dest;
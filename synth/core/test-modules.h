@@ -107,4 +107,18 @@ public:
         foo.kill_note();
     }
 
+    class NoteModule : public ModuleType<NoteModule> {
+    public:
+        void render(size_t) {}
+        bool note_is_done() const override { return true; }
+    };
+
+    void test_tracks_notes()
+    {
+        FooModule foo;
+        NoteModule note;
+        TS_ASSERT(!foo.tracks_notes());
+        TS_ASSERT(note.tracks_notes());
+    }
+
 };
@@ -161,4 +161,21 @@ public:
         TS_ASSERT_EQUALS(link.scale(), 1);
     }
 
+    void test_disconnect()
+    {
+        Input<D> dest2;
+        auto p = Patch()
+                .connect(dest, src)
+                .connect(dest2, src, 0.5f)
+                .connect(dest, ctl)
+                .disconnect(1)
+                ;
+        auto links = p.links();
+        TS_ASSERT_EQUALS(links.size(), 2);
+        TS_ASSERT_EQUALS(links.at(0).dest(), &dest);
+        TS_ASSERT_EQUALS(links.at(0).src(), &src);
+        TS_ASSERT_EQUALS(links.at(1).dest(), &dest);
+        TS_ASSERT_EQUALS(links.at(1).ctl(), &ctl.out);
+    }
+
 };
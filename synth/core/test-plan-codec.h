@@ -0,0 +1,194 @@
+#include "plan-codec.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "synth/core/controls.h"
+#include "synth/core/modules.h"
+#include "synth/core/resolver.h"
+
+class plan_codec_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    class FooControl : public ControlType<FooControl> {
+    public:
+        void render(size_t) {}
+    };
+
+    class FooModule : public ModuleType<FooModule> {
+    public:
+        FooModule() { ports(in, out); }
+        Input<> in;
+        Output<> out;
+        void render(size_t) {}
+    };
+
+    class BarModule : public ModuleType<BarModule> {
+    public:
+        BarModule() { ports(in, out); }
+        Input<> in;
+        Output<> out;
+        void render(size_t) {}
+    };
+
+    class WideModule : public ModuleType<WideModule> {
+    public:
+        WideModule() { ports(in, out); }
+        Input<double> in;
+        Output<> out;
+        void render(size_t) {}
+    };
+
+    FooControl c0;
+    FooModule m0, m1;
+    Patch patch;
+    Plan plan;
+
+    plan_codec_unit_test()
+    {
+        patch.connect(m1.in, m0.out)
+             .connect(m1.in, m0.out, c0, 0.5f);
+        auto& links = patch.links();
+        plan.t_prep().push_back(ClearStep(0, 0.25f));
+        plan.v_prep().push_back(AliasStep(2, -1));
+        plan.pre_render().push_back(ControlRenderStep(0));
+        plan.pre_render().push_back(ModuleRenderStep(0));
+        plan.v_render().push_back(CopyStep(2, 1, -1, &links[0]));
+        plan.v_render().push_back(AddStep(2, 1, 4, &links[1]));
+        plan.v_render().push_back(ModuleRenderStep(1));
+        plan.hoisted().set(3);
+    }
+
+    template <class T>
+    static std::string rep(const T& seq)
+    {
+        std::ostringstream ss;
+        ss << seq;
+        return ss.str();
+    }
+
+    std::vector<std::uint8_t> encode(std::uint64_t hash = 42)
+    {
+        size_t size = PlanCodec::encode(plan, patch.links(), hash,
+                                        nullptr, 0);
+        std::vector<std::uint8_t> blob(size);
+        TS_ASSERT_EQUALS(PlanCodec::encode(plan, patch.links(), hash,
+                                           blob.data(), blob.size()),
+                         size);
+        return blob;
+    }
+
+    bool decode(const std::vector<std::uint8_t>& blob, Plan& p)
+    {
+        return PlanCodec::decode(blob.data(), blob.size(),
+                                 patch.links(), 42, p);
+    }
+
+    void test_round_trip()
+    {
+        auto blob = encode();
+        TS_TRACE("plan blob size = " + std::to_string(blob.size()));
+        TS_ASSERT_EQUALS(std::string(blob.begin(), blob.begin() + 4),
+                         "MVSP");
+        Plan p;
+        TS_ASSERT(decode(blob, p));
+        TS_ASSERT_EQUALS(rep(p.t_prep()), rep(plan.t_prep()));
+        TS_ASSERT_EQUALS(rep(p.v_prep()), rep(plan.v_prep()));
+        TS_ASSERT_EQUALS(rep(p.pre_render()), rep(plan.pre_render()));
+        TS_ASSERT_EQUALS(rep(p.v_render()), rep(plan.v_render()));
+        TS_ASSERT_EQUALS(rep(p.post_render()), rep(plan.post_render()));
+        TS_ASSERT(p.t_prep()[0] == plan.t_prep()[0]);
+        TS_ASSERT(p.v_render()[1] == plan.v_render()[1]);
+        TS_ASSERT_EQUALS(p.hoisted(), plan.hoisted());
+    }
+
+    void test_short_buffer()
+    {
+        auto blob = encode();
+        std::vector<std::uint8_t> small(blob.size() - 1, 0xEE);
+        PlanCodec::encode(plan, patch.links(), 42,
+                          small.data(), small.size());
+        TS_ASSERT(std::equal(small.begin(), small.end(), blob.begin()));
+    }
+
+    void test_reject()
+    {
+        auto blob = encode();
+        Plan p;
+        p.t_prep().push_back(AliasStep(1, 0));
+
+        // other graph
+        TS_ASSERT(!PlanCodec::decode(blob.data(), blob.size(),
+                                     patch.links(), 43, p));
+        // truncated
+        auto bad = blob;
+        bad.pop_back();
+        TS_ASSERT(!decode(bad, p));
+        // trailing garbage
+        bad = blob;
+        bad.push_back(0);
+        TS_ASSERT(!decode(bad, p));
+        // other version
+        bad = blob;
+        bad[4]++;
+        TS_ASSERT(!decode(bad, p));
+        // bad magic
+        bad = blob;
+        bad[0] = 'X';
+        TS_ASSERT(!decode(bad, p));
+        // link out of range
+        Patch short_patch;
+        short_patch.connect(m1.in, m0.out);
+        TS_ASSERT(!PlanCodec::decode(blob.data(), blob.size(),
+                                     short_patch.links(), 42, p));
+
+        // p is unchanged.
+        TS_ASSERT_EQUALS(rep(p.t_prep()), "[alias(1, 0)]");
+        TS_ASSERT_EQUALS(p.v_render().size(), 0);
+    }
+
+    std::uint64_t hash(const Patch& p, Module& second)
+    {
+        PlanCodec::om_vector outputs;
+        outputs.push_back(&second);
+        Control *controls[] = {&c0};
+        Module *modules[] = {&m0, &second};
+        Resolver res;
+        res.add_controls(controls, controls + 1)
+           .add_modules(modules, modules + 2)
+           .finalize();
+        return PlanCodec::graph_hash(res, outputs, p.links());
+    }
+
+    void test_graph_hash()
+    {
+        Patch p2, p3;
+        p2.connect(m1.in, m0.out);
+        p3.connect(m1.in, m0.out, 0.5f);
+        auto h = hash(patch, m1);
+        TS_ASSERT_EQUALS(hash(patch, m1), h);
+        TS_ASSERT_DIFFERS(hash(p2, m1), h);
+        TS_ASSERT_DIFFERS(hash(p3, m1), hash(p2, m1));
+    }
+
+    // Modules are known by name and port shape, not C++ type.
+    void test_graph_hash_is_portable()
+    {
+        Patch empty;
+        BarModule bar;
+        WideModule wide;
+        auto h = hash(empty, m1);
+        TS_ASSERT_EQUALS(hash(empty, bar), h);
+        TS_ASSERT_DIFFERS(hash(empty, wide), h);
+        bar.name("bar");
+        TS_ASSERT_DIFFERS(hash(empty, bar), h);
+        BarModule bar2;
+        bar2.in.name("in");
+        TS_ASSERT_DIFFERS(hash(empty, bar2), h);
+    }
+
+};
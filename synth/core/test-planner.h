@@ -34,6 +34,15 @@ public:
         Module *m_twin;
     };
 
+    class NoteModule : public ModuleType<NoteModule> {
+    public:
+        NoteModule() { ports(in, out); }
+        Input<> in;
+        Output<> out;
+        void render(size_t) {}
+        void start_note() override {}
+    };
+
     void test_instantiate()
     {
         Planner::tc_vec tc;
@@ -228,4 +237,96 @@ public:
 
     }
 
+    void test_twin_chain()
+    {
+        // The twin's own predecessors are voice modules too.
+        FooModule tm0, vm1, tm1;
+        NoteModule vm0;                 // not hoisted
+        tm1.m_twin = &vm1;
+        Planner::tc_vec tc;
+        Planner::vc_vec vc;
+        Planner::tm_vec tm{&tm0, &tm1};
+        Planner::vm_vec vm{&vm0, &vm1};
+        // Ports:
+        //   0: tm0.in  tm0.out tm1.in  tm1.out
+        //   4: vm0.in  vm0.out vm1.in  vm1.out
+        Planner::om_vec om{&tm1};
+        Planner::link_vec links;
+        links.emplace_back(&vm0.in, &tm0.out, nullptr);
+        links.emplace_back(&vm1.in, &vm0.out, nullptr);
+        Planner planner{tc, tm, vc, vm, links, om};
+        Plan plan = planner.make_plan();
+
+        TS_ASSERT_EQUALS(prep_step_rep(plan.v_prep()),
+                         "[alias(4, 1) alias(6, 5)]");
+        TS_ASSERT_EQUALS(render_rep(plan.pre_render()),
+                         "[mrend(0)]");
+        TS_ASSERT_EQUALS(render_rep(plan.v_render()),
+                         "[mrend(2) mrend(3)]")
+        TS_ASSERT_EQUALS(render_rep(plan.post_render()),
+                         "[mrend(1)]");
+    }
+
+    void test_hoist()
+    {
+        // vm0 and vm2 only depend on tm0, so they are hoisted.
+        // vm1 is driven by vc0 and is tm1's twin.
+        //
+        //    tm0 -> vm0 -> vm2 -> vm1 :: tm1
+        //              \------> vm1 <- vc0
+        FooControl tc0, vc0;
+        FooModule tm0, tm1, vm0, vm1, vm2;
+        tm1.m_twin = &vm1;
+        Planner::tc_vec tc{&tc0};
+        Planner::vc_vec vc{&vc0};
+        Planner::tm_vec tm{&tm0, &tm1};
+        Planner::vm_vec vm{&vm0, &vm1, &vm2};
+        // Ports:
+        //   0: tc0.out tm0.in  tm0.out tm1.in  tm1.out vc0.out
+        //   6: vm0.in  vm0.out vm1.in  vm1.out vm2.in  vm2.out
+        Planner::om_vec om{&tm1};
+        Planner::link_vec links;
+        links.emplace_back(&vm0.in, &tm0.out, nullptr);
+        links.emplace_back(&vm1.in, &vm0.out, &vc0.out);
+        links.emplace_back(&vm1.in, &vm2.out, nullptr);
+        links.emplace_back(&vm2.in, &vm0.out, nullptr);
+        Planner planner{tc, tm, vc, vm, links, om};
+        Plan plan = planner.make_plan();
+
+        TS_ASSERT_EQUALS(plan.hoisted(), 0b101);
+        TS_ASSERT_EQUALS(prep_step_rep(plan.t_prep()),
+                         "[clear(1, 0) clear(3, 0) "
+                         "alias(6, 2) alias(10, 7)]");
+        TS_ASSERT_EQUALS(prep_step_rep(plan.v_prep()),
+                         "[alias(8, -1)]");
+        TS_ASSERT_EQUALS(render_rep(plan.pre_render()),
+                         "[mrend(0) mrend(2) mrend(4)]");
+        TS_ASSERT_EQUALS(render_rep(plan.v_render()),
+                         "[crend(1) copy(8, 7, 5) add(8, 11, -1) mrend(3)]")
+        TS_ASSERT_EQUALS(render_rep(plan.post_render()),
+                         "[mrend(1)]");
+    }
+
+    void test_no_hoist()
+    {
+        // Modules that track notes stay in the voice.
+        //    tm0 -> vm0 -> vm1 :: tm1
+        FooModule tm0, tm1, vm1;
+        NoteModule vm0;
+        tm1.m_twin = &vm1;
+        Planner::tc_vec tc;
+        Planner::vc_vec vc;
+        Planner::tm_vec tm{&tm0, &tm1};
+        Planner::vm_vec vm{&vm0, &vm1};
+        Planner::om_vec om{&tm1};
+        Planner::link_vec links;
+        links.emplace_back(&vm0.in, &tm0.out, nullptr);
+        links.emplace_back(&vm1.in, &vm0.out, nullptr);
+        Planner planner{tc, tm, vc, vm, links, om};
+        Plan plan = planner.make_plan();
+        TS_ASSERT(plan.hoisted().none());
+        TS_ASSERT_EQUALS(render_rep(plan.v_render()),
+                         "[mrend(2) mrend(3)]")
+    }
+
 };
@@ -11,6 +11,7 @@ public:
     class MockPort : public Port {
     public:
         std::type_index data_type() const override { return typeid(void); }
+        size_t data_size() const override { return 0; }
     };
 
     class MockPorted : public Ported {
@@ -0,0 +1,47 @@
+#include "recorder.h"
+
+#include <cxxtest/TestSuite.h>
+
+class recorder_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        float buf[1];
+        (void)Recorder(buf, 1);
+    }
+
+    void test_render()
+    {
+        float buf[2 * MAX_FRAMES] = {};
+        Recorder r(buf, 2 * MAX_FRAMES);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            r.in.buf()[i] = i + 1;
+        r.render(MAX_FRAMES);
+        r.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(r.position(), 2 * MAX_FRAMES);
+        for (size_t i = 0; i < MAX_FRAMES; i++) {
+            TS_ASSERT_EQUALS(buf[i], i + 1);
+            TS_ASSERT_EQUALS(buf[MAX_FRAMES + i], i + 1);
+        }
+    }
+
+    void test_clone_sums()
+    {
+        float buf[MAX_FRAMES] = {};
+        Recorder r(buf, MAX_FRAMES);
+        auto *c = dynamic_cast<Recorder *>(r.clone());
+        TS_ASSERT(c);
+        for (size_t i = 0; i < MAX_FRAMES; i++) {
+            r.in.buf()[i] = 1;
+            c->in.buf()[i] = 2;
+        }
+        r.render(MAX_FRAMES);
+        c->render(MAX_FRAMES);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_EQUALS(buf[i], 3);
+        delete c;
+    }
+
+};
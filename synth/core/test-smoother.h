@@ -0,0 +1,104 @@
+#include "smoother.h"
+
+#include <cxxtest/TestSuite.h>
+
+class smoother_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)Smoother();
+    }
+
+    void test_step()
+    {
+        Smoother s(Smoother::Curve::STEP);
+        s.configure(1000);
+        Output<> out;
+        s.set(0.5);
+        TS_ASSERT(!s.is_settled());
+        s.render(out, MAX_FRAMES);
+        TS_ASSERT(s.is_settled());
+        TS_ASSERT(s.is_constant());
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_EQUALS(out[i], 0.5);
+    }
+
+    void test_linear()
+    {
+        // 0.008 seconds at 1 KHz is 8 frames, i.e., two blocks.
+        Smoother s(Smoother::Curve::LINEAR, 0.008);
+        s.configure(1000);
+        Output<> out;
+        s.set(1);
+        s.render(out, 4);
+        TS_ASSERT_DELTA(out[0], 0.125, 1e-6);
+        TS_ASSERT_DELTA(out[3], 0.5, 1e-6);
+        TS_ASSERT(!s.is_settled());
+        s.render(out, 4);
+        TS_ASSERT_DELTA(out[0], 0.625, 1e-6);
+        TS_ASSERT_EQUALS(out[3], 1);
+        TS_ASSERT(s.is_settled());
+        TS_ASSERT(!s.is_constant());
+        s.render(out, 4);
+        TS_ASSERT(s.is_constant());
+        TS_ASSERT_EQUALS(out[0], 1);
+    }
+
+    void test_one_pole()
+    {
+        Smoother s(Smoother::Curve::ONE_POLE, 0.010);
+        s.configure(1000);
+        Output<> out;
+        s.set(1);
+        float prev = 0;
+        size_t frames = 0;
+        while (!s.is_settled()) {
+            s.render(out, 4);
+            for (size_t i = 0; i < 4; i++) {
+                TS_ASSERT_LESS_THAN(prev, out[i]);
+                prev = out[i];
+            }
+            frames += 4;
+            if (frames == 12)
+                // one time constant: 1 - 1/e
+                TS_ASSERT_DELTA(out[1], 0.632, 0.01);
+        }
+        // -100 dB is 11.5 time constants.
+        TS_ASSERT_DELTA(frames, 116, 4);
+        TS_ASSERT_EQUALS(out[3], 1);
+    }
+
+    // Once the output buffer holds the settled value, render
+    // doesn't touch it.
+    void test_constant()
+    {
+        Smoother s;
+        s.configure(1000);
+        Output<> out;
+        s.jump(0.25);
+        s.render(out, 2);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_EQUALS(out[i], 0.25);
+        out[0] = 99;
+        s.render(out, 2);
+        TS_ASSERT_EQUALS(out[0], 99);
+        s.jump(0.75);
+        s.render(out, 2);
+        TS_ASSERT_EQUALS(out[0], 0.75);
+    }
+
+    // Gliding times shorter than a frame are steps.
+    void test_instant()
+    {
+        Smoother s(Smoother::Curve::ONE_POLE, 0);
+        s.configure(1000);
+        Output<> out;
+        s.set(1);
+        s.render(out, 4);
+        TS_ASSERT_EQUALS(out[0], 1);
+        TS_ASSERT(s.is_constant());
+    }
+
+};
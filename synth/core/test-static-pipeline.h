@@ -0,0 +1,128 @@
+#include "static-pipeline.h"
+
+#include <sstream>
+#include <string>
+
+#include <cxxtest/TestSuite.h>
+
+#include "synth/core/controls.h"
+#include "synth/core/modules.h"
+
+class static_pipeline_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    static std::ostringstream log;
+
+    // out = in + 1
+    class Inc : public ModuleType<Inc> {
+    public:
+        Inc() { ports(in, out); }
+        Input<> in;
+        Output<> out;
+        void render(size_t frame_count)
+        {
+            log << name() << '.' << frame_count << ' ';
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] = in[i] + 1;
+        }
+        void configure(const Config&) override
+        {
+            log << "cfg-" << name() << ' ';
+        }
+    };
+
+    class Level : public ControlType<Level> {
+    public:
+        float level = 0;
+        void render(size_t frame_count)
+        {
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] = level;
+        }
+    };
+
+    void test_chain()
+    {
+        // Declared in reverse; rendered in link order.
+        typedef StaticPipeline<
+            std::tuple<Inc, Inc, Inc>,
+            std::tuple<
+                StaticLink<STATIC_PORT(0, Inc, in), STATIC_PORT(1, Inc, out)>,
+                StaticLink<STATIC_PORT(1, Inc, in), STATIC_PORT(2, Inc, out)>
+            >> pipeline;
+        TS_ASSERT_EQUALS(pipeline::render_order<0>(), 2);
+        TS_ASSERT_EQUALS(pipeline::render_order<1>(), 1);
+        TS_ASSERT_EQUALS(pipeline::render_order<2>(), 0);
+
+        pipeline p;
+        p.unit<0>().name("a");
+        p.unit<1>().name("b");
+        p.unit<2>().name("c");
+        TS_ASSERT_EQUALS(p.unit<0>().in.data(), p.unit<1>().out.buf());
+        TS_ASSERT_EQUALS(p.unit<2>().in.data(), p.unit<2>().in.buf());
+
+        log.str("");
+        p.render(3);
+        TS_ASSERT_EQUALS(log.str(), "c.3 b.3 a.3 ");
+        TS_ASSERT_EQUALS(p.unit<0>().out[0], 3);
+        TS_ASSERT_EQUALS(p.unit<0>().out[2], 3);
+    }
+
+    void test_mix()
+    {
+        // a.in = 2 * b.out + c.out * level; b.in = 10
+        typedef StaticPipeline<
+            std::tuple<Inc, Inc, Inc, Level>,
+            std::tuple<
+                ScaledLink<STATIC_PORT(0, Inc, in), STATIC_PORT(1, Inc, out)>,
+                StaticLink<STATIC_PORT(0, Inc, in),
+                           STATIC_PORT(2, Inc, out),
+                           STATIC_PORT(3, Level, out)>,
+                ScaledLink<STATIC_PORT(1, Inc, in)>
+            >> pipeline;
+        TS_ASSERT_EQUALS(pipeline::render_order<3>(), 0);
+
+        pipeline p;
+        p.link<0>().scale = 2;
+        p.link<2>().scale = 10;
+        p.unit<3>().level = 0.5;
+        TS_ASSERT_EQUALS(p.unit<0>().in.data(), p.unit<0>().in.buf());
+
+        p.render(2);
+        // b.out = 11, c.out = 1
+        TS_ASSERT_EQUALS(p.unit<0>().in[0], 2 * 11 + 1 * 0.5);
+        TS_ASSERT_EQUALS(p.unit<0>().out[1], 2 * 11 + 1 * 0.5 + 1);
+
+        // Scales can change between blocks.
+        p.link<0>().scale = 3;
+        p.render(2);
+        TS_ASSERT_EQUALS(p.unit<0>().in[1], 3 * 11 + 1 * 0.5);
+    }
+
+    void test_copy_units()
+    {
+        Inc a;
+        a.name("a");
+        typedef StaticPipeline<
+            std::tuple<Inc, Inc>,
+            std::tuple<
+                StaticLink<STATIC_PORT(1, Inc, in), STATIC_PORT(0, Inc, out)>
+            >> pipeline;
+        pipeline p(a, a);
+        TS_ASSERT_EQUALS(p.unit<1>().in.data(), p.unit<0>().out.buf());
+        TS_ASSERT_EQUALS(&p.unit<1>().in, p.unit<1>().ports()[0]);
+
+        Config cfg;
+        log.str("");
+        p.configure(cfg);
+        TS_ASSERT_EQUALS(log.str(), "cfg-a cfg-a ");
+        log.str("");
+        p.render(1);
+        TS_ASSERT_EQUALS(log.str(), "a.1 a.1 ");
+        TS_ASSERT_EQUALS(p.unit<1>().out[0], 2);
+    }
+
+};
+
+std::ostringstream static_pipeline_unit_test::log;
@@ -151,4 +151,31 @@ public:
         TS_ASSERT_EQUALS(to_string(RenderStep(add)), "add(9, -10, -11)");
     }
 
+    void test_equality()
+    {
+        TS_ASSERT(PrepStep(ClearStep(1, 0.5)) == PrepStep(ClearStep(1, 0.5)));
+        TS_ASSERT(PrepStep(ClearStep(1, 0.5)) != PrepStep(ClearStep(1, 0)));
+        TS_ASSERT(PrepStep(AliasStep(2, 3)) == PrepStep(AliasStep(2, 3)));
+        TS_ASSERT(PrepStep(AliasStep(2, 3)) != PrepStep(AliasStep(2, -1)));
+        TS_ASSERT(PrepStep(ClearStep(2, 0)) != PrepStep(AliasStep(2, 0)));
+
+        // Copies compare port indices and scale, not Links.
+        auto dest = Input<>();
+        auto link1 = Link(&dest, nullptr, nullptr);
+        auto link2 = Link(&dest, nullptr, nullptr);
+        auto link3 = Link(&dest, nullptr, nullptr, 0.5);
+        RenderStep c1(CopyStep(6, 7, -1, &link1));
+        RenderStep c2(CopyStep(6, 7, -1, &link2));
+        RenderStep c3(CopyStep(6, 7, -1, &link3));
+        RenderStep a1(AddStep(6, 7, -1, &link1));
+        TS_ASSERT(c1 == c2);
+        TS_ASSERT(c1 != c3);
+        TS_ASSERT(c1 != a1);
+        TS_ASSERT(c1 != RenderStep(CopyStep(6, 8, -1, &link1)));
+        TS_ASSERT(RenderStep(ModuleRenderStep(5)) ==
+                  RenderStep(ModuleRenderStep(5)));
+        TS_ASSERT(RenderStep(ModuleRenderStep(5)) !=
+                  RenderStep(ControlRenderStep(5)));
+    }
+
 };
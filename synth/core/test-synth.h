@@ -76,6 +76,15 @@ public:
         Module *m_twin;
     };
 
+    class NoteModule : public ModuleType<NoteModule> {
+    public:
+        NoteModule() { ports(in, out); }
+        Input<> in;
+        Output<> out;
+        void render(size_t) {}
+        void start_note() override {}
+    };
+
     void test_instantiate()
     {
         (void)Synth{"Foo", POLY, TIMB};
@@ -170,6 +179,9 @@ public:
                     "<C cfg-vc0 C> "
                     "<M cfg-vm0 M> "
                 "V> "
+                // each timbre's shared modules
+                "<M cfg-vm0 M> "
+                "<M cfg-vm0 M> "
             "S> ";
         TS_ASSERT_EQUALS(log(), expected);
     }
@@ -272,6 +284,183 @@ public:
         TS_ASSERT_EQUALS(t.attached_voices(), 0b000);
     }
 
+    void test_hoisted_module()
+    {
+        // vm0 only depends on tm0, so the timbre renders it once and
+        // every voice reads it.
+        FooModule tm0, tm1, vm0, vm1;
+        tm0.name("tm0");
+        tm1.name("tm1");
+        vm0.name("vm0");
+        vm1.name("vm1");
+        tm1.m_twin = &vm1;
+        Synth s{"Foo", POLY, TIMB};
+        s.add_timbre_module(tm0)
+         .add_timbre_module(tm1, true)
+         .add_voice_module(vm0)
+         .add_voice_module(vm1)
+         .finalize(cfg);
+        Patch p;
+        p.connect(vm0.in, tm0.out);
+        p.connect(vm1.in, vm0.out);
+        Timbre& t = s.timbres().at(1);
+        s.apply_patch(p, t);
+        TS_ASSERT_EQUALS(t.plan().hoisted(), 0b01);
+
+        log.clear();
+        t.pre_render(2);
+        TS_ASSERT_EQUALS(log(), "tm0.2 vm0.2 ");
+
+        Voice& v = s.voices().at(2);
+        s.attach_voice_to_timbre(t, v);
+        v.start_note();
+        log.clear();
+        v.render(4);
+        TS_ASSERT_EQUALS(log(), "vm1.4 ");
+
+        auto *shared_vm0 = static_cast<FooModule *>(
+            s.m_shared_modules.at(1)[0]);
+        auto *voice_vm1 = static_cast<FooModule *>(v.modules()[1]);
+        TS_ASSERT_EQUALS(voice_vm1->in.data(), shared_vm0->out.buf());
+    }
+
+    void test_shared_modules()
+    {
+        // Only vm0 can be hoisted, so only vm0 is copied per timbre.
+        FooModule tm0, tm1, vm0, vm1;
+        NoteModule vn;
+        tm0.name("tm0");
+        tm1.name("tm1");
+        vm0.name("vm0");
+        vm1.name("vm1");
+        vn.name("vn");
+        tm1.m_twin = &vm1;
+        Synth s{"Foo", POLY, TIMB};
+        s.add_timbre_module(tm0)
+         .add_timbre_module(tm1, true)
+         .add_voice_module(vm0)
+         .add_voice_module(vn)
+         .add_voice_module(vm1)
+         .finalize(cfg);
+        const auto& arch = s.voices().front().modules();
+        TS_ASSERT_EQUALS(s.m_shared_modules.size(), TIMB);
+        for (const auto& shared: s.m_shared_modules) {
+            TS_ASSERT_EQUALS(shared.size(), 3u);
+            TS_ASSERT_DIFFERS(shared[0], arch[0]);
+            TS_ASSERT_EQUALS(shared[1], arch[1]);
+            TS_ASSERT_EQUALS(shared[2], arch[2]);
+        }
+    }
+
+    void test_update_patch()
+    {
+        // vm0 is driven by a voice control and vm1 is twinned, so
+        // nothing is hoisted until vc0 is disconnected.
+        FooControl vc0;
+        FooModule tm0, tm1, vm0, vm1;
+        vc0.sig = "vc0";
+        tm0.name("tm0");
+        tm1.name("tm1");
+        vm0.name("vm0");
+        vm1.name("vm1");
+        tm1.m_twin = &vm1;
+        Synth s{"Foo", POLY, TIMB};
+        s.add_voice_control(vc0)
+         .add_timbre_module(tm0)
+         .add_timbre_module(tm1, true)
+         .add_voice_module(vm0)
+         .add_voice_module(vm1)
+         .finalize(cfg);
+        Patch p;
+        p.connect(vm0.in, vc0)
+         .connect(vm1.in, vm0.out);
+        Timbre& t = s.timbres().front();
+        s.apply_patch(p, t);
+        Voice& v = s.voices().at(1);
+        s.attach_voice_to_timbre(t, v);
+        v.start_note();
+        auto *voice_vm0 = static_cast<FooModule *>(v.modules()[0]);
+        auto *voice_vm1 = static_cast<FooModule *>(v.modules()[1]);
+        TS_ASSERT_EQUALS(voice_vm1->in.data(), voice_vm0->out.buf());
+
+        // Add a link.  Only its steps' actions are made.
+        p.connect(vm1.in, vc0, 0.5f);
+        TS_ASSERT_EQUALS(s.update_patch(p, t), size_t(2));
+        TS_ASSERT_EQUALS(render_step_rep(t.plan().v_render()),
+                         "[crend(0) mrend(2) copy(7, 6, -1) add(7, -1, 4) "
+                         "mrend(3)]");
+        TS_ASSERT_EQUALS(voice_vm1->in.data(), voice_vm1->in.buf());
+        voice_vm0->out[0] = 2;
+        static_cast<FooControl *>(v.controls()[0])->out[0] = 4;
+        log.clear();
+        v.render(1);
+        TS_ASSERT_EQUALS(log(), "vc0.1 vm0.1 vm1.1 ");
+        TS_ASSERT_EQUALS(voice_vm1->in[0], 2 + 0.5 * 4);
+
+        // Rescale it.
+        p.disconnect(2)
+         .connect(vm1.in, vc0, 0.25f);
+        TS_ASSERT_EQUALS(s.update_patch(p, t), size_t(1));
+        v.render(1);
+        TS_ASSERT_EQUALS(voice_vm1->in[0], 2 + 0.25 * 4);
+
+        // Remove it.  vm1.in is aliased again.
+        p.disconnect(2);
+        TS_ASSERT_EQUALS(s.update_patch(p, t), size_t(0));
+        TS_ASSERT_EQUALS(voice_vm1->in.data(), voice_vm0->out.buf());
+
+        // Disconnecting vc0 hoists vm0, so everything is remade.
+        p.disconnect(0);
+        TS_ASSERT_EQUALS(s.update_patch(p, t), size_t(3));
+        TS_ASSERT_EQUALS(t.plan().hoisted(), 0b01);
+        log.clear();
+        t.pre_render(2);
+        v.render(2);
+        TS_ASSERT_EQUALS(log(), "vm0.2 vm1.2 ");
+    }
+
+    void test_saved_plan()
+    {
+        FooModule tm0, tm1, vm0;
+        tm0.name("tm0");
+        tm1.name("tm1");
+        vm0.name("vm0");
+        Synth s{"Foo", POLY, TIMB};
+        s.add_timbre_module(tm0)
+         .add_timbre_module(tm1, true)
+         .add_voice_module(vm0)
+         .finalize(cfg);
+        Patch p;
+        p.connect(vm0.in, tm0.out)
+         .connect(tm1.in, tm0.out, 0.5f);
+        Timbre& t0 = s.timbres().at(0);
+        Timbre& t1 = s.timbres().at(1);
+        s.apply_patch(p, t0);
+        std::uint8_t blob[256];
+        size_t size = s.save_plan(t0, blob, sizeof blob);
+        TS_ASSERT_LESS_THAN_EQUALS(size, sizeof blob);
+
+        TS_ASSERT(s.apply_saved_plan(p, t1, blob, size));
+        TS_ASSERT_EQUALS(t1.current_patch(), &p);
+        TS_ASSERT_EQUALS(render_step_rep(t1.plan().pre_render()),
+                         render_step_rep(t0.plan().pre_render()));
+        TS_ASSERT_EQUALS(render_step_rep(t1.plan().v_render()),
+                         render_step_rep(t0.plan().v_render()));
+        TS_ASSERT_EQUALS(render_step_rep(t1.plan().post_render()),
+                         render_step_rep(t0.plan().post_render()));
+        log.clear();
+        t1.pre_render(2);
+        t1.post_render(2);
+        TS_ASSERT_EQUALS(log(), "tm0.2 tm1.2 ");
+
+        // A changed patch needs a new plan.
+        Patch p2;
+        p2.connect(vm0.in, tm0.out)
+          .connect(tm1.in, tm0.out, 0.25f);
+        TS_ASSERT(!s.apply_saved_plan(p2, t1, blob, size));
+        TS_ASSERT_EQUALS(t1.current_patch(), &p);
+    }
+
     std::string
     prep_step_rep(const Plan::prep_step_sequence& seq)
     {
@@ -5,6 +5,7 @@
 #include <cassert>
 
 #include "synth/core/action.h"
+#include "synth/core/assigners.h"
 #include "synth/core/config.h"
 #include "synth/core/defs.h"
 #include "synth/core/controls.h"
@@ -28,6 +29,8 @@ class Timbre;
 //     configure itself.
 //     start, release, and kill a note.
 //     render a frame chunk.
+//
+// If a Voice has an assigner, it reports every state change to it.
 
 class Voice {
 
@@ -48,13 +51,15 @@ public:
     Voice(bool delete_components = true)
     : m_delete_components{delete_components},
       m_state{State::IDLE},
-      m_timbre{nullptr}
+      m_timbre{nullptr},
+      m_assigner{nullptr}
     {}
 
     Voice(const Voice& that)
     : m_delete_components{true},
       m_state{State::IDLE},
       m_timbre{nullptr},
+      m_assigner{that.m_assigner},
       m_controls{},
       m_modules{},
       m_actions{}
@@ -86,6 +91,9 @@ public:
     Timbre *timbre() const { return m_timbre;}
     void timbre(Timbre *t) { m_timbre = t; }
 
+    Assigner *assigner() const { return m_assigner; }
+    void assigner(Assigner *a) { m_assigner = a; }
+
     const control_vector& controls() const { return m_controls; }
     void add_control(Control *c, bool is_lifetime_monitor = false)
     {
@@ -135,6 +143,7 @@ public:
             c->start_note();
         for (auto *m: m_modules)
             m->start_note();
+        report_state();
     }
 
     void release_note()
@@ -145,6 +154,7 @@ public:
             c->release_note();
         for (auto *m: m_modules)
             m->release_note();
+        report_state();
     }
 
     void kill_note()
@@ -156,6 +166,7 @@ public:
             c->kill_note();
         for (auto *m: m_modules)
             m->kill_note();
+        report_state();
     }
 
     void render(size_t frame_count)
@@ -178,19 +189,29 @@ public:
                     c->idle();
                 for (auto& m: m_modules)
                     m->idle();
+                report_state();
             }
         } else if (m_state == State::STOPPING) {
             m_shutdown_remaining -= frame_count;
-            if (m_shutdown_remaining < 0)
+            if (m_shutdown_remaining < 0) {
                 m_state = State::IDLE;
+                report_state();
+            }
         }
     }
 
 private:
 
+    void report_state()
+    {
+        if (m_assigner)
+            m_assigner->voice_state_changed(*this);
+    }
+
     bool m_delete_components;
     State m_state;
     Timbre *m_timbre;
+    Assigner *m_assigner;
     int m_shutdown_frames;
     int m_shutdown_remaining;
     control_vector m_controls;
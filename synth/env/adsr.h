@@ -0,0 +1,284 @@
+#ifndef ADSR_included
+#define ADSR_included
+
+#include <cassert>
+#include <cmath>
+
+#include "synth/core/config.h"
+#include "synth/core/defs.h"
+#include "synth/core/modules.h"
+#include "synth/core/sizes.h"
+
+
+// -- ADSR - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// ADSR is an exponential envelope generator.  Each segment is an
+// exponential approach toward a target just beyond the segment's end
+// level, so the segment ends in finite time with the familiar analog
+// curve shape.
+//
+// A segment is rendered with the one-multiply recursion
+//
+//     level = base + coef * level
+//
+// and `coef` and `base` are computed once when the segment begins,
+// never per sample.  Segment times are read from the `attack`,
+// `decay`, and `release` inputs (seconds) and the sustain level from
+// `sustain` (0..1) at the sample where the segment begins.
+//
+// ADSR is meant to be a voice's lifetime monitor.  `note_is_done`
+// becomes true on the block where the release (or kill) segment
+// reaches zero, so the voice goes idle as soon as it is silent.
+
+class ADSR : public ModuleType<ADSR> {
+
+public:
+
+    enum class Stage {
+        IDLE,
+        ATTACK,
+        DECAY,
+        SUSTAIN,
+        RELEASE,
+        KILL,
+    };
+
+    ADSR()
+    : m_Fs{0},
+      m_stage{Stage::IDLE},
+      m_stage_is_new{false},
+      m_level{0},
+      m_coef{0},
+      m_base{0},
+      m_target{0},
+      m_sustain{0}
+    {
+        attack.name("attack");
+        decay.name("decay");
+        sustain.name("sustain");
+        release.name("release");
+        out.name("out");
+        ports(attack, decay, sustain, release, out);
+    }
+
+    Input<> attack;
+    Input<> decay;
+    Input<> sustain;
+    Input<> release;
+    Output<> out;
+
+    Stage stage() const { return m_stage; }
+
+    void render(size_t frame_count)
+    {
+        size_t i = 0;
+        while (i < frame_count) {
+            if (m_stage_is_new) {
+                // A zero-length segment may end at once.
+                begin_stage(i);
+                continue;
+            }
+            switch (m_stage) {
+
+            case Stage::IDLE:
+                for ( ; i < frame_count; i++)
+                    out[i] = 0;
+                break;
+
+            case Stage::SUSTAIN:
+                for ( ; i < frame_count; i++)
+                    out[i] = m_sustain;
+                break;
+
+            case Stage::ATTACK:
+                i = render_rising(i, frame_count);
+                break;
+
+            case Stage::DECAY:
+            case Stage::RELEASE:
+            case Stage::KILL:
+                i = render_falling(i, frame_count);
+                break;
+            }
+        }
+    }
+
+    void configure(const Config& cfg) override
+    {
+        m_Fs = cfg.sample_rate();
+    }
+
+    void start_note() override
+    {
+        enter(Stage::ATTACK);
+    }
+
+    void release_note() override
+    {
+        if (m_stage != Stage::IDLE)
+            enter(Stage::RELEASE);
+    }
+
+    void kill_note() override
+    {
+        if (m_stage != Stage::IDLE)
+            enter(Stage::KILL);
+    }
+
+    void idle() override
+    {
+        m_stage = Stage::IDLE;
+        m_stage_is_new = false;
+        m_level = 0;
+    }
+
+    bool note_is_done() const override
+    {
+        return m_stage == Stage::IDLE;
+    }
+
+private:
+
+    // Attack overshoots 1 by this much; the falling segments aim this
+    // far below their end level.  The attack value gives a gently
+    // convex rise; the decay value is -80 dB, a nearly pure
+    // exponential fall.
+    static constexpr float ATTACK_OVERSHOOT = 0.3f;
+    static constexpr float DECAY_OVERSHOOT = 0.0001f;
+
+    void enter(Stage s)
+    {
+        m_stage = s;
+        m_stage_is_new = true;
+    }
+
+    // Compute the segment's coefficients.  Segments of less than one
+    // frame are finished immediately.
+    void begin_stage(size_t i)
+    {
+        m_stage_is_new = false;
+        float seconds = 0;
+        float overshoot = DECAY_OVERSHOOT;
+        switch (m_stage) {
+
+        case Stage::IDLE:
+        case Stage::SUSTAIN:
+            return;
+
+        case Stage::ATTACK:
+            seconds = attack[i];
+            m_target = 1;
+            overshoot = ATTACK_OVERSHOOT;
+            break;
+
+        case Stage::DECAY:
+            m_sustain = sustain[i];
+            if (m_sustain < 0)
+                m_sustain = 0;
+            if (m_sustain > 1)
+                m_sustain = 1;
+            seconds = decay[i];
+            m_target = m_sustain;
+            break;
+
+        case Stage::RELEASE:
+            seconds = release[i];
+            m_target = 0;
+            break;
+
+        case Stage::KILL:
+            seconds = NOTE_SHUTDOWN_TIME;
+            m_target = 0;
+            break;
+        }
+
+        assert(m_Fs);
+        float frames = seconds * m_Fs;
+        float span = std::fabs(m_target - m_level);
+        if (frames < 1 || span == 0) {
+            m_level = m_target;
+            end_stage();
+            return;
+        }
+
+        // Reach the target in `frames` steps:
+        //     (span + overshoot) * coef ** frames == overshoot.
+        m_coef = std::exp(-std::log((span + overshoot) / overshoot) /
+                          frames);
+        float aim = m_target < m_level ? m_target - overshoot
+                                       : m_target + overshoot;
+        m_base = aim * (1 - m_coef);
+    }
+
+    void end_stage()
+    {
+        switch (m_stage) {
+
+        case Stage::ATTACK:
+            enter(Stage::DECAY);
+            break;
+
+        case Stage::DECAY:
+            m_stage = Stage::SUSTAIN;
+            break;
+
+        case Stage::RELEASE:
+        case Stage::KILL:
+            m_stage = Stage::IDLE;
+            break;
+
+        case Stage::IDLE:
+        case Stage::SUSTAIN:
+            assert(false);
+            break;
+        }
+    }
+
+    size_t render_rising(size_t i, size_t frame_count)
+    {
+        float level = m_level;
+        const float coef = m_coef, base = m_base, target = m_target;
+        for ( ; i < frame_count; i++) {
+            level = base + coef * level;
+            if (level >= target) {
+                out[i++] = m_level = target;
+                end_stage();
+                return i;
+            }
+            out[i] = level;
+        }
+        m_level = level;
+        return i;
+    }
+
+    size_t render_falling(size_t i, size_t frame_count)
+    {
+        float level = m_level;
+        const float coef = m_coef, base = m_base, target = m_target;
+        for ( ; i < frame_count; i++) {
+            level = base + coef * level;
+            if (level <= target) {
+                out[i++] = m_level = target;
+                end_stage();
+                return i;
+            }
+            out[i] = level;
+        }
+        m_level = level;
+        return i;
+    }
+
+    float m_Fs;
+    Stage m_stage;
+    bool m_stage_is_new;
+    float m_level;
+    float m_coef;
+    float m_base;
+    float m_target;
+    float m_sustain;
+
+    friend class adsr_unit_test;
+
+};
+
+#endif /* !ADSR_included */
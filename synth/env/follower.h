@@ -0,0 +1,127 @@
+#ifndef FOLLOWER_included
+#define FOLLOWER_included
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/sizes.h"
+#include "synth/core/synth.h"
+
+
+// -- Level Follower - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// LevelFollower measures the level of a voice's output so a voice
+// assigner can steal the quietest note.  Patch its `in` to the signal
+// to measure and its `out`, which passes the signal through, on
+// toward the synth's output.  The planner only renders modules that
+// lead to an output, so an unconnected follower never measures.
+//
+// It tracks the peak, which rises instantly and falls exponentially,
+// and the RMS, smoothed exponentially.  Both are updated once per
+// block: one pass for the block's peak and sum of squares, then one
+// multiply-add each.  The per-block decay factor is recomputed only
+// when the block size changes.
+//
+// LevelFollower does not hold its voice open; `note_is_done` is
+// always true.
+
+class LevelFollower : public ModuleType<LevelFollower> {
+
+public:
+
+    LevelFollower(float time = DEFAULT_TIME)
+    : m_time{time},
+      m_Fs{0},
+      m_block_size{0},
+      m_block_coef{0},
+      m_peak{0},
+      m_mean_square{0}
+    {
+        in.name("in");
+        out.name("out");
+        ports(in, out);
+    }
+
+    Input<> in;
+    Output<> out;
+
+    float peak() const { return m_peak; }
+    float rms() const { return std::sqrt(m_mean_square); }
+
+    float time() const { return m_time; }
+    void time(float t)
+    {
+        m_time = t;
+        m_block_size = 0;
+    }
+
+    void render(size_t frame_count)
+    {
+        assert(m_Fs);
+        if (!frame_count)
+            return;
+        if (frame_count != m_block_size) {
+            m_block_size = frame_count;
+            m_block_coef = std::exp(-float(frame_count) / (m_time * m_Fs));
+        }
+        float peak = 0, sum = 0;
+        for (size_t i = 0; i < frame_count; i++) {
+            float x = in[i];
+            out[i] = x;
+            peak = std::max(peak, std::fabs(x));
+            sum += x * x;
+        }
+        float k = m_block_coef;
+        float mean_square = sum / frame_count;
+        m_peak = std::max(peak, m_peak * k);
+        m_mean_square = mean_square + (m_mean_square - mean_square) * k;
+    }
+
+    void configure(const Config& cfg) override
+    {
+        m_Fs = cfg.sample_rate();
+        m_block_size = 0;
+    }
+
+    void idle() override
+    {
+        m_peak = m_mean_square = 0;
+    }
+
+    bool note_is_done() const override { return true; }
+
+    // A function that returns the RMS level of a voice, read from that
+    // voice's copy of `proto`.  `proto` must have been added to the
+    // synth with `add_voice_module`.
+    static std::function<float(const Voice&)>
+    voice_level(const Synth& synth, const LevelFollower& proto)
+    {
+        const auto& mods = synth.voices().front().modules();
+        size_t index = 0;
+        while (index < mods.size() && mods[index] != &proto)
+            index++;
+        assert(index < mods.size());
+        return [index] (const Voice& v) -> float {
+            auto *f = static_cast<const LevelFollower *>(v.modules()[index]);
+            return f->rms();
+        };
+    }
+
+private:
+
+    static constexpr float DEFAULT_TIME = 0.020;   // seconds
+
+    float m_time;
+    float m_Fs;
+    size_t m_block_size;
+    float m_block_coef;
+    float m_peak;
+    float m_mean_square;
+
+};
+
+#endif /* !FOLLOWER_included */
@@ -0,0 +1,168 @@
+#include "adsr.h"
+
+#include <cxxtest/TestSuite.h>
+
+#include "synth/core/voice.h"
+
+class adsr_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)ADSR();
+    }
+
+    // Set the envelope's inputs as though they were constant controls.
+    static void set_params(ADSR& env,
+                           float a, float d, float s, float r)
+    {
+        env.attack.clear(a);
+        env.decay.clear(d);
+        env.sustain.clear(s);
+        env.release.clear(r);
+    }
+
+    static void configure(ADSR& env, Config::sample_rate_type rate)
+    {
+        Config cfg;
+        cfg.set_sample_rate(rate);
+        env.configure(cfg);
+    }
+
+    // Render whole blocks until the stage changes.  Return the number
+    // of frames rendered.
+    static size_t render_stage(ADSR& env, ADSR::Stage stage)
+    {
+        size_t n = 0;
+        while (env.stage() == stage && n < 1000000) {
+            env.render(MAX_FRAMES);
+            n += MAX_FRAMES;
+        }
+        return n;
+    }
+
+    void test_idle()
+    {
+        ADSR env;
+        configure(env, 1000);
+        set_params(env, 0.1, 0.1, 0.5, 0.1);
+        env.render(MAX_FRAMES);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_EQUALS(env.out[i], 0);
+        TS_ASSERT(env.note_is_done());
+    }
+
+    void test_segments()
+    {
+        ADSR env;
+        configure(env, 1000);
+        set_params(env, 0.100, 0.200, 0.5, 0.300);
+
+        env.start_note();
+        TS_ASSERT(!env.note_is_done());
+        float prev = 0;
+        size_t n = 0;
+        while (env.stage() == ADSR::Stage::ATTACK) {
+            env.render(MAX_FRAMES);
+            for (size_t i = 0; i < MAX_FRAMES; i++) {
+                TS_ASSERT_LESS_THAN_EQUALS(prev, env.out[i]);
+                TS_ASSERT_LESS_THAN_EQUALS(env.out[i], 1);
+                prev = env.out[i];
+            }
+            n += MAX_FRAMES;
+        }
+        TS_ASSERT_DELTA(n, 100, MAX_FRAMES);
+        TS_ASSERT_EQUALS(env.stage(), ADSR::Stage::DECAY);
+
+        n = render_stage(env, ADSR::Stage::DECAY);
+        TS_ASSERT_DELTA(n, 200, MAX_FRAMES);
+        TS_ASSERT_EQUALS(env.stage(), ADSR::Stage::SUSTAIN);
+        env.render(MAX_FRAMES);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_EQUALS(env.out[i], 0.5);
+
+        env.release_note();
+        TS_ASSERT(!env.note_is_done());
+        n = render_stage(env, ADSR::Stage::RELEASE);
+        TS_ASSERT_DELTA(n, 300, MAX_FRAMES);
+        TS_ASSERT(env.note_is_done());
+        TS_ASSERT_EQUALS(env.out[MAX_FRAMES - 1], 0);
+    }
+
+    // A zero-length segment is skipped within the same block.
+    void test_instant_attack()
+    {
+        ADSR env;
+        configure(env, 1000);
+        set_params(env, 0, 0, 0.25, 0);
+        env.start_note();
+        env.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(env.stage(), ADSR::Stage::SUSTAIN);
+        TS_ASSERT_EQUALS(env.out[0], 0.25);
+        env.release_note();
+        env.render(MAX_FRAMES);
+        TS_ASSERT(env.note_is_done());
+        TS_ASSERT_EQUALS(env.out[0], 0);
+    }
+
+    // Releasing mid-attack falls from the current level.
+    void test_early_release()
+    {
+        ADSR env;
+        configure(env, 1000);
+        set_params(env, 0.100, 0.100, 1.0, 0.050);
+        env.start_note();
+        env.render(MAX_FRAMES);
+        float level = env.out[MAX_FRAMES - 1];
+        TS_ASSERT_LESS_THAN(0, level);
+        TS_ASSERT_LESS_THAN(level, 1);
+        env.release_note();
+        env.render(MAX_FRAMES);
+        TS_ASSERT_LESS_THAN(env.out[0], level);
+        size_t n = MAX_FRAMES + render_stage(env, ADSR::Stage::RELEASE);
+        TS_ASSERT_DELTA(n, 50, MAX_FRAMES);
+    }
+
+    void test_kill()
+    {
+        ADSR env;
+        configure(env, 44100);
+        set_params(env, 0, 1.0, 1.0, 10.0);
+        env.start_note();
+        env.render(MAX_FRAMES);
+        env.kill_note();
+        size_t n = render_stage(env, ADSR::Stage::KILL);
+        TS_ASSERT_DELTA(n, 44100 * NOTE_SHUTDOWN_TIME, MAX_FRAMES);
+        TS_ASSERT(env.note_is_done());
+    }
+
+    // As a lifetime monitor, the envelope idles its voice as soon as
+    // the release segment ends.
+    void test_voice_lifetime()
+    {
+        ADSR *env = new ADSR;
+        Voice v;
+        v.add_module(env, true);
+        set_params(*env, 0, 0, 1, 0.010);
+        Config cfg;
+        cfg.set_sample_rate(1000);
+        v.configure(cfg);
+        render_action_sequence actions;
+        actions.push_back(env->make_render_action());
+        v.actions(actions);
+
+        v.start_note();
+        v.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(v.state(), Voice::State::SOUNDING);
+        v.release_note();
+        size_t n = 0;
+        while (v.state() == Voice::State::RELEASING) {
+            v.render(MAX_FRAMES);
+            n += MAX_FRAMES;
+        }
+        TS_ASSERT_EQUALS(v.state(), Voice::State::IDLE);
+        TS_ASSERT_DELTA(n, 10, MAX_FRAMES);
+    }
+
+};
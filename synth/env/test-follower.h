@@ -0,0 +1,133 @@
+#include "follower.h"
+
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+class follower_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)LevelFollower();
+    }
+
+    static void configure(LevelFollower& f)
+    {
+        Config cfg;
+        cfg.set_sample_rate(48000);
+        f.configure(cfg);
+    }
+
+    void test_sine()
+    {
+        LevelFollower f;
+        configure(f);
+        size_t n = 0;
+        for (size_t block = 0; block < 10000; block++) {
+            for (size_t i = 0; i < MAX_FRAMES; i++)
+                f.in.buf()[i] = 0.5f * std::sin(0.1f * n++);
+            f.render(MAX_FRAMES);
+        }
+        TS_ASSERT_DELTA(f.peak(), 0.5, 0.02);
+        TS_ASSERT_DELTA(f.rms(), 0.5 / std::sqrt(2), 0.02);
+    }
+
+    void test_decay()
+    {
+        LevelFollower f(0.010);
+        configure(f);
+        f.in.clear(1);
+        f.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(f.peak(), 1);
+        f.in.clear(0);
+        // One time constant later, down by 1/e.
+        for (size_t i = 0; i < 480 / MAX_FRAMES; i++)
+            f.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(f.peak(), std::exp(-1.0), 0.01);
+        f.idle();
+        TS_ASSERT_EQUALS(f.peak(), 0);
+        TS_ASSERT_EQUALS(f.rms(), 0);
+    }
+
+    void test_voice_level()
+    {
+        LevelFollower proto;
+        Synth s("TestSynth", 2, 1);
+        s.add_voice_module(proto);
+        Config cfg;
+        cfg.set_sample_rate(48000);
+        s.finalize(cfg);
+        auto meter = LevelFollower::voice_level(s, proto);
+        auto *f1 = static_cast<LevelFollower *>(s.voices()[1].modules()[0]);
+        f1->in.clear(1);
+        for (size_t i = 0; i < 10000; i++)
+            f1->render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(meter(s.voices()[0]), 0);
+        TS_ASSERT_DELTA(meter(s.voices()[1]), 1, 1e-3);
+    }
+
+    // Outputs 1 while its note sounds.
+    class Gate : public ModuleType<Gate> {
+    public:
+        Gate() : level{0} { ports(out); }
+        Output<> out;
+        float level;
+        void start_note() override { level = 1; }
+        void idle() override { level = 0; }
+        bool note_is_done() const override { return true; }
+        void render(size_t frame_count)
+        {
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] = level;
+        }
+    };
+
+    class Sink : public ModuleType<Sink> {
+    public:
+        Sink() { ports(in); }
+        Input<> in;
+        float last = -1;
+        void render(size_t frame_count) { last = in[frame_count - 1]; }
+    };
+
+    // Patched through to the output, the follower is planned and
+    // measures its voice's note.
+    void test_in_synth()
+    {
+        Gate gate;
+        LevelFollower follower;
+        Summer<> sum;
+        Sink sink;
+        Synth s("TestSynth", 2, 1);
+        s.add_voice_module(gate)
+         .add_voice_module(follower)
+         .add_summer(sum)
+         .add_timbre_module(sink, true);
+        Config cfg;
+        cfg.set_sample_rate(48000);
+        s.finalize(cfg);
+
+        Patch p;
+        p.connect(follower.in, gate.out)
+         .connect(sum.voice_side.in, follower.out)
+         .connect(sink.in, sum.timbre_side.out);
+        Timbre& t = s.timbres().front();
+        s.apply_patch(p, t);
+        auto meter = LevelFollower::voice_level(s, follower);
+
+        Voice& v = s.voices()[1];
+        s.attach_voice_to_timbre(t, v);
+        v.start_note();
+        for (size_t i = 0; i < 10000; i++) {
+            t.pre_render(MAX_FRAMES);
+            v.render(MAX_FRAMES);
+            t.post_render(MAX_FRAMES);
+        }
+        TS_ASSERT_EQUALS(meter(s.voices()[0]), 0);
+        TS_ASSERT_DELTA(meter(v), 1, 1e-3);
+        TS_ASSERT_EQUALS(sink.last, 1);
+    }
+
+};
@@ -0,0 +1,60 @@
+// Filter throughput benchmark.
+//
+// Renders noise through each filter, once with the cutoff held
+// constant and once with the cutoff changing every block, and
+// reports megasamples per second.  Build with BUILD=release for
+// meaningful numbers.
+
+#define MAX_FRAMES 64
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "synth/filt/ladder.h"
+#include "synth/filt/svf.h"
+
+static const size_t BLOCK_COUNT = 200000;
+static const Config::sample_rate_type SAMPLE_RATE = 48000;
+
+template <class F>
+static void bench(const char *name, Output<> F::*out, bool sweep)
+{
+    F f;
+    Config cfg;
+    cfg.set_sample_rate(SAMPLE_RATE);
+    f.configure(cfg);
+    f.resonance.clear(0.5);
+    f.cutoff.clear(1000);
+    for (size_t i = 0; i < MAX_FRAMES; i++)
+        f.in.buf()[i] = float(std::rand()) / RAND_MAX - 0.5f;
+
+    // Sum the output so the optimizer can't discard the work.
+    float sum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < BLOCK_COUNT; b++) {
+        if (sweep)
+            f.cutoff.clear(500 + (b & 1023));
+        f.render(MAX_FRAMES);
+        sum += (f.*out)[MAX_FRAMES - 1];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> dt = t1 - t0;
+    double msps = BLOCK_COUNT * MAX_FRAMES / dt.count() / 1e6;
+    std::cout << name << (sweep ? " swept:    " : " constant: ")
+              << msps << " Msamples/sec, "
+              << msps * 1e6 / SAMPLE_RATE << " voices at "
+              << SAMPLE_RATE << " Hz"
+              << (sum == 0 ? " (silent?)" : "")
+              << std::endl;
+}
+
+int main()
+{
+    bench<SVF>("SVF   ", &SVF::low, false);
+    bench<SVF>("SVF   ", &SVF::low, true);
+    bench<Ladder>("Ladder", &Ladder::out, false);
+    bench<Ladder>("Ladder", &Ladder::out, true);
+    return 0;
+}
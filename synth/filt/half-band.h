@@ -0,0 +1,253 @@
+#ifndef HALF_BAND_included
+#define HALF_BAND_included
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+
+// -- Half-Band Filters -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// A half-band lowpass FIR has its cutoff at a quarter of the sample
+// rate, and every other tap is zero except the center tap, which is
+// 1/2.  That makes it the cheapest filter for changing the sample
+// rate by a factor of two.
+//
+// Split into polyphase form, the interpolator's even outputs are a
+// K-tap symmetric FIR of the input, and its odd outputs are just the
+// input, delayed.  The decimator is the mirror image.  So each output
+// frame costs K multiplies (the taps are folded in pairs).
+//
+// The inner loops run over contiguous, preallocated history buffers
+// so the compiler can vectorize them.
+//
+// `Upsampler<Factor, MaxIn>` and `Downsampler<Factor, MaxOut>` chain
+// log2(Factor) half-band stages.  Factor may be 1, 2, or 4, or any
+// other power of two.
+
+
+// HalfBandKernel<K> holds the nonzero taps of a 4K-1 tap half-band
+// filter, Blackman windowed.  Since the taps are symmetric, only the
+// first K are stored.  They are scaled for an interpolator: each
+// polyphase branch has unity gain at DC.
+template <size_t K>
+class HalfBandKernel {
+
+public:
+
+    static const HalfBandKernel& get()
+    {
+        static const HalfBandKernel kernel;
+        return kernel;
+    }
+
+    float operator [] (size_t j) const
+    {
+        assert(j < K);
+        return m_taps[j];
+    }
+
+private:
+
+    HalfBandKernel()
+    {
+        const double pi = 3.14159265358979323846;
+        const double span = 4 * K - 2;
+        double sum = 0;
+        double taps[K];
+        for (size_t j = 0; j < K; j++) {
+            double i = 2 * j;                   // index in full filter
+            double n = i - (2 * K - 1);         // distance from center
+            double sinc = std::sin(pi * n / 2) / (pi * n);
+            double w = 0.42
+                     - 0.50 * std::cos(2 * pi * i / span)
+                     + 0.08 * std::cos(4 * pi * i / span);
+            taps[j] = sinc * w;
+            sum += 2 * taps[j];
+        }
+        for (size_t j = 0; j < K; j++)
+            m_taps[j] = taps[j] / sum;
+    }
+
+    float m_taps[K];
+
+};
+
+
+// HalfBandUp doubles the sample rate.
+template <size_t MaxIn, size_t K = 8>
+class HalfBandUp {
+
+    static const size_t HIST = 2 * K - 1;
+
+public:
+
+    HalfBandUp()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& x: m_hist)
+            x = 0;
+    }
+
+    // Write 2 * count frames to `out`.
+    void process(const float *in, size_t count, float *out)
+    {
+        assert(count <= MaxIn);
+        const HalfBandKernel<K>& c = HalfBandKernel<K>::get();
+        std::memcpy(m_hist + HIST, in, count * sizeof *in);
+        for (size_t m = 0; m < count; m++) {
+            const float *x = m_hist + m;
+            float sum = 0;
+            for (size_t j = 0; j < K; j++)
+                sum += c[j] * (x[j] + x[HIST - j]);
+            out[2 * m] = sum;
+            out[2 * m + 1] = x[K];
+        }
+        std::memmove(m_hist, m_hist + count, HIST * sizeof *m_hist);
+    }
+
+private:
+
+    float m_hist[HIST + MaxIn];
+
+};
+
+
+// HalfBandDown halves the sample rate.
+template <size_t MaxOut, size_t K = 8>
+class HalfBandDown {
+
+    static const size_t HIST = 4 * K - 2;
+
+public:
+
+    HalfBandDown()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& x: m_hist)
+            x = 0;
+    }
+
+    // Read 2 * count frames from `in`.
+    void process(const float *in, size_t count, float *out)
+    {
+        assert(count <= MaxOut);
+        const HalfBandKernel<K>& c = HalfBandKernel<K>::get();
+        std::memcpy(m_hist + HIST, in, 2 * count * sizeof *in);
+        for (size_t m = 0; m < count; m++) {
+            const float *v = m_hist + 2 * m;
+            float sum = 0;
+            for (size_t j = 0; j < K; j++)
+                sum += c[j] * (v[2 * j] + v[HIST - 2 * j]);
+            out[m] = 0.5f * (sum + v[2 * K - 1]);
+        }
+        std::memmove(m_hist, m_hist + 2 * count, HIST * sizeof *m_hist);
+    }
+
+private:
+
+    float m_hist[HIST + 2 * MaxOut];
+
+};
+
+
+template <size_t Factor, size_t MaxIn>
+class Upsampler {
+
+    static_assert(Factor && !(Factor & (Factor - 1)),
+                  "Factor must be a power of two");
+
+public:
+
+    void reset()
+    {
+        m_first.reset();
+        m_rest.reset();
+    }
+
+    // Write Factor * count frames to `out`.
+    void process(const float *in, size_t count, float *out)
+    {
+        if (Factor == 2)
+            return m_first.process(in, count, out);
+        m_first.process(in, count, m_tmp);
+        m_rest.process(m_tmp, 2 * count, out);
+    }
+
+private:
+
+    HalfBandUp<MaxIn> m_first;
+    Upsampler<Factor / 2, 2 * MaxIn> m_rest;
+    float m_tmp[2 * MaxIn];
+
+};
+
+template <size_t MaxIn>
+class Upsampler<1, MaxIn> {
+
+public:
+
+    void reset() {}
+
+    void process(const float *in, size_t count, float *out)
+    {
+        std::memcpy(out, in, count * sizeof *in);
+    }
+
+};
+
+
+template <size_t Factor, size_t MaxOut>
+class Downsampler {
+
+    static_assert(Factor && !(Factor & (Factor - 1)),
+                  "Factor must be a power of two");
+
+public:
+
+    void reset()
+    {
+        m_first.reset();
+        m_rest.reset();
+    }
+
+    // Read Factor * count frames from `in`.
+    void process(const float *in, size_t count, float *out)
+    {
+        if (Factor == 2)
+            return m_rest.process(in, count, out);
+        m_first.process(in, 2 * count, m_tmp);
+        m_rest.process(m_tmp, count, out);
+    }
+
+private:
+
+    Downsampler<Factor / 2, 2 * MaxOut> m_first;
+    HalfBandDown<MaxOut> m_rest;
+    float m_tmp[2 * MaxOut];
+
+};
+
+template <size_t MaxOut>
+class Downsampler<1, MaxOut> {
+
+public:
+
+    void reset() {}
+
+    void process(const float *in, size_t count, float *out)
+    {
+        std::memcpy(out, in, count * sizeof *in);
+    }
+
+};
+
+#endif /* !HALF_BAND_included */
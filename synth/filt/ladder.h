@@ -0,0 +1,164 @@
+#ifndef LADDER_included
+#define LADDER_included
+
+#include <cassert>
+#include <cmath>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/sizes.h"
+#include "synth/util/denormal.h"
+
+
+// -- Ladder - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// Ladder is a four-pole (24 dB/octave) lowpass filter in the style of
+// the Moog transistor ladder.  It is built from four trapezoidal
+// one-pole stages with the feedback loop solved directly (zero-delay
+// feedback).  It is linear; there is no saturation.
+//
+// `cutoff` is in Hz.  `resonance` runs from 0 to 1; the filter
+// self-oscillates at 1.
+//
+// Like SVF, Ladder computes coefficients once per block, from the
+// inputs' last frame, and ramps linearly from the previous block's
+// values.  When cutoff and resonance have not changed, the ramp is
+// skipped.
+
+class Ladder : public ModuleType<Ladder> {
+
+public:
+
+    Ladder()
+    : m_Fs{0},
+      m_cutoff{-1},
+      m_resonance{-1},
+      m_coef(),
+      m_s{0, 0, 0, 0}
+    {
+        in.name("in");
+        cutoff.name("cutoff");
+        resonance.name("resonance");
+        out.name("out");
+        ports(in, cutoff, resonance, out);
+    }
+
+    Input<> in;
+    Input<> cutoff;
+    Input<> resonance;
+    Output<> out;
+
+    void render(size_t frame_count)
+    {
+        assert(m_Fs);
+        if (!frame_count)
+            return;
+        float fc = cutoff[frame_count - 1];
+        float res = resonance[frame_count - 1];
+        if (fc == m_cutoff && res == m_resonance) {
+            render_constant(frame_count);
+        } else {
+            coefficients next = calc_coefficients(fc, res);
+            if (m_cutoff < 0)
+                m_coef = next;
+            render_ramp(frame_count, next);
+            m_coef = next;
+            m_cutoff = fc;
+            m_resonance = res;
+        }
+        for (auto& s: m_s)
+            flush_denormal(s);
+    }
+
+    void configure(const Config& cfg) override
+    {
+        m_Fs = cfg.sample_rate();
+        m_cutoff = m_resonance = -1;
+    }
+
+    void idle() override
+    {
+        for (auto& s: m_s)
+            s = 0;
+    }
+
+private:
+
+    // G is one stage's instantaneous gain, g / (1 + g).  k is the
+    // feedback gain, and norm solves the feedback loop,
+    // 1 / (1 + k * G**4).
+    struct coefficients {
+        float G, k, norm;
+    };
+
+    coefficients calc_coefficients(float fc, float res) const
+    {
+        float max_fc = 0.49f * m_Fs;
+        if (fc < 1)
+            fc = 1;
+        if (fc > max_fc)
+            fc = max_fc;
+        if (res < 0)
+            res = 0;
+        if (res > 1)
+            res = 1;
+        coefficients c;
+        float g = std::tan(3.14159265f * fc / m_Fs);
+        c.G = g / (1 + g);
+        c.k = 4 * res;
+        float G2 = c.G * c.G;
+        c.norm = 1 / (1 + c.k * G2 * G2);
+        return c;
+    }
+
+    // One sample through the ladder.  Each stage's output is
+    //     y = G * x + (1 - G) * s,
+    // so the last stage's output is G**4 * u plus a weighted sum of
+    // the states, where u = x - k * y4.  Solve for y4, then run the
+    // stages.
+    float tick(float x, float G, float k, float norm)
+    {
+        float b = 1 - G;
+        float sigma = b * (((m_s[0] * G + m_s[1]) * G + m_s[2]) * G + m_s[3]);
+        float G2 = G * G;
+        float y4 = (G2 * G2 * x + sigma) * norm;
+        float u = x - k * y4;
+        for (auto& s: m_s) {
+            float v = (u - s) * G;
+            u = v + s;
+            s = u + v;
+        }
+        return u;
+    }
+
+    void render_constant(size_t frame_count)
+    {
+        const float G = m_coef.G, k = m_coef.k, norm = m_coef.norm;
+        for (size_t i = 0; i < frame_count; i++)
+            out[i] = tick(in[i], G, k, norm);
+    }
+
+    void render_ramp(size_t frame_count, const coefficients& next)
+    {
+        float inv_n = 1.0f / frame_count;
+        float G = m_coef.G, k = m_coef.k, norm = m_coef.norm;
+        const float dG = (next.G - G) * inv_n;
+        const float dk = (next.k - k) * inv_n;
+        const float dnorm = (next.norm - norm) * inv_n;
+        for (size_t i = 0; i < frame_count; i++) {
+            G += dG;
+            k += dk;
+            norm += dnorm;
+            out[i] = tick(in[i], G, k, norm);
+        }
+    }
+
+    float m_Fs;
+    float m_cutoff;
+    float m_resonance;
+    coefficients m_coef;
+    float m_s[4];
+
+};
+
+#endif /* !LADDER_included */
@@ -0,0 +1,146 @@
+#ifndef OVERSAMPLED_included
+#define OVERSAMPLED_included
+
+#include <cassert>
+#include <cstring>
+#include <typeinfo>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/sizes.h"
+#include "synth/filt/half-band.h"
+
+
+// -- Oversampled  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// `Oversampled<M, Factor>` runs module M at Factor times the sample
+// rate.  Use it for modules that alias, e.g., waveshapers and FM
+// operators.  Only the wrapped module pays for the higher rate.
+//
+// Oversampled has a port for each of M's ports, in the same order and
+// with the same names.  Find the one that corresponds to M's port with
+// `port`:
+//
+//     Oversampled<Fuzz, 4> fuzz;
+//     Input<>& drive = fuzz.port(&Fuzz::drive);
+//
+// Each block, Oversampled upsamples every input with half-band
+// interpolators, renders M Factor times on successive slices of the
+// upsampled data (M's inputs are aliased to the slices), then filters
+// and decimates M's outputs.  All buffers are members, so nothing is
+// allocated after construction.
+//
+// M's ports must all carry DEFAULT_SAMPLE_TYPE.  M is configured with
+// Factor times the sample rate.
+
+template <class M, size_t Factor>
+class Oversampled : public ModuleType<Oversampled<M, Factor>> {
+
+    typedef DEFAULT_SAMPLE_TYPE sample_type;
+    static const size_t MAX_OS_FRAMES = Factor * MAX_FRAMES;
+
+public:
+
+    typedef M module_type;
+    static const size_t factor = Factor;
+
+    Oversampled()
+    : m_input_count{0},
+      m_output_count{0}
+    {
+        for (auto *p: m_inner.ports()) {
+            assert(p->data_type() == typeid(sample_type));
+            if (dynamic_cast<InputPort *>(p)) {
+                auto& mine = m_inputs[m_input_count++];
+                mine.name(p->name());
+                this->ports(mine);
+            } else {
+                auto& mine = m_outputs[m_output_count++];
+                mine.name(p->name());
+                this->ports(mine);
+            }
+        }
+        this->name(m_inner.name());
+    }
+
+    Oversampled(const Oversampled&) = default;
+
+    M& inner() { return m_inner; }
+    const M& inner() const { return m_inner; }
+
+    // Map a pointer to one of M's ports to the corresponding port here.
+    template <class P>
+    P& port(P M::*member)
+    {
+        const Port *target = &(m_inner.*member);
+        const auto& inner_ports = m_inner.ports();
+        size_t i = 0;
+        while (i < inner_ports.size() && inner_ports[i] != target)
+            i++;
+        assert(i < inner_ports.size() && "not a port");
+        return *static_cast<P *>(this->ports()[i]);
+    }
+
+    void render(size_t frame_count)
+    {
+        assert(frame_count <= MAX_FRAMES);
+        const auto& inner_ports = m_inner.ports();
+
+        for (size_t i = 0; i < m_input_count; i++)
+            m_up[i].process(m_inputs[i].data(), frame_count, m_in_buf[i]);
+
+        for (size_t k = 0; k < Factor; k++) {
+            size_t offset = k * frame_count;
+            size_t ii = 0;
+            for (auto *p: inner_ports)
+                if (auto *ip = dynamic_cast<InputPort *>(p))
+                    ip->alias(m_in_buf[ii++] + offset);
+            m_inner.render(frame_count);
+            size_t oi = 0;
+            for (auto *p: inner_ports)
+                if (auto *op = dynamic_cast<Output<sample_type> *>(p))
+                    std::memcpy(m_out_buf[oi++] + offset,
+                                op->buf(),
+                                frame_count * sizeof (sample_type));
+        }
+
+        for (size_t i = 0; i < m_output_count; i++)
+            m_down[i].process(m_out_buf[i], frame_count, &m_outputs[i][0]);
+    }
+
+    void configure(const Config& cfg) override
+    {
+        Config inner_cfg(cfg);
+        inner_cfg.set_sample_rate(cfg.sample_rate() * Factor);
+        m_inner.configure(inner_cfg);
+    }
+
+    void start_note() override { m_inner.start_note(); }
+    void release_note() override { m_inner.release_note(); }
+    void kill_note() override { m_inner.kill_note(); }
+    bool note_is_done() const override { return m_inner.note_is_done(); }
+
+    void idle() override
+    {
+        m_inner.idle();
+        for (size_t i = 0; i < m_input_count; i++)
+            m_up[i].reset();
+        for (size_t i = 0; i < m_output_count; i++)
+            m_down[i].reset();
+    }
+
+private:
+
+    M m_inner;
+    size_t m_input_count;
+    size_t m_output_count;
+    Input<sample_type> m_inputs[MODULE_MAX_PORTS];
+    Output<sample_type> m_outputs[MODULE_MAX_PORTS];
+    Upsampler<Factor, MAX_FRAMES> m_up[MODULE_MAX_PORTS];
+    Downsampler<Factor, MAX_FRAMES> m_down[MODULE_MAX_PORTS];
+    sample_type m_in_buf[MODULE_MAX_PORTS][MAX_OS_FRAMES];
+    sample_type m_out_buf[MODULE_MAX_PORTS][MAX_OS_FRAMES];
+
+};
+
+#endif /* !OVERSAMPLED_included */
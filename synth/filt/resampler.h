@@ -0,0 +1,283 @@
+#ifndef RESAMPLER_included
+#define RESAMPLER_included
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/sizes.h"
+
+
+// -- Resampler  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// A Resampler converts a stream from one sample rate to another.  The
+// ratio may be anything up to MAX_RATIO either way, e.g., 44100 to
+// 48000.
+//
+// It is a polyphase FIR.  The windowed sinc is precomputed at
+// `Phases` fractional offsets, and each output frame is two `Taps`
+// long inner products (the two phases that bracket the output's
+// offset) blended linearly.  The inner products run over a contiguous
+// history buffer, so the compiler can vectorize them.
+//
+// The rates are integers, so the read position is tracked exactly as
+// an integer plus a fraction with the output rate as denominator.
+// There is no drift however long it runs.
+//
+// The stopband starts at the lower rate's Nyquist frequency, so
+// nothing aliases.  When downsampling by a large ratio, the fixed
+// kernel length means the passband ends well below Nyquist.
+//
+// `process` consumes all its input and returns the number of frames
+// written, at most `max_output(count)`.  The delay is Taps / 2 input
+// frames.  When the rates are equal, `process` copies.
+
+template <size_t MaxIn, size_t Taps = 64, size_t Phases = 128>
+class Resampler {
+
+    static_assert(Taps % 2 == 0, "Taps must be even");
+
+public:
+
+    typedef Config::sample_rate_type rate_type;
+
+    static const size_t MAX_RATIO = 8;
+    static const size_t MAX_OUT = MAX_RATIO * MaxIn + 2;
+
+    Resampler()
+    : m_step_whole{1},
+      m_step_frac{0},
+      m_denom{1},
+      m_pos{0},
+      m_pos_frac{0},
+      m_fill{0},
+      m_is_bypass{true}
+    {
+        reset();
+    }
+
+    bool is_bypass() const { return m_is_bypass; }
+
+    static size_t max_output(size_t count)
+    {
+        return MAX_RATIO * count + 2;
+    }
+
+    void configure(rate_type in_rate, rate_type out_rate)
+    {
+        assert(in_rate && out_rate);
+        assert(out_rate <= MAX_RATIO * in_rate);
+        assert(in_rate <= MAX_RATIO * out_rate);
+        rate_type g = gcd(in_rate, out_rate);
+        rate_type num = in_rate / g;
+        m_denom = out_rate / g;
+        m_step_whole = num / m_denom;
+        m_step_frac = num % m_denom;
+        m_is_bypass = in_rate == out_rate;
+        if (!m_is_bypass)
+            make_bank(double(out_rate) / in_rate);
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& x: m_hist)
+            x = 0;
+        m_fill = Taps - 1;
+        m_pos = 0;
+        m_pos_frac = 0;
+    }
+
+    size_t process(const float *in, size_t count, float *out)
+    {
+        assert(count <= MaxIn);
+        if (m_is_bypass) {
+            std::memcpy(out, in, count * sizeof *in);
+            return count;
+        }
+        std::memcpy(m_hist + m_fill, in, count * sizeof *in);
+        m_fill += count;
+        const double phase_scale = double(Phases) / m_denom;
+        size_t n = 0;
+        while (m_pos + Taps <= m_fill) {
+            double ph = m_pos_frac * phase_scale;
+            size_t p = size_t(ph);
+            float mu = float(ph - p);
+            const float *x = m_hist + m_pos;
+            const float *h0 = m_bank[p];
+            const float *h1 = m_bank[p + 1];
+            float a = 0, b = 0;
+            for (size_t j = 0; j < Taps; j++) {
+                a += h0[j] * x[j];
+                b += h1[j] * x[j];
+            }
+            out[n++] = a + mu * (b - a);
+            m_pos += m_step_whole;
+            m_pos_frac += m_step_frac;
+            if (m_pos_frac >= m_denom) {
+                m_pos_frac -= m_denom;
+                m_pos++;
+            }
+        }
+        size_t shift = m_pos < m_fill ? m_pos : m_fill;
+        std::memmove(m_hist,
+                     m_hist + shift,
+                     (m_fill - shift) * sizeof *m_hist);
+        m_fill -= shift;
+        m_pos -= shift;
+        return n;
+    }
+
+private:
+
+    static rate_type gcd(rate_type a, rate_type b)
+    {
+        while (b) {
+            rate_type t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // Phase p is the kernel for an output frame p / Phases of the way
+    // from input frame Taps / 2 - 1 to Taps / 2.  Each phase is
+    // normalized for unity gain at DC.  A Blackman window's transition
+    // band is about 5.5 / Taps wide, so the cutoff is set half that
+    // below Nyquist.  A kernel too short for the ratio would put the
+    // cutoff at or below zero, so it is kept at least half Nyquist,
+    // and the top of the transition band aliases.
+    void make_bank(double ratio)
+    {
+        const double pi = 3.14159265358979323846;
+        const double nyquist = 0.5 * (ratio < 1 ? ratio : 1);
+        const double fc = std::max(nyquist - 2.75 / Taps, nyquist / 2);
+        const double half = Taps / 2;
+        for (size_t p = 0; p <= Phases; p++) {
+            double frac = double(p) / Phases;
+            double sum = 0;
+            double taps[Taps];
+            for (size_t j = 0; j < Taps; j++) {
+                double d = j - (half - 1) - frac;
+                double sinc = d ? std::sin(2 * pi * fc * d) / (pi * d)
+                                : 2 * fc;
+                double u = (d + half) / (2 * half);     // 0 .. 1
+                double w = 0.42
+                         - 0.50 * std::cos(2 * pi * u)
+                         + 0.08 * std::cos(4 * pi * u);
+                taps[j] = sinc * w;
+                sum += taps[j];
+            }
+            for (size_t j = 0; j < Taps; j++)
+                m_bank[p][j] = taps[j] / sum;
+        }
+    }
+
+    float m_bank[Phases + 1][Taps];
+    float m_hist[Taps + MaxIn];
+    size_t m_step_whole;
+    rate_type m_step_frac;
+    rate_type m_denom;
+    size_t m_pos;
+    rate_type m_pos_frac;
+    size_t m_fill;
+    bool m_is_bypass;
+
+};
+
+
+// -- ResampleStage - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// ResampleStage<Sink> is an output module that lets the synth render
+// at its own rate.  It resamples its input to `output_rate` and
+// passes the result to a Sink module (e.g., an audio device or file
+// writer) in blocks of up to MAX_FRAMES.  Sink's first input port is
+// aliased to the resampled data.
+//
+// The stage is configured with the synth's rate; the Sink is
+// configured with the output rate.  If output_rate is never set, the
+// rates are equal and the stage passes the signal through.
+
+template <class Sink>
+class ResampleStage : public ModuleType<ResampleStage<Sink>> {
+
+    typedef Resampler<MAX_FRAMES> resampler_type;
+
+public:
+
+    typedef Config::sample_rate_type rate_type;
+
+    ResampleStage()
+    : m_output_rate{0},
+      m_sink_in{nullptr}
+    {
+        in.name("in");
+        this->ports(in);
+        find_sink_input();
+    }
+
+    ResampleStage(const ResampleStage& that)
+    : ModuleType<ResampleStage<Sink>>(that),
+      in(that.in),
+      m_sink(that.m_sink),
+      m_resampler(that.m_resampler),
+      m_output_rate{that.m_output_rate},
+      m_sink_in{nullptr}
+    {
+        find_sink_input();
+    }
+
+    Input<> in;
+
+    Sink& sink() { return m_sink; }
+    rate_type output_rate() const { return m_output_rate; }
+
+    ResampleStage& output_rate(rate_type rate)
+    {
+        m_output_rate = rate;
+        return *this;
+    }
+
+    void render(size_t frame_count)
+    {
+        size_t n = m_resampler.process(in.data(), frame_count, m_buf);
+        for (size_t i = 0; i < n; i += MAX_FRAMES) {
+            size_t chunk = n - i < MAX_FRAMES ? n - i : MAX_FRAMES;
+            m_sink_in->alias(m_buf + i);
+            m_sink.render(chunk);
+        }
+    }
+
+    void configure(const Config& cfg) override
+    {
+        rate_type in_rate = cfg.sample_rate();
+        rate_type out_rate = m_output_rate ? m_output_rate : in_rate;
+        m_resampler.configure(in_rate, out_rate);
+        Config sink_cfg(cfg);
+        sink_cfg.set_sample_rate(out_rate);
+        m_sink.configure(sink_cfg);
+    }
+
+private:
+
+    void find_sink_input()
+    {
+        for (auto *p: m_sink.ports())
+            if (!m_sink_in)
+                m_sink_in = dynamic_cast<InputPort *>(p);
+        assert(m_sink_in);
+    }
+
+    Sink m_sink;
+    resampler_type m_resampler;
+    rate_type m_output_rate;
+    InputPort *m_sink_in;
+    float m_buf[resampler_type::MAX_OUT];
+
+};
+
+#endif /* !RESAMPLER_included */
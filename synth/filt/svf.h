@@ -0,0 +1,173 @@
+#ifndef SVF_included
+#define SVF_included
+
+#include <cassert>
+#include <cmath>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/sizes.h"
+#include "synth/util/denormal.h"
+
+
+// -- SVF -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// SVF is a two-pole state-variable filter.  It is the trapezoidal
+// (zero-delay feedback) form, so it stays stable and in tune all the
+// way up to Nyquist.  It has simultaneous lowpass, bandpass, and
+// highpass outputs.
+//
+// `cutoff` is in Hz.  `resonance` runs from 0 (Q = 0.5) toward 1
+// (self-oscillation).
+//
+// The coefficients need a `tan()`, which is too expensive to compute
+// every sample.  SVF computes them once per block, from the inputs'
+// last frame, and ramps linearly from the previous block's values.
+// When cutoff and resonance have not changed, the ramp is skipped.
+
+class SVF : public ModuleType<SVF> {
+
+public:
+
+    SVF()
+    : m_Fs{0},
+      m_cutoff{-1},
+      m_resonance{-1},
+      m_coef(),
+      m_ic1eq{0},
+      m_ic2eq{0}
+    {
+        in.name("in");
+        cutoff.name("cutoff");
+        resonance.name("resonance");
+        low.name("low");
+        band.name("band");
+        high.name("high");
+        ports(in, cutoff, resonance, low, band, high);
+    }
+
+    Input<> in;
+    Input<> cutoff;
+    Input<> resonance;
+    Output<> low;
+    Output<> band;
+    Output<> high;
+
+    void render(size_t frame_count)
+    {
+        assert(m_Fs);
+        if (!frame_count)
+            return;
+        float fc = cutoff[frame_count - 1];
+        float res = resonance[frame_count - 1];
+        if (fc == m_cutoff && res == m_resonance) {
+            render_constant(frame_count);
+        } else {
+            coefficients next = calc_coefficients(fc, res);
+            if (m_cutoff < 0)
+                m_coef = next;
+            render_ramp(frame_count, next);
+            m_coef = next;
+            m_cutoff = fc;
+            m_resonance = res;
+        }
+        flush_denormal(m_ic1eq);
+        flush_denormal(m_ic2eq);
+    }
+
+    void configure(const Config& cfg) override
+    {
+        m_Fs = cfg.sample_rate();
+        m_cutoff = m_resonance = -1;
+    }
+
+    void idle() override
+    {
+        m_ic1eq = m_ic2eq = 0;
+    }
+
+private:
+
+    struct coefficients {
+        float a1, a2, a3, k;
+    };
+
+    coefficients calc_coefficients(float fc, float res) const
+    {
+        float max_fc = 0.49f * m_Fs;
+        if (fc < 1)
+            fc = 1;
+        if (fc > max_fc)
+            fc = max_fc;
+        if (res < 0)
+            res = 0;
+        if (res > 1)
+            res = 1;
+        coefficients c;
+        float g = std::tan(3.14159265f * fc / m_Fs);
+        c.k = 2 - 2 * res;
+        c.a1 = 1 / (1 + g * (g + c.k));
+        c.a2 = g * c.a1;
+        c.a3 = g * c.a2;
+        return c;
+    }
+
+    void render_constant(size_t frame_count)
+    {
+        const float a1 = m_coef.a1, a2 = m_coef.a2, a3 = m_coef.a3;
+        const float k = m_coef.k;
+        float ic1eq = m_ic1eq, ic2eq = m_ic2eq;
+        for (size_t i = 0; i < frame_count; i++) {
+            float v0 = in[i];
+            float v3 = v0 - ic2eq;
+            float v1 = a1 * ic1eq + a2 * v3;
+            float v2 = ic2eq + a2 * ic1eq + a3 * v3;
+            ic1eq = 2 * v1 - ic1eq;
+            ic2eq = 2 * v2 - ic2eq;
+            low[i] = v2;
+            band[i] = v1;
+            high[i] = v0 - k * v1 - v2;
+        }
+        m_ic1eq = ic1eq;
+        m_ic2eq = ic2eq;
+    }
+
+    void render_ramp(size_t frame_count, const coefficients& next)
+    {
+        float inv_n = 1.0f / frame_count;
+        float a1 = m_coef.a1, a2 = m_coef.a2, a3 = m_coef.a3;
+        float k = m_coef.k;
+        const float da1 = (next.a1 - a1) * inv_n;
+        const float da2 = (next.a2 - a2) * inv_n;
+        const float da3 = (next.a3 - a3) * inv_n;
+        const float dk = (next.k - k) * inv_n;
+        float ic1eq = m_ic1eq, ic2eq = m_ic2eq;
+        for (size_t i = 0; i < frame_count; i++) {
+            a1 += da1;
+            a2 += da2;
+            a3 += da3;
+            k += dk;
+            float v0 = in[i];
+            float v3 = v0 - ic2eq;
+            float v1 = a1 * ic1eq + a2 * v3;
+            float v2 = ic2eq + a2 * ic1eq + a3 * v3;
+            ic1eq = 2 * v1 - ic1eq;
+            ic2eq = 2 * v2 - ic2eq;
+            low[i] = v2;
+            band[i] = v1;
+            high[i] = v0 - k * v1 - v2;
+        }
+        m_ic1eq = ic1eq;
+        m_ic2eq = ic2eq;
+    }
+
+    float m_Fs;
+    float m_cutoff;
+    float m_resonance;
+    coefficients m_coef;
+    float m_ic1eq;
+    float m_ic2eq;
+
+};
+
+#endif /* !SVF_included */
@@ -0,0 +1,106 @@
+#include "half-band.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+class half_band_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    static const size_t N = 16;
+
+    void test_instantiate()
+    {
+        (void)HalfBandUp<N>();
+        (void)HalfBandDown<N>();
+        (void)Upsampler<4, N>();
+        (void)Downsampler<4, N>();
+    }
+
+    void test_kernel()
+    {
+        const auto& c = HalfBandKernel<8>::get();
+        float sum = 0;
+        for (size_t j = 0; j < 8; j++)
+            sum += 2 * c[j];
+        TS_ASSERT_DELTA(sum, 1, 1e-6);
+        TS_ASSERT_LESS_THAN(std::fabs(c[0]), std::fabs(c[7]));
+    }
+
+    void test_up_dc()
+    {
+        Upsampler<4, N> up;
+        float in[N], out[4 * N];
+        std::fill(in, in + N, 1.0f);
+        for (size_t i = 0; i < 10; i++)
+            up.process(in, N, out);
+        for (size_t i = 0; i < 4 * N; i++)
+            TS_ASSERT_DELTA(out[i], 1, 1e-5);
+    }
+
+    void test_down_dc()
+    {
+        Downsampler<4, N> down;
+        float in[4 * N], out[N];
+        std::fill(in, in + 4 * N, 1.0f);
+        for (size_t i = 0; i < 10; i++)
+            down.process(in, N, out);
+        for (size_t i = 0; i < N; i++)
+            TS_ASSERT_DELTA(out[i], 1, 1e-5);
+    }
+
+    // Peak level of a sine at `freq` (fraction of the input rate)
+    // after going through a 2x decimator.
+    static float down_peak(float freq)
+    {
+        HalfBandDown<N> down;
+        float in[2 * N], out[N];
+        float peak = 0;
+        size_t n = 0;
+        for (size_t block = 0; block < 100; block++) {
+            for (size_t i = 0; i < 2 * N; i++)
+                in[i] = std::sin(2 * 3.14159265f * freq * n++);
+            down.process(in, N, out);
+            if (block >= 10)
+                for (size_t i = 0; i < N; i++)
+                    peak = std::max(peak, std::fabs(out[i]));
+        }
+        return peak;
+    }
+
+    void test_down_response()
+    {
+        TS_ASSERT_DELTA(down_peak(0.02f), 1, 0.01);
+        TS_ASSERT_LESS_THAN(down_peak(0.35f), 0.002);
+        TS_ASSERT_LESS_THAN(down_peak(0.45f), 0.002);
+    }
+
+    // Up then down is a pure delay.  Each 2x stage delays by 15
+    // frames at its higher rate, so 4x up and down delays by 22.5
+    // frames.
+    void test_round_trip()
+    {
+        Upsampler<4, N> up;
+        Downsampler<4, N> down;
+        const float w = 2 * 3.14159265f * 0.01f;
+        float in[N], mid[4 * N], out[N];
+        float err = 0;
+        size_t n = 0;
+        for (size_t block = 0; block < 100; block++) {
+            for (size_t i = 0; i < N; i++)
+                in[i] = std::sin(w * (n + i));
+            up.process(in, N, mid);
+            down.process(mid, N, out);
+            if (block >= 10)
+                for (size_t i = 0; i < N; i++) {
+                    float expected = std::sin(w * (n + i - 22.5f));
+                    err = std::max(err, std::fabs(out[i] - expected));
+                }
+            n += N;
+        }
+        TS_ASSERT_LESS_THAN(err, 0.01);
+    }
+
+};
@@ -0,0 +1,111 @@
+#include "ladder.h"
+
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+class ladder_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)Ladder();
+    }
+
+    static void configure(Ladder& f, Config::sample_rate_type rate)
+    {
+        Config cfg;
+        cfg.set_sample_rate(rate);
+        f.configure(cfg);
+    }
+
+    // Run a sine through the filter and return the peak output level
+    // once the filter has settled.
+    static float sine_peak(Ladder& f, float freq)
+    {
+        float peak = 0;
+        float w = 2 * 3.14159265f * freq / 48000;
+        size_t n = 0;
+        for (size_t block = 0; block < 4000; block++) {
+            for (size_t i = 0; i < MAX_FRAMES; i++)
+                f.in.buf()[i] = std::sin(w * n++);
+            f.render(MAX_FRAMES);
+            if (block >= 2000)
+                for (size_t i = 0; i < MAX_FRAMES; i++)
+                    peak = std::max(peak, std::fabs(f.out[i]));
+        }
+        return peak;
+    }
+
+    void test_dc()
+    {
+        Ladder f;
+        configure(f, 48000);
+        f.cutoff.clear(1000);
+        f.resonance.clear(0);
+        f.in.clear(1);
+        for (size_t i = 0; i < 1000; i++)
+            f.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(f.out[MAX_FRAMES - 1], 1, 1e-4);
+    }
+
+    // 24 dB/octave: a bit more than 60 dB down 3 1/3 octaves up.
+    void test_response()
+    {
+        Ladder f;
+        configure(f, 48000);
+        f.cutoff.clear(1000);
+        f.resonance.clear(0);
+        TS_ASSERT_DELTA(sine_peak(f, 100), 1, 0.02);
+        TS_ASSERT_LESS_THAN(sine_peak(f, 10000), 0.001);
+    }
+
+    void test_resonance()
+    {
+        Ladder f;
+        configure(f, 48000);
+        f.cutoff.clear(1000);
+        f.resonance.clear(0);
+        float flat = sine_peak(f, 1000);
+        f.resonance.clear(0.9);
+        float peaked = sine_peak(f, 1000);
+        TS_ASSERT_DELTA(flat, 0.25, 0.02);
+        TS_ASSERT_LESS_THAN(1, peaked);
+    }
+
+    void test_sweep()
+    {
+        Ladder f, g;
+        configure(f, 48000);
+        configure(g, 48000);
+        f.resonance.clear(0.5);
+        g.resonance.clear(0.5);
+        f.cutoff.clear(200);
+        g.cutoff.clear(2000);
+        f.in.clear(1);
+        g.in.clear(1);
+        f.render(MAX_FRAMES);
+        f.cutoff.clear(2000);
+        for (size_t i = 0; i < 2000; i++) {
+            f.render(MAX_FRAMES);
+            g.render(MAX_FRAMES);
+        }
+        TS_ASSERT_DELTA(f.out[0], g.out[0], 1e-5);
+    }
+
+    void test_denormal()
+    {
+        Ladder f;
+        configure(f, 48000);
+        f.cutoff.clear(100);
+        f.resonance.clear(0.5);
+        f.in.clear(1);
+        f.render(MAX_FRAMES);
+        f.in.clear(0);
+        for (size_t i = 0; i < 200000; i++)
+            f.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(f.out[MAX_FRAMES - 1], 0);
+    }
+
+};
@@ -0,0 +1,119 @@
+#include "oversampled.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+#include "synth/osc/naive-saw.h"
+
+// Copies its input to its output, and remembers the sample rate.
+class Thru : public ModuleType<Thru> {
+
+public:
+
+    Thru()
+    : Fs{0},
+      render_count{0}
+    {
+        in.name("in");
+        out.name("out");
+        ports(in, out);
+    }
+
+    Input<> in;
+    Output<> out;
+
+    void render(size_t frame_count)
+    {
+        for (size_t i = 0; i < frame_count; i++)
+            out[i] = in[i];
+        render_count++;
+    }
+
+    void configure(const Config& cfg) override
+    {
+        Fs = cfg.sample_rate();
+    }
+
+    float Fs;
+    size_t render_count;
+
+};
+
+class oversampled_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)Oversampled<Thru, 2>();
+        (void)Oversampled<NaiveSaw, 4>();
+    }
+
+    void test_ports()
+    {
+        Oversampled<NaiveSaw, 4> saw;
+        TS_ASSERT_EQUALS(saw.ports().size(), 2);
+        TS_ASSERT_EQUALS(saw.ports()[0]->name(), "freq");
+        TS_ASSERT_EQUALS(saw.ports()[1]->name(), "out");
+        TS_ASSERT_EQUALS(&saw.port(&NaiveSaw::freq), saw.ports()[0]);
+        TS_ASSERT_EQUALS(&saw.port(&NaiveSaw::out), saw.ports()[1]);
+    }
+
+    void test_configure()
+    {
+        Oversampled<Thru, 4> thru;
+        Config cfg;
+        cfg.set_sample_rate(48000);
+        thru.configure(cfg);
+        TS_ASSERT_EQUALS(thru.inner().Fs, 192000);
+    }
+
+    void test_render()
+    {
+        Oversampled<Thru, 4> thru;
+        Input<>& in = thru.port(&Thru::in);
+        Output<>& out = thru.port(&Thru::out);
+        in.clear(0.5f);
+        for (size_t i = 0; i < 100; i++)
+            thru.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(thru.inner().render_count, 400);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_DELTA(out[i], 0.5, 1e-5);
+    }
+
+    // An oversampled saw should have much less energy at an alias
+    // frequency than a naive one.
+    static float alias_level(Module& m, Input<>& freq, Output<>& out)
+    {
+        Config cfg;
+        cfg.set_sample_rate(48000);
+        m.configure(cfg);
+        freq.clear(5000);
+        // 9 * 5000 Hz aliases to 3000 Hz.
+        float w = 2 * 3.14159265f * 3000 / 48000;
+        float re = 0, im = 0;
+        size_t n = 0;
+        for (size_t block = 0; block < 48000 / MAX_FRAMES; block++) {
+            m.make_render_action()(MAX_FRAMES);
+            for (size_t i = 0; i < MAX_FRAMES; i++, n++) {
+                re += out[i] * std::cos(w * n);
+                im += out[i] * std::sin(w * n);
+            }
+        }
+        return std::sqrt(re * re + im * im) / n;
+    }
+
+    void test_aliasing()
+    {
+        NaiveSaw naive;
+        Oversampled<NaiveSaw, 4> over;
+        float naive_alias = alias_level(naive, naive.freq, naive.out);
+        float over_alias = alias_level(over,
+                                       over.port(&NaiveSaw::freq),
+                                       over.port(&NaiveSaw::out));
+        TS_ASSERT_LESS_THAN(over_alias * 4, naive_alias);
+    }
+
+};
@@ -0,0 +1,200 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+// Records what it is given.
+class Recorder : public ModuleType<Recorder> {
+
+public:
+
+    Recorder()
+    : Fs{0},
+      count{0}
+    {
+        in.name("in");
+        ports(in);
+    }
+
+    Input<> in;
+
+    void render(size_t frame_count)
+    {
+        assert(frame_count <= MAX_FRAMES);
+        for (size_t i = 0; i < frame_count; i++)
+            if (count < MAX_SAMPLES)
+                samples[count++] = in[i];
+    }
+
+    void configure(const Config& cfg) override
+    {
+        Fs = cfg.sample_rate();
+    }
+
+    static const size_t MAX_SAMPLES = 10000;
+    float Fs;
+    size_t count;
+    float samples[MAX_SAMPLES];
+
+};
+
+class resampler_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    static const size_t N = 16;
+    typedef Resampler<N> resampler;
+
+    void test_instantiate()
+    {
+        (void)resampler();
+        (void)ResampleStage<Recorder>();
+    }
+
+    void test_bypass()
+    {
+        resampler r;
+        r.configure(48000, 48000);
+        TS_ASSERT(r.is_bypass());
+        float in[N], out[resampler::MAX_OUT];
+        for (size_t i = 0; i < N; i++)
+            in[i] = i;
+        TS_ASSERT_EQUALS(r.process(in, N, out), N);
+        for (size_t i = 0; i < N; i++)
+            TS_ASSERT_EQUALS(out[i], i);
+    }
+
+    // Run `seconds` of a signal through; return the number of output
+    // frames, and the largest error after the filter settles.
+    static size_t run(unsigned in_rate,
+                      unsigned out_rate,
+                      float freq,
+                      float& max_err)
+    {
+        resampler r;
+        r.configure(in_rate, out_rate);
+        const double w = 2 * 3.14159265358979 * freq;
+        const double delay = 32.0 / in_rate;
+        float in[N], out[resampler::MAX_OUT];
+        size_t n_in = 0, n_out = 0;
+        max_err = 0;
+        while (n_in < in_rate) {
+            for (size_t i = 0; i < N; i++)
+                in[i] = std::sin(w * (n_in + i) / in_rate);
+            n_in += N;
+            size_t n = r.process(in, N, out);
+            TS_ASSERT_LESS_THAN_EQUALS(n, resampler::max_output(N));
+            for (size_t i = 0; i < n; i++, n_out++) {
+                if (n_out < out_rate / 100)
+                    continue;
+                double t = double(n_out) / out_rate - delay;
+                float err = std::fabs(out[i] - std::sin(w * t));
+                max_err = std::max(max_err, err);
+            }
+        }
+        return n_out;
+    }
+
+    void test_up()
+    {
+        float err;
+        size_t n = run(44100, 48000, 1000, err);
+        TS_ASSERT_DELTA(n, 48000, 20);
+        TS_ASSERT_LESS_THAN(err, 0.002);
+    }
+
+    void test_down()
+    {
+        float err;
+        size_t n = run(48000, 44100, 1000, err);
+        TS_ASSERT_DELTA(n, 44100, 20);
+        TS_ASSERT_LESS_THAN(err, 0.002);
+    }
+
+    void test_big_ratio()
+    {
+        float err;
+        size_t n = run(24000, 96000, 500, err);
+        TS_ASSERT_DELTA(n, 96000, 80);
+        TS_ASSERT_LESS_THAN(err, 0.002);
+        n = run(96000, 24000, 500, err);
+        TS_ASSERT_DELTA(n, 24000, 20);
+        TS_ASSERT_LESS_THAN(err, 0.002);
+    }
+
+    // The smallest ratio supported still has a passband.
+    void test_smallest_ratio()
+    {
+        float err;
+        size_t n = run(96000, 96000 / resampler::MAX_RATIO, 100, err);
+        TS_ASSERT_DELTA(n, 12000, 20);
+        TS_ASSERT_LESS_THAN(err, 0.01);
+    }
+
+    // At 11:32, a 16 tap kernel's cutoff would fall to zero.  It
+    // still passes DC.
+    void test_short_kernel()
+    {
+        Resampler<N, 16> r;
+        r.configure(32000, 11000);
+        float in[N], out[resampler::MAX_OUT];
+        for (size_t i = 0; i < N; i++)
+            in[i] = 1;
+        size_t n = 0;
+        for (size_t block = 0; block < 10; block++)
+            n = r.process(in, N, out);
+        TS_ASSERT_LESS_THAN(0, n);
+        TS_ASSERT_DELTA(out[0], 1, 0.0001);
+    }
+
+    // Above the output's Nyquist frequency, signals are removed.
+    void test_antialias()
+    {
+        resampler r;
+        r.configure(96000, 32000);
+        float in[N], out[resampler::MAX_OUT];
+        float peak = 0;
+        size_t n_in = 0;
+        for (size_t block = 0; block < 1000; block++) {
+            for (size_t i = 0; i < N; i++, n_in++)
+                in[i] = std::sin(2 * 3.14159265 * 20000 * n_in / 96000);
+            size_t n = r.process(in, N, out);
+            if (block > 10)
+                for (size_t i = 0; i < n; i++)
+                    peak = std::max(peak, std::fabs(out[i]));
+        }
+        TS_ASSERT_LESS_THAN(peak, 0.01);
+    }
+
+    void test_stage()
+    {
+        ResampleStage<Recorder> stage;
+        stage.output_rate(48000);
+        Config cfg;
+        cfg.set_sample_rate(24000);
+        stage.configure(cfg);
+        TS_ASSERT_EQUALS(stage.sink().Fs, 48000);
+        stage.in.clear(1);
+        for (size_t i = 0; i < 1000; i++)
+            stage.render(MAX_FRAMES);
+        const Recorder& rec = stage.sink();
+        TS_ASSERT_DELTA(rec.count, 2 * 1000 * MAX_FRAMES, 20);
+        TS_ASSERT_DELTA(rec.samples[rec.count - 1], 1, 1e-5);
+    }
+
+    void test_stage_bypass()
+    {
+        ResampleStage<Recorder> stage;
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        stage.configure(cfg);
+        TS_ASSERT_EQUALS(stage.sink().Fs, 44100);
+        stage.in.clear(0.25);
+        stage.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(stage.sink().count, MAX_FRAMES);
+        TS_ASSERT_EQUALS(stage.sink().samples[0], 0.25);
+    }
+
+};
@@ -0,0 +1,120 @@
+#include "svf.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+class svf_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)SVF();
+    }
+
+    static void configure(SVF& f, Config::sample_rate_type rate)
+    {
+        Config cfg;
+        cfg.set_sample_rate(rate);
+        f.configure(cfg);
+    }
+
+    // Run a sine through the filter and return the peak output level
+    // once the filter has settled.
+    static float sine_peak(SVF& f, const Output<>& out, float freq)
+    {
+        float peak = 0;
+        float w = 2 * 3.14159265f * freq / 48000;
+        size_t n = 0;
+        for (size_t block = 0; block < 4000; block++) {
+            for (size_t i = 0; i < MAX_FRAMES; i++)
+                f.in.buf()[i] = std::sin(w * n++);
+            f.render(MAX_FRAMES);
+            if (block >= 2000)
+                for (size_t i = 0; i < MAX_FRAMES; i++)
+                    peak = std::max(peak, std::fabs(out.buf()[i]));
+        }
+        return peak;
+    }
+
+    void test_dc()
+    {
+        SVF f;
+        configure(f, 48000);
+        f.cutoff.clear(1000);
+        f.resonance.clear(0);
+        f.in.clear(1);
+        for (size_t i = 0; i < 1000; i++)
+            f.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(f.low[MAX_FRAMES - 1], 1, 1e-4);
+        TS_ASSERT_DELTA(f.band[MAX_FRAMES - 1], 0, 1e-4);
+        TS_ASSERT_DELTA(f.high[MAX_FRAMES - 1], 0, 1e-4);
+    }
+
+    void test_response()
+    {
+        SVF f;
+        configure(f, 48000);
+        f.cutoff.clear(1000);
+        f.resonance.clear(0);
+        float pass = sine_peak(f, f.low, 100);
+        float stop = sine_peak(f, f.low, 10000);
+        TS_ASSERT_DELTA(pass, 1, 0.02);
+        TS_ASSERT_LESS_THAN(stop, 0.02);
+        TS_ASSERT_DELTA(sine_peak(f, f.high, 10000), 1, 0.02);
+    }
+
+    // Resonance raises the gain at the cutoff frequency.
+    void test_resonance()
+    {
+        SVF f;
+        configure(f, 48000);
+        f.cutoff.clear(1000);
+        f.resonance.clear(0);
+        float flat = sine_peak(f, f.low, 1000);
+        f.resonance.clear(0.9);
+        float peaked = sine_peak(f, f.low, 1000);
+        TS_ASSERT_DELTA(flat, 0.5, 0.02);
+        TS_ASSERT_LESS_THAN(3, peaked);
+    }
+
+    // A cutoff sweep ramps the coefficients, so it lands on the
+    // same state as a filter that was always at the new cutoff.
+    void test_sweep()
+    {
+        SVF f, g;
+        configure(f, 48000);
+        configure(g, 48000);
+        f.resonance.clear(0.5);
+        g.resonance.clear(0.5);
+        f.cutoff.clear(200);
+        g.cutoff.clear(2000);
+        f.in.clear(1);
+        g.in.clear(1);
+        f.render(MAX_FRAMES);
+        f.cutoff.clear(2000);
+        for (size_t i = 0; i < 2000; i++) {
+            f.render(MAX_FRAMES);
+            g.render(MAX_FRAMES);
+        }
+        TS_ASSERT_DELTA(f.low[0], g.low[0], 1e-5);
+    }
+
+    void test_denormal()
+    {
+        SVF f;
+        configure(f, 48000);
+        f.cutoff.clear(100);
+        f.resonance.clear(0.5);
+        f.in.clear(1);
+        f.render(MAX_FRAMES);
+        f.in.clear(0);
+        for (size_t i = 0; i < 200000; i++)
+            f.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(f.low[MAX_FRAMES - 1], 0);
+        TS_ASSERT_EQUALS(f.band[MAX_FRAMES - 1], 0);
+    }
+
+};
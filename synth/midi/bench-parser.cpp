@@ -0,0 +1,120 @@
+// MIDI parser throughput benchmark.
+//
+// Builds an 8 megabyte stream that looks like a dense capture: runs
+// of controllers, pitch bends, and pressure under running status,
+// note on/off pairs, timing clocks, and the odd SYSEX message.  Then
+// it parses the stream with process_bytes and a std::function small
+// handler, and with process_bulk and a batch handler, and reports
+// megabytes per second.  Build with BUILD=release for meaningful
+// numbers.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "synth/midi/parser.h"
+
+using midi::Parser;
+using midi::SmallMessage;
+
+static const size_t STREAM_SIZE = 8 << 20;
+static const size_t CHUNK_SIZE = 4096;
+static const int REPEAT = 10;
+
+static std::string make_stream()
+{
+    std::string s;
+    std::srand(1);
+    while (s.size() < STREAM_SIZE) {
+        int r = std::rand();
+        char chan = r & 0x0F;
+        switch (r >> 4 & 7) {
+
+        case 0:                 // note on, note off
+            s += char(0x90 | chan);
+            s += char(r >> 8 & 0x7F);
+            s += char(0x64);
+            s += char(r >> 8 & 0x7F);
+            s += char(0x00);
+            break;
+
+        case 1:                 // timing clock
+            s += char(0xF8);
+            break;
+
+        case 2:                 // small SYSEX
+            s += "\xF0\x7D\x01\x02\x03\xF7";
+            break;
+
+        case 3:                 // channel pressure run
+            s += char(0xD0 | chan);
+            for (int i = 0; i < 16; i++)
+                s += char(((r >> 8) + i) & 0x7F);
+            break;
+
+        case 4:                 // pitch bend run
+            s += char(0xE0 | chan);
+            for (int i = 0; i < 32; i++) {
+                s += char(i);
+                s += char(((r >> 8) + i) & 0x7F);
+            }
+            break;
+
+        default:                // controller run
+            s += char(0xB0 | chan);
+            for (int i = 0; i < 32; i++) {
+                s += char(r >> 12 & 0x3F);
+                s += char(((r >> 8) + i) & 0x7F);
+            }
+            break;
+        }
+    }
+    s.resize(STREAM_SIZE);
+    return s;
+}
+
+static unsigned long message_count;
+
+static void count_batch(void *, const SmallMessage *, size_t count)
+{
+    message_count += count;
+}
+
+template <class F>
+static void bench(const char *name, F parse)
+{
+    message_count = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEAT; i++)
+        parse();
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> dt = t1 - t0;
+    double mbps = double(STREAM_SIZE) * REPEAT / dt.count() / 1e6;
+    std::cout << name << mbps << " Mbytes/sec, "
+              << message_count / REPEAT << " messages"
+              << std::endl;
+}
+
+int main()
+{
+    const std::string stream = make_stream();
+
+    Parser bytes;
+    bytes.register_handler(Parser::small_handler(
+        [] (const SmallMessage&) { message_count++; }));
+    bench("process_bytes: ", [&] {
+        for (size_t i = 0; i < stream.size(); i += CHUNK_SIZE)
+            bytes.process_bytes(stream.data() + i, CHUNK_SIZE);
+    });
+
+    Parser bulk;
+    bulk.register_handler(Parser::batch_handler(count_batch, nullptr));
+    bench("process_bulk:  ", [&] {
+        for (size_t i = 0; i < stream.size(); i += CHUNK_SIZE)
+            bulk.process_bulk(stream.data() + i, CHUNK_SIZE);
+    });
+
+    return 0;
+}
@@ -4,8 +4,14 @@
 #include <cassert>
 #include <cstdint>
 
+#include "synth/core/config.h"
 #include "synth/core/controls.h"
 #include "synth/core/defs.h"
+#include "synth/core/smoother.h"
+#include "synth/midi/defs.h"
+#include "synth/midi/messages.h"
+#include "synth/midi/param.h"
+#include "synth/midi/tuning.h"
 
 // MIDI CCs that are not controllers
 //   bank select        CC     0/32
@@ -157,49 +163,360 @@ namespace midi {
     template <class Sample = DEFAULT_SAMPLE_TYPE>
     Sample note_to_freq(uint8_t note);
     template <>
-    float note_to_freq<float>(uint8_t note)
+    inline float note_to_freq<float>(uint8_t note)
     {
-        return 440.0f * powf(2.0f, (note - 69) * (1.0f / 12.0f));
+        return Tuning::equal_temperament().freq(note);
     }
 
+
+    // -- Smoothed Controls -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+    //
+    // Each MIDI control has one or more handlers which the MIDI layer
+    // calls when a message arrives.  The handler scales the message's
+    // value and hands it to a Smoother; `render` just runs the
+    // Smoother.  So a control that isn't moving costs nothing.
+    //
+    // Values are scaled to [0..1], except pitch bend, which is
+    // [-1..1).  Seven bit values are scaled so that 127 is 1.0.
+    //
+    // Connect a control to the MIDI layer with a binding, e.g.,
+    //
+    //     dispatcher.register_handler(
+    //         ControllerNumber::MOD_WHEEL_MSB,
+    //         timbres,
+    //         Dispatcher::small_handler::binding<
+    //             Modulation,
+    //             &Modulation::handle_message
+    //         >(&mod_wheel));
+    //
+    // A 14 bit CC's MSB and LSB numbers should both be registered.
+
+    template <class C>
+    class SmoothedControl : public ControlType<C> {
+
+    public:
+
+        void render(size_t frame_count)
+        {
+            m_smoother.render(this->out, frame_count);
+        }
+
+        void configure(const Config& cfg) override
+        {
+            m_smoother.configure(cfg.sample_rate());
+        }
+
+        Smoother& smoother() { return m_smoother; }
+        const Smoother& smoother() const { return m_smoother; }
+
+    protected:
+
+        SmoothedControl(Smoother::Curve curve = Smoother::Curve::ONE_POLE)
+        : m_smoother{curve}
+        {}
+
+        Smoother m_smoother;
+
+    };
+
+    // Per-note values should not glide from the previous note's
+    // value, so per-note controls settle when the note starts.
+    template <class C>
+    class NoteControl : public SmoothedControl<C> {
+
+    public:
+
+        void start_note() override
+        {
+            this->m_smoother.settle();
+        }
+
+        bool note_is_done() const override
+        {
+            return true;
+        }
+
+    protected:
+
+        NoteControl(Smoother::Curve curve = Smoother::Curve::ONE_POLE)
+        : SmoothedControl<C>{curve}
+        {}
+
+    };
+
+    // NoteFreqControl combines note number, portamento, and pitch
+    // bend, and emits frequency in Hz.
+    //
+    // Pitch is smoothed in semitones: the note glides linearly over
+    // `portamento_time` and the bend follows a one pole smoother.
+    // Then pitch is converted to frequency through the Tuning at the
+    // block's end and interpolated linearly across the block, so
+    // there is one table lookup per block while the pitch moves, and
+    // none once it settles.
+    //
+    // Pitch bend is a channel message but this is a voice control, so
+    // the timbre's pitch bend handler should call every voice's
+    // `handle_pitch_bend`.
     class NoteFreqControl : public ControlType<NoteFreqControl> {
-        // Combine note number, pitch bend, and portamento.
+
     public:
-        void render(size_t) { assert(false && "write me!"); }
+
+        NoteFreqControl()
+        : m_tuning{&Tuning::equal_temperament()},
+          m_note{Smoother::Curve::LINEAR, 0},
+          m_bend_range{2},
+          m_bend_value{0},
+          m_glide_pending{false},
+          m_freq{0},
+          m_is_constant{false}
+        {}
+
+        void render(size_t frame_count)
+        {
+            assert(frame_count);
+            if (m_is_constant && m_note.is_settled() && m_bend.is_settled())
+                return;
+            float n0, n1, b0, b1;
+            m_note.advance(frame_count, n0, n1);
+            m_bend.advance(frame_count, b0, b1);
+            float f1 = (m_freq && n0 + b0 == n1 + b1)
+                       ? m_freq
+                       : m_tuning->freq(n1 + b1);
+            float f0 = m_freq;
+            if (!f0)
+                f0 = n0 + b0 == n1 + b1 ? f1 : m_tuning->freq(n0 + b0);
+            m_freq = f1;
+            if (f0 == f1 && m_note.is_settled() && m_bend.is_settled()) {
+                for (size_t i = 0; i < MAX_FRAMES; i++)
+                    out[i] = f1;
+                m_is_constant = true;
+                return;
+            }
+            m_is_constant = false;
+            float inc = (f1 - f0) / frame_count;
+            float f = f0;
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] = f += inc;
+            out[frame_count - 1] = f1;
+        }
+
+        void configure(const Config& cfg) override
+        {
+            m_note.configure(cfg.sample_rate());
+            m_bend.configure(cfg.sample_rate());
+        }
+
+        void start_note() override
+        {
+            // Without portamento, a new note starts on pitch.
+            if (!m_glide_pending)
+                m_note.settle();
+            m_glide_pending = false;
+            m_bend.settle();
+            m_freq = 0;
+            m_is_constant = false;
+        }
+
+        bool note_is_done() const override
+        {
+            return true;
+        }
+
+        // Retune.  The new tuning takes effect at the next block.
+        void tuning(const Tuning& t)
+        {
+            m_tuning = &t;
+            m_freq = 0;
+            m_is_constant = false;
+        }
+
+        // Pitch bend range in semitones.
+        void bend_range(float semitones)
+        {
+            m_bend_range = semitones;
+            m_bend.set(m_bend_value * m_bend_range);
+        }
+
+        void portamento_time(float seconds)
+        {
+            m_note.time(seconds);
+        }
+
+        void handle_note_number(std::uint8_t note)
+        {
+            m_note.set(note);
+        }
+
+        // Called after `handle_note_number`.  Start from `note` and
+        // glide to the new note.
+        void handle_portamento_note(std::uint8_t note)
+        {
+            float target = m_note.target();
+            m_note.jump(note);
+            m_note.set(target);
+            m_glide_pending = true;
+        }
+
+        void handle_pitch_bend(std::int16_t bend)
+        {
+            m_bend_value = bend * (1.0f / 8192);
+            m_bend.set(m_bend_value * m_bend_range);
+        }
+
+    private:
+
+        const Tuning *m_tuning;
+        Smoother m_note;
+        Smoother m_bend;
+        float m_bend_range;
+        float m_bend_value;
+        bool m_glide_pending;
+        float m_freq;
+        bool m_is_constant;
+
     };
 
-    class AttackVelocityControl : public ControlType<AttackVelocityControl> {
+    class AttackVelocityControl : public NoteControl<AttackVelocityControl> {
+
+    public:
+
+        AttackVelocityControl()
+        : NoteControl{Smoother::Curve::STEP}
+        {}
+
+        // 14 bit velocity.  See High Resolution Velocity Prefix, CA-031.
+        void handle_attack_velocity(std::uint16_t velocity)
+        {
+            m_smoother.set(velocity * (1.0f / 16383));
+        }
 
     };
 
-    class ReleaseVelocityControl : public ControlType<ReleaseVelocityControl> {
+    class ReleaseVelocityControl
+    : public NoteControl<ReleaseVelocityControl> {
+
+    public:
+
+        ReleaseVelocityControl()
+        : NoteControl{Smoother::Curve::STEP}
+        {}
+
+        void handle_release_velocity(std::uint8_t velocity)
+        {
+            m_smoother.set(velocity * (1.0f / 127));
+        }
 
     };
 
-    class PolyPressureControl : public ControlType<PolyPressureControl> {
+    class PolyPressureControl : public NoteControl<PolyPressureControl> {
+
+    public:
+
+        void handle_poly_pressure(std::uint8_t pressure)
+        {
+            m_smoother.set(pressure * (1.0f / 127));
+        }
 
     };
 
-    class ChannelPressureControl : public ControlType<ChannelPressureControl> {
+    class ChannelPressureControl
+    : public SmoothedControl<ChannelPressureControl> {
+
+    public:
+
+        void handle_channel_pressure(std::uint8_t pressure)
+        {
+            m_smoother.set(pressure * (1.0f / 127));
+        }
 
     };
 
-    class PitchBendControl : public ControlType<PitchBendControl> {
+    class PitchBendControl : public SmoothedControl<PitchBendControl> {
+
+    public:
+
+        void handle_pitch_bend(std::int16_t bend)
+        {
+            m_smoother.set(bend * (1.0f / 8192));
+        }
 
     };
 
+    // CCs 0-31 are the MSBs of 14 bit controllers; CCs 32-63 are
+    // their LSBs.  An MSB alone is extended to 14 bits by repeating
+    // it, so 127 still means 1.0.  An LSB refines the latest MSB.
+    // CCs 64-119 are seven bit controllers.
     template <uint8_t N>
-    class CCControl : public ControlType<CCControl<N>> {
+    class CCControl : public SmoothedControl<CCControl<N>> {
+
+        static_assert(N < 32 || (N >= 64 && N < CC_COUNT), "illegal CC");
+
+    public:
+
+        static const bool is_14_bit = N < 32;
+
+        CCControl()
+        : m_msb{0}
+        {}
+
+        void handle_message(const SmallMessage& msg)
+        {
+            assert(msg.status() == StatusByte::CONTROL_CHANGE);
+            auto cc = msg.control_number();
+            auto value = msg.control_value();
+            if (!is_14_bit) {
+                assert(cc == N);
+                this->m_smoother.set(value * (1.0f / 127));
+            } else if (cc == N) {
+                m_msb = value;
+                set14(value);
+            } else {
+                assert(cc == N + 32);
+                set14(value);
+            }
+        }
+
+    private:
+
+        void set14(std::uint8_t lsb)
+        {
+            this->m_smoother.set((m_msb << 7 | lsb) * (1.0f / 16383));
+        }
+
+        std::uint8_t m_msb;
+
     };
 
     template <std::uint8_t MSB, std::uint8_t LSB>
-    class RPNControl : public ControlType<RPNControl<MSB, LSB>> {
+    class RPNControl : public SmoothedControl<RPNControl<MSB, LSB>> {
+
         static_assert(MSB < 128 && LSB < 128, "illegal RPN");
+
+    public:
+
+        void handle_parameter(std::uint8_t,
+                              const ParameterNumber&,
+                              const ParameterValue& value)
+        {
+            this->m_smoother.set(value.value() * (1.0f / 16383));
+        }
+
     };
 
     template <std::uint8_t MSB, std::uint8_t LSB>
-    class NRPNControl : public ControlType<NRPNControl<MSB, LSB>> {
+    class NRPNControl : public SmoothedControl<NRPNControl<MSB, LSB>> {
+
         static_assert(MSB < 128 && LSB < 128, "illegal NRPN");
+
+    public:
+
+        void handle_parameter(std::uint8_t,
+                              const ParameterNumber&,
+                              const ParameterValue& value)
+        {
+            this->m_smoother.set(value.value() * (1.0f / 16383));
+        }
+
     };
 
     typedef CCControl<1> Modulation;
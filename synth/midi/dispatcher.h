@@ -10,7 +10,9 @@
 #include "synth/midi/layering.h"
 #include "synth/midi/messages.h"
 #include "synth/midi/param.h"
+#include "synth/midi/sizes.h"
 #include "synth/util/fixed-map.h"
+#include "synth/util/fixed-vector.h"
 #include "synth/util/function.h"
 
 namespace midi {
@@ -31,6 +33,7 @@ namespace midi {
                               const ParameterNumber&,
                               const ParameterValue&)> xRPN_handler;
         typedef function<void(const SysexMessage&)>  sysex_handler;
+        typedef function<void(const SysexChunk&)>    chunk_handler;
 
         Dispatcher();
 
@@ -40,8 +43,19 @@ namespace midi {
         // Reset the xRPN state machines.
         void reset();
 
-        // a packet of messages arrives simultaneously.
-        // defer calling handlers until end of packet.
+        // A packet of messages arrives simultaneously (e.g., one
+        // audio block's worth).  Between begin_packet and end_packet,
+        // continuous messages -- pitch bend, pressure, and most
+        // controllers -- are held back, and a newer value for the
+        // same channel and controller replaces the held one.  So a
+        // dense controller stream costs one handler call per
+        // controller per packet.
+        //
+        // Everything else (notes, switches, RPN/NRPN selection and
+        // data entry, channel mode messages, system common) first
+        // delivers the held messages, in order, then is delivered
+        // itself, so ordering between the two kinds is exact.
+        // System real time messages are delivered at once.
         void begin_packet();
         void end_packet();
 
@@ -49,6 +63,13 @@ namespace midi {
         void dispatch_message(const SmallMessage& msg);
         void dispatch_message(const SysexMessage& msg);
 
+        // Insert SYSEX chunks (e.g., from Parser's chunk handler)
+        // here.  The first chunk that completes the manufacturer ID
+        // chooses the handler.  That handler then sees the message
+        // as a BEGIN chunk holding F0 and the ID, followed by the
+        // rest of the chunks as they arrive, uncopied.
+        void dispatch_chunk(const SysexChunk&);
+
         // Channel Message Handlers
         void register_handler(StatusByte,        c_mask, const small_handler&);
         void register_handler(ControllerNumber,  t_mask, const small_handler&);
@@ -61,6 +82,7 @@ namespace midi {
         void register_handler(const SysexID&,            const sysex_handler&);
         void register_handler(UniversalSysexNonRealTime, const sysex_handler&);
         void register_handler(UniversalSysexRealTime,    const sysex_handler&);
+        void register_handler(const SysexID&,            const chunk_handler&);
 
     private:
 
@@ -99,6 +121,25 @@ namespace midi {
             std::array<small_handler, 128> cc_handlers;
         };
 
+        struct sysex_route {
+            SysexID id;
+            chunk_handler handler;
+        };
+
+        // F0 and up to three ID bytes.
+        static const size_t SYSEX_HEADER_SIZE = 4;
+
+        static bool is_coalescible(const SmallMessage&);
+        static bool is_same_control(const SmallMessage&,
+                                    const SmallMessage&);
+        void coalesce(const SmallMessage&);
+        void drop_held(const SmallMessage&);
+        void flush_packet();
+        void deliver(const SmallMessage&);
+
+        bool sysex_header_is_complete() const;
+        const chunk_handler *find_sysex_route() const;
+
         void handle_cc(const SmallMessage&);
         void handle_data_entry_msb(const SmallMessage&);
         void handle_data_entry_lsb(const SmallMessage&);
@@ -143,7 +184,15 @@ namespace midi {
         std::array<channel, CHANNEL_COUNT> m_channels;
         std::array<timbre, MAX_TIMBRES> m_timbres;
 
-        // ??? SYSEX ???
+        bool m_in_packet;
+        fixed_vector<SmallMessage, MAX_COALESCED> m_held;
+
+        // Universal IDs are not counted in MAX_SYSEX_IDS.
+        fixed_vector<sysex_route, MAX_SYSEX_IDS + 2> m_sysex_routes;
+        const chunk_handler *m_sysex_route;
+        bool m_sysex_routing;
+        size_t m_sysex_header_size;
+        std::uint8_t m_sysex_header[SYSEX_HEADER_SIZE];
 
     };
 
@@ -172,7 +221,11 @@ namespace midi {
     inline
     Dispatcher::
     Dispatcher()
-    : m_layering{nullptr}
+    : m_layering{nullptr},
+      m_in_packet{false},
+      m_sysex_route{nullptr},
+      m_sysex_routing{false},
+      m_sysex_header_size{0}
     {
         register_handler(StatusByte::CONTROL_CHANGE,
                          Layering::ALL_CHANNELS,
@@ -221,15 +274,22 @@ namespace midi {
         m_layering = &l;
     }
 
-    // inline void
-    // Dispatcher::
-    // begin_packet()
-    // {}
-    //
-    // inline void
-    // Dispatcher::
-    // end_packet()
-    // {}
+    inline void
+    Dispatcher::
+    begin_packet()
+    {
+        assert(!m_in_packet);
+        m_in_packet = true;
+    }
+
+    inline void
+    Dispatcher::
+    end_packet()
+    {
+        assert(m_in_packet);
+        flush_packet();
+        m_in_packet = false;
+    }
 
     inline void
     Dispatcher::
@@ -244,10 +304,12 @@ namespace midi {
     dispatch_message(const SmallMessage& msg)
     {
         assert(msg);
-        size_t index = msg.status_byte & 0x7F;
-        auto& handler = m_status_byte_handlers[index];
-        if (handler)
-            handler(msg);
+        if (m_in_packet && !msg.is_system_real_time_message()) {
+            if (is_coalescible(msg))
+                return coalesce(msg);
+            flush_packet();
+        }
+        deliver(msg);
     }
 
     // inline void
@@ -257,6 +319,52 @@ namespace midi {
     //     assert(!"write me!");
     // }
 
+    inline void
+    Dispatcher::
+    dispatch_chunk(const SysexChunk& chunk)
+    {
+        if (m_in_packet)
+            flush_packet();
+        const std::uint8_t *p = chunk.data;
+        const std::uint8_t *end = p + chunk.size;
+        std::uint8_t flags = chunk.flags;
+        if (chunk.is_begin()) {
+            m_sysex_route = nullptr;
+            m_sysex_routing = true;
+            m_sysex_header_size = 0;
+        }
+        if (m_sysex_routing) {
+            while (p < end && !sysex_header_is_complete())
+                m_sysex_header[m_sysex_header_size++] = *p++;
+            if (sysex_header_is_complete()) {
+                m_sysex_routing = false;
+                m_sysex_route = find_sysex_route();
+                if (m_sysex_route) {
+                    // If the ID ends the chunk, the header carries
+                    // the chunk's END flag.
+                    std::uint8_t hflags = SysexChunk::BEGIN;
+                    if (p == end) {
+                        hflags |= flags;
+                        flags = 0;
+                    }
+                    SysexChunk head{m_sysex_header,
+                                    m_sysex_header_size,
+                                    hflags};
+                    (*m_sysex_route)(head);
+                    flags &= ~SysexChunk::BEGIN;
+                }
+            } else if (chunk.is_end()) {
+                m_sysex_routing = false;        // too short; ignore it.
+            }
+        }
+        if (m_sysex_route && (p < end || flags)) {
+            SysexChunk rest{p, size_t(end - p), flags};
+            (*m_sysex_route)(rest);
+        }
+        if (chunk.is_end())
+            m_sysex_route = nullptr;
+    }
+
     inline void
     Dispatcher::
     register_handler(StatusByte s, c_mask m, const small_handler& h)
@@ -327,6 +435,162 @@ namespace midi {
         pos = h;
     }
 
+    inline void
+    Dispatcher::
+    register_handler(const SysexID& id, const chunk_handler& h)
+    {
+        for (auto& route: m_sysex_routes) {
+            if (route.id == id) {
+                route.handler = h;
+                return;
+            }
+        }
+        m_sysex_routes.push_back(sysex_route{id, h});
+    }
+
+    // Data entry, the xRPN selectors, and inc/dec feed the xRPN
+    // state machines, switches are not continuous, and channel mode
+    // messages are commands.  None of those may be reordered or
+    // dropped.
+    inline bool
+    Dispatcher::
+    is_coalescible(const SmallMessage& msg)
+    {
+        switch (msg.status()) {
+
+        case StatusByte::POLY_KEY_PRESSURE:
+        case StatusByte::CHANNEL_PRESSURE:
+        case StatusByte::PITCH_BEND:
+            return true;
+
+        case StatusByte::CONTROL_CHANGE:
+            switch (ControllerNumber(msg.control_number())) {
+
+            case ControllerNumber::DATA_ENTRY_MSB:
+            case ControllerNumber::DATA_ENTRY_LSB:
+            case ControllerNumber::DAMPER_PEDAL:
+            case ControllerNumber::PORTAMENTO_ON_OFF:
+            case ControllerNumber::SOSTENUTO:
+            case ControllerNumber::SOFT_PEDAL:
+            case ControllerNumber::LEGATO_FOOTSWITCH:
+            case ControllerNumber::HOLD_2:
+            case ControllerNumber::PORTAMENTO_CONTROL:
+            case ControllerNumber::DATA_INCREMENT:
+            case ControllerNumber::DATA_DECREMENT:
+            case ControllerNumber::NRPN_LSB:
+            case ControllerNumber::NRPN_MSB:
+            case ControllerNumber::RPN_LSB:
+            case ControllerNumber::RPN_MSB:
+                return false;
+
+            default:
+                return msg.control_number() < CC_COUNT;
+            }
+
+        default:
+            return false;
+        }
+    }
+
+    // Same status byte (so same channel) and, for controllers and
+    // poly pressure, same first data byte.
+    inline bool
+    Dispatcher::
+    is_same_control(const SmallMessage& a, const SmallMessage& b)
+    {
+        if (a.status_byte != b.status_byte)
+            return false;
+        switch (a.status()) {
+
+        case StatusByte::POLY_KEY_PRESSURE:
+        case StatusByte::CONTROL_CHANGE:
+            return a.data_byte_1 == b.data_byte_1;
+
+        default:
+            return true;
+        }
+    }
+
+    // A held message keeps its place, the position of the first
+    // message for that control, and takes the newest value.  A new
+    // MSB drops the held LSB, which belonged to an older MSB; the new
+    // LSB follows later and is held after the MSB.  So a held pair
+    // is delivered MSB first.
+    inline void
+    Dispatcher::
+    coalesce(const SmallMessage& msg)
+    {
+        if (msg.status() == StatusByte::CONTROL_CHANGE &&
+            msg.control_number() < 32)
+            drop_held(SmallMessage(msg.status_byte,
+                                   msg.control_number() + 32,
+                                   0));
+        for (auto& held: m_held) {
+            if (is_same_control(held, msg)) {
+                held = msg;
+                return;
+            }
+        }
+        if (m_held.size() == m_held.max_size())
+            flush_packet();
+        m_held.push_back(msg);
+    }
+
+    inline void
+    Dispatcher::
+    drop_held(const SmallMessage& msg)
+    {
+        for (auto it = m_held.begin(); it != m_held.end(); ++it) {
+            if (is_same_control(*it, msg)) {
+                m_held.erase(it);
+                return;
+            }
+        }
+    }
+
+    inline void
+    Dispatcher::
+    flush_packet()
+    {
+        for (const auto& msg: m_held)
+            deliver(msg);
+        m_held.clear();
+    }
+
+    inline void
+    Dispatcher::
+    deliver(const SmallMessage& msg)
+    {
+        size_t index = msg.status_byte & 0x7F;
+        auto& handler = m_status_byte_handlers[index];
+        if (handler)
+            handler(msg);
+    }
+
+    inline bool
+    Dispatcher::
+    sysex_header_is_complete() const
+    {
+        if (m_sysex_header_size < 2)
+            return false;
+        return m_sysex_header[1] != 0x00 || m_sysex_header_size == 4;
+    }
+
+    inline auto
+    Dispatcher::
+    find_sysex_route() const
+    -> const chunk_handler *
+    {
+        const std::uint8_t *h = m_sysex_header;
+        for (const auto& route: m_sysex_routes) {
+            const auto& id = route.id.data;
+            if (id[0] == h[1] &&
+                (h[1] != 0x00 || (id[1] == h[2] && id[2] == h[3])))
+                return &route.handler;
+        }
+        return nullptr;
+    }
+
     inline void
     Dispatcher::
     handle_cc(const SmallMessage& msg)
@@ -3,12 +3,14 @@
 
 #include "synth/midi/config.h"
 #include "synth/midi/dispatcher.h"
+#include "synth/midi/ingress.h"
 #include "synth/midi/layering.h"
 #include "synth/midi/mode-mgr.h"
 #include "synth/midi/note-mgr.h"
 #include "synth/midi/parser.h"
 #include "synth/midi/timbre-mgr.h"
 #include "synth/midi/sizes.h"
+#include "synth/midi/usb.h"
 
 class Assigner;
 class Synth;
@@ -19,6 +21,7 @@ namespace midi {
     // with just `midi::` qualification.
 
     using small_handler = Dispatcher::small_handler;
+    using chunk_handler = Dispatcher::chunk_handler;
     using channel_index = Layering::channel_index;
     using channel_mask = Layering::channel_mask;
     using interface_index = size_t;
@@ -36,6 +39,10 @@ namespace midi {
         // Configuration -- register as a subsystem of ::Config.
         Config& configurator();
 
+        // SYSEX -- the handler sees each message with this ID as
+        // chunks.
+        void register_handler(const SysexID&, const chunk_handler&);
+
         // Parameters
         const size_t polyphony;
         const size_t timbrality;
@@ -64,6 +71,19 @@ namespace midi {
         void process_bytes(interface_index, const char *, size_t);
         void process_message(interface_index, const char *, size_t);
 
+        // USB MIDI event packets, 4 bytes each.  These skip the byte
+        // parser and go straight to the Dispatcher; SYSEX is streamed
+        // through Dispatcher::dispatch_chunk.  All virtual cables are
+        // treated as this interface, and SYSEX is taken from one
+        // cable at a time.
+        void process_usb_packets(interface_index,
+                                 const std::uint8_t *packets,
+                                 size_t count);
+
+        // Input from another thread.  Call at the start of each block
+        // on the audio thread.  The messages are one Dispatcher packet.
+        size_t process_ingress(Ingress&, Ingress::timestamp until);
+
         // Output - TBD
 
     private:
@@ -72,6 +92,7 @@ namespace midi {
             bool is_input;
             bool is_output;
             Parser parser;
+            USBDecoder usb;
 
             interface_data()
             : is_input{false},
@@ -79,6 +100,15 @@ namespace midi {
             {}
         };
 
+        using usb_small_binding =
+            USBDecoder::small_handler::binding<
+                Dispatcher,
+                &Dispatcher::dispatch_message>;
+        using usb_chunk_binding =
+            USBDecoder::chunk_handler::binding<
+                Dispatcher,
+                &Dispatcher::dispatch_chunk>;
+
         bool          m_finalized;
         ::Synth      *m_synth;
         ::Assigner   *m_assigner;
@@ -109,6 +139,10 @@ namespace midi {
         m_dispatcher.attach_layering(m_layering);
         m_note_mgr.attach_dispatcher(m_dispatcher);
         m_timbre_mgr.attach_dispatcher(m_dispatcher);
+        for (auto& iface: m_interfaces) {
+            iface.usb.register_handler(usb_small_binding(&m_dispatcher));
+            iface.usb.register_handler(usb_chunk_binding(&m_dispatcher));
+        }
     }
 
     inline Facade&
@@ -148,6 +182,13 @@ namespace midi {
         return m_config;
     }
 
+    inline void
+    Facade::
+    register_handler(const SysexID& id, const chunk_handler& h)
+    {
+        m_dispatcher.register_handler(id, h);
+    }
+
 
     // -- Interface Configuration -- -- -- -- -- -- -- -- -- -- -- -- - //
 
@@ -182,8 +223,10 @@ namespace midi {
         assert(m_finalized);
         assert(index < m_interfaces.size());
         auto& iface = m_interfaces[index];
-        if (enable && !iface.is_input)
+        if (enable && !iface.is_input) {
             iface.parser.reset();
+            iface.usb.reset();
+        }
         iface.is_input = enable;
     }
 
@@ -310,6 +353,46 @@ namespace midi {
         iface.parser.process_message(data, size);
     }
 
+    inline void
+    Facade::
+    process_usb_packets(interface_index ii,
+                        const std::uint8_t *packets,
+                        size_t count)
+    {
+        assert(m_finalized);
+        assert(ii < MAX_INTERFACES);
+        auto& iface = m_interfaces[ii];
+        assert(iface.is_input);
+        iface.usb.process_packets(packets, count);
+    }
+
+    // Each SYSEX message is whole, so it goes to the Dispatcher as a
+    // single chunk.
+    inline auto
+    Facade::
+    process_ingress(Ingress& ingress, Ingress::timestamp until)
+    -> size_t
+    {
+        assert(m_finalized);
+        m_dispatcher.begin_packet();
+        size_t n = ingress.drain(
+            until,
+            [this] (const Ingress::Event& e) {
+                assert(m_interfaces[e.interface].is_input);
+                m_dispatcher.dispatch_message(e.small);
+            },
+            [this] (const Ingress::Event& e) {
+                assert(m_interfaces[e.interface].is_input);
+                const SysexMessage& msg = *e.sysex;
+                m_dispatcher.dispatch_chunk(
+                    SysexChunk{msg.data,
+                               msg.size,
+                               SysexChunk::BEGIN | SysexChunk::END});
+            });
+        m_dispatcher.end_packet();
+        return n;
+    }
+
 }
 
 #endif /* !MIDI_FACADE_included */
@@ -0,0 +1,199 @@
+#ifndef MIDI_INGRESS_included
+#define MIDI_INGRESS_included
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "synth/midi/messages.h"
+#include "synth/midi/parser.h"
+#include "synth/midi/sizes.h"
+#include "synth/util/spsc-queue.h"
+
+namespace midi {
+
+    // -- Ingress - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+    //
+    // An Ingress carries MIDI input from the thread that reads the
+    // interfaces to the audio thread.  The input thread feeds it raw
+    // bytes with a timestamp; it parses them there and queues the
+    // messages.  The audio thread drains the queue at the start of
+    // each block.  Neither side locks or allocates.
+    //
+    //     // input thread
+    //     ingress.process_bytes(0, now, buf, n);
+    //
+    //     // audio thread, block start
+    //     ingress.drain(block_end, on_small, on_sysex);
+    //
+    // Timestamps are whatever the client counts in (e.g., frames);
+    // Ingress only compares them.  They should not decrease.
+    //
+    // SYSEX messages are copied into one of INGRESS_SYSEX_SLOTS
+    // slots, and the queue carries a pointer.  The audio thread
+    // hands the slot back after its handler returns.  If the queue
+    // or the slots are full, the message is dropped and counted.
+
+    class Ingress {
+
+    public:
+
+        typedef std::uint64_t timestamp;
+
+        struct Event {
+            timestamp           time;
+            std::uint8_t        interface;
+            SmallMessage        small;      // cleared for SYSEX
+            const SysexMessage *sysex;      // null for small messages
+        };
+
+        Ingress();
+        Ingress(const Ingress&) = delete;
+        Ingress& operator = (const Ingress&) = delete;
+
+        // Input Thread
+        void process_bytes(size_t interface,
+                           timestamp,
+                           const char *data,
+                           size_t size);
+        size_t dropped() const;
+
+        // Audio Thread
+
+        // Call small(const Event&) or sysex(const Event&) for each
+        // message stamped at or before `until`, in order.  Returns
+        // the number of messages delivered.
+        template <class SmallFn, class SysexFn>
+        size_t drain(timestamp until, SmallFn small, SysexFn sysex);
+
+        bool empty() const;
+
+    private:
+
+        static const std::uint8_t NO_SLOT = 0xFF;
+
+        void push_small(const SmallMessage&);
+        void push_sysex(const SysexMessage&);
+
+        // Owned by the input thread.
+        std::array<Parser, MAX_INTERFACES> m_parsers;
+        timestamp m_now;
+        std::uint8_t m_interface;
+        std::uint8_t m_spare_slot;
+        std::atomic<size_t> m_dropped;
+
+        spsc_queue<Event, INGRESS_QUEUE_SIZE> m_events;
+        spsc_queue<std::uint8_t, INGRESS_SYSEX_SLOTS> m_free_slots;
+        std::array<SysexMessage, INGRESS_SYSEX_SLOTS> m_sysex_slots;
+
+    };
+
+    inline
+    Ingress::
+    Ingress()
+    : m_now{0},
+      m_interface{0},
+      m_spare_slot{NO_SLOT},
+      m_dropped{0}
+    {
+        static_assert(INGRESS_SYSEX_SLOTS < NO_SLOT, "too many SYSEX slots");
+        for (size_t i = 0; i < INGRESS_SYSEX_SLOTS; i++)
+            m_free_slots.push(i);
+        for (auto& p: m_parsers) {
+            p.register_handler(Parser::small_handler(
+                [this] (const SmallMessage& msg) {
+                    push_small(msg);
+                }));
+            p.register_handler(Parser::sysex_handler(
+                [this] (const SysexMessage& msg) {
+                    push_sysex(msg);
+                }));
+        }
+    }
+
+    inline void
+    Ingress::
+    process_bytes(size_t interface,
+                  timestamp now,
+                  const char *data,
+                  size_t size)
+    {
+        assert(interface < MAX_INTERFACES);
+        m_now = now;
+        m_interface = interface;
+        m_parsers[interface].process_bytes(data, size);
+    }
+
+    inline auto
+    Ingress::
+    dropped() const
+    -> size_t
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    template <class SmallFn, class SysexFn>
+    inline auto
+    Ingress::
+    drain(timestamp until, SmallFn small, SysexFn sysex)
+    -> size_t
+    {
+        size_t n = 0;
+        while (Event *e = m_events.front()) {
+            if (e->time > until)
+                break;
+            if (e->sysex) {
+                sysex(*e);
+                size_t slot = e->sysex - m_sysex_slots.data();
+                m_free_slots.push(slot);
+            } else {
+                small(*e);
+            }
+            m_events.pop();
+            n++;
+        }
+        return n;
+    }
+
+    inline auto
+    Ingress::
+    empty() const
+    -> bool
+    {
+        return m_events.empty();
+    }
+
+    inline void
+    Ingress::
+    push_small(const SmallMessage& msg)
+    {
+        Event e{m_now, m_interface, msg, nullptr};
+        if (!m_events.push(e))
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void
+    Ingress::
+    push_sysex(const SysexMessage& msg)
+    {
+        // Only the audio thread may push free slots, so a slot whose
+        // event could not be queued is kept here for next time.
+        std::uint8_t slot = m_spare_slot;
+        m_spare_slot = NO_SLOT;
+        if (slot == NO_SLOT && !m_free_slots.pop(slot)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_sysex_slots[slot] = msg;
+        Event e{m_now, m_interface, SmallMessage(), &m_sysex_slots[slot]};
+        if (!m_events.push(e)) {
+            m_spare_slot = slot;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+}
+
+#endif /* !MIDI_INGRESS_included */
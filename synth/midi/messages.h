@@ -251,6 +251,12 @@ namespace midi {
 
     };
 
+    // A message and when it happens, e.g., for offline rendering.
+    struct TimedMessage {
+        std::uint64_t frame;
+        SmallMessage  message;
+    };
+
     struct SysexID {
         std::uint8_t data[3];
 
@@ -309,6 +315,28 @@ namespace midi {
         ALL_CALL = 0x7F,
     };
 
+    // A SysexChunk is a piece of a SYSEX message that points into the
+    // caller's input buffer, so it is only valid during the handler
+    // call.  A message is one or more chunks.  The first has BEGIN
+    // set and starts with F0; the last has END set and, unless the
+    // message was cut off by another status byte (ABORT), ends with
+    // F7.  A chunk with neither flag is a continuation.  Chunks may
+    // be empty.
+
+    struct SysexChunk {
+        static const std::uint8_t BEGIN = 1 << 0;
+        static const std::uint8_t END   = 1 << 1;
+        static const std::uint8_t ABORT = 1 << 2;
+
+        const std::uint8_t *data;
+        size_t size;
+        std::uint8_t flags;
+
+        bool is_begin() const { return flags & BEGIN; }
+        bool is_end() const { return flags & END; }
+        bool is_aborted() const { return flags & ABORT; }
+    };
+
     struct SysexMessage {
         size_t size;
         std::uint8_t data[MAX_SYSEX_SIZE];
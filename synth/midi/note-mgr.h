@@ -266,6 +266,10 @@ namespace midi {
         struct voice_data {
             std::uint8_t                channel;
             std::uint8_t                note;
+            voice_index                 channel_prev;
+            voice_index                 channel_next;
+            voice_index                 note_prev;
+            voice_index                 note_next;
             portamento_note_handler     portamento_note_handler;
             note_number_handler         note_number_handler;
             attack_velocity_handler     attack_velocity_handler;
@@ -274,10 +278,23 @@ namespace midi {
 
             voice_data()
             : channel{NO_CHANNEL},
-              note{NO_NOTE}
+              note{NO_NOTE},
+              channel_prev{NO_VOICE},
+              channel_next{NO_VOICE},
+              note_prev{NO_VOICE},
+              note_next{NO_VOICE}
             {}
         };
 
+        // The voice index lists the voices on each channel and on
+        // each (channel, note), as doubly linked lists threaded
+        // through voice_data.  It mirrors voice_data's channel and
+        // note, so set those only through `index_voice`.  Then note
+        // off, pedal release, and poly pressure touch only the voices
+        // involved.  A voice that goes idle on its own stays listed
+        // until it is killed or starts another note.
+        typedef std::array<voice_index, NOTE_COUNT> note_voice_heads;
+
         // NoteManager consumes these MIDI messages.
         void handle_note_on_message(const SmallMessage&);
         void handle_note_off_message(const SmallMessage&);
@@ -302,13 +319,18 @@ namespace midi {
         void pre_release(channel_index, note_start_info&);
         void post_release(channel_index,
                           note_start_info&,
-                          std::uint8_t velocity = DEFAULT_RELEASE_VELOCITY);
-        void release_voices(channel_index, std::uint8_t release_velocity);
+                          std::uint8_t velocity = DEFAULT_RELEASE_VELOCITY,
+                          note_number = NO_NOTE);
+        void release_voices(channel_index,
+                            std::uint8_t release_velocity,
+                            note_number);
 
         ::Voice& vi_to_voice(voice_index);
         voice_index voice_to_vi(::Voice&);
         voice_data& voice_to_data(::Voice&);
 
+        void index_voice(voice_index, channel_index, note_number);
+
         ::Voice *find_existing_voice(channel_index, timbre_index, note_number);
 
         // Member Variables
@@ -318,6 +340,9 @@ namespace midi {
         const Layering                          *m_layering;
         std::array<channel_data, CHANNEL_COUNT>  m_channels;
         fixed_vector<voice_data, MAX_VOICES>     m_voices;
+        std::array<voice_index, CHANNEL_COUNT>   m_channel_voices;
+        std::array<note_voice_heads, CHANNEL_COUNT>
+                                                 m_note_voices;
         fixed_queue<note_start_info, MAX_VOICES> m_pending_notes;
         fixed_queue<::Voice *, MAX_VOICES>       m_killed_voices;
 
@@ -341,7 +366,13 @@ namespace midi {
       m_assigner{nullptr},
       m_dispatcher{nullptr},
       m_layering{nullptr}
-    {}
+    {
+        for (auto& vi: m_channel_voices)
+            vi = NO_VOICE;
+        for (auto& heads: m_note_voices)
+            for (auto& vi: heads)
+                vi = NO_VOICE;
+    }
 
 
     // -- Attach Things -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
@@ -518,14 +549,13 @@ namespace midi {
     NoteManager::
     all_sound_off(channel_index ci)
     {
-        for (auto& voice: m_synth->voices()) {
-            auto& v_data = voice_to_data(voice);
-            if (v_data.channel == ci) {
-                auto state = voice.state();
-                if (state != ::Voice::State::IDLE &&
-                    state != ::Voice::State::STOPPING)
-                    kill_note(voice);
-            }
+        for (auto vi = m_channel_voices[ci]; vi != NO_VOICE; ) {
+            auto& voice = vi_to_voice(vi);
+            vi = m_voices[vi].channel_next;     // kill_note unlinks.
+            auto state = voice.state();
+            if (state != ::Voice::State::IDLE &&
+                state != ::Voice::State::STOPPING)
+                kill_note(voice);
         }
         all_notes_off(ci);
     }
@@ -560,11 +590,12 @@ namespace midi {
     {
         auto& chan = m_channels[ci];
 
-        for (auto& voice: m_synth->voices()) {
-            auto& v_data = voice_to_data(voice);
-            if (v_data.channel == ci)
-                if (auto& h = v_data.poly_pressure_handler)
-                    h(DEFAULT_POLY_PRESSURE);
+        for (auto vi = m_channel_voices[ci];
+             vi != NO_VOICE;
+             vi = m_voices[vi].channel_next)
+        {
+            if (auto& h = m_voices[vi].poly_pressure_handler)
+                h(DEFAULT_POLY_PRESSURE);
         }
 
         chan.velocity_lsb = NO_NOTE;
@@ -628,6 +659,7 @@ namespace midi {
             // We have an idle voice and a pending note.
             // Start the note on the voice.
             auto& note_info = m_pending_notes.front();
+            m_assigner->next_note(note_info.note);
             for (size_t ti = 0; ti < MAX_TIMBRES; ti++) {
                 if (note_info.timbres & (1 << ti)) {
                     start_note(*voice, ti, note_info);
@@ -700,7 +732,7 @@ namespace midi {
         note_start_info resume_info = {};
         pre_release(ci, resume_info);
         chan.notes_on.reset(note);
-        post_release(ci, resume_info, vel);
+        post_release(ci, resume_info, vel, note);
     }
 
     inline void
@@ -710,10 +742,13 @@ namespace midi {
         channel_index ci = msg.channel();
         note_number note = msg.note_number();
         auto pressure = msg.poly_pressure();
-        for (auto& v_data: m_voices)
-            if (v_data.channel == ci && v_data.note == note)
-                if (auto& h = v_data.poly_pressure_handler)
-                    h(pressure);
+        for (auto vi = m_note_voices[ci][note];
+             vi != NO_VOICE;
+             vi = m_voices[vi].note_next)
+        {
+            if (auto& h = m_voices[vi].poly_pressure_handler)
+                h(pressure);
+        }
     }
 
     inline void
@@ -788,6 +823,7 @@ namespace midi {
         auto ci = info.channel;
         auto& chan = m_channels[ci];
         auto timbrality = m_layering->timbrality;
+        m_assigner->next_note(info.note);
         for (size_t ti = 0; ti < timbrality; ti++) {
             if (info.timbres & (1 << ti)) {
                 if (auto *voice = find_existing_voice(ci, ti, info.src_note)) {
@@ -822,8 +858,7 @@ namespace midi {
 
         if (voice.timbre() != &timbre)
             m_synth->attach_voice_to_timbre(timbre, voice);
-        v_data.channel = info.channel;
-        v_data.note = info.note;
+        index_voice(voice_to_vi(voice), info.channel, info.note);
         if (chan.mode == Mode::MONO) {
             chan.mono_voice_hints[ti] = voice_to_vi(voice);
         }
@@ -843,7 +878,7 @@ namespace midi {
     {
         auto& v_data = voice_to_data(voice);
         assert(v_data.channel == info.channel);
-        v_data.note = info.note;
+        index_voice(voice_to_vi(voice), info.channel, info.note);
 
         if (auto& h = v_data.note_number_handler)
             h(info.note);
@@ -861,11 +896,9 @@ namespace midi {
     NoteManager::
     kill_note(::Voice& voice)
     {
-        auto& v_data = voice_to_data(voice);
         voice.kill_note();
         m_killed_voices.push(&voice);
-        v_data.channel = NO_CHANNEL;
-        v_data.note = NO_NOTE;
+        index_voice(voice_to_vi(voice), NO_CHANNEL, NO_NOTE);
     }
 
     inline void
@@ -890,13 +923,14 @@ namespace midi {
     NoteManager::
     post_release(channel_index ci,
                  note_start_info& resume_info,
-                 std::uint8_t release_velocity)
+                 std::uint8_t release_velocity,
+                 note_number released_note)
     {
         auto& chan = m_channels[ci];
         switch (chan.mode) {
 
         case Mode::POLY:
-            release_voices(ci, release_velocity);
+            release_voices(ci, release_velocity, released_note);
             break;
 
         case Mode::MONO:
@@ -914,18 +948,25 @@ namespace midi {
                 }
             }
             if (!resumed)
-                release_voices(ci, release_velocity);
+                release_voices(ci, release_velocity, NO_NOTE);
         }
     }
 
     inline void
     NoteManager::
-    release_voices(channel_index ci, std::uint8_t release_velocity)
+    release_voices(channel_index ci,
+                   std::uint8_t release_velocity,
+                   note_number note)
     {
-        for (auto& voice: m_synth->voices()) {
-            auto& v_data = voice_to_data(voice);
+        // If only one note was released, only its voices can stop.
+        // Otherwise (e.g., a pedal was released) check the channel.
+        bool by_note = note != NO_NOTE;
+        auto vi = by_note ? m_note_voices[ci][note] : m_channel_voices[ci];
+        while (vi != NO_VOICE) {
+            auto& v_data = m_voices[vi];
+            auto& voice = vi_to_voice(vi);
+            vi = by_note ? v_data.note_next : v_data.channel_next;
             if (voice.state() == ::Voice::State::SOUNDING &&
-                v_data.channel == ci &&
                 !m_channels[ci].note_should_sound(v_data.note))
             {
                 if (auto& h = v_data.release_velocity_handler)
@@ -965,13 +1006,16 @@ namespace midi {
             break;
 
         case Mode::POLY:
-            for (auto& voice: m_synth->voices()) {
-                auto& v_data = voice_to_data(voice);
-                if (v_data.channel == ci && v_data.note == note) {
-                    auto ti2 = voice.timbre() - m_synth->timbres().data();
-                    if (ti2 == ti)
-                        return &voice;
-                }
+            if (note == NO_NOTE)
+                break;
+            for (auto vi = m_note_voices[ci][note];
+                 vi != NO_VOICE;
+                 vi = m_voices[vi].note_next)
+            {
+                auto& voice = vi_to_voice(vi);
+                auto ti2 = voice.timbre() - m_synth->timbres().data();
+                if (ti2 == ti)
+                    return &voice;
                 // XXX ensure there is only one voice that matches.
             }
             break;
@@ -1005,6 +1049,56 @@ namespace midi {
         return m_voices[voice_to_vi(voice)];
     }
 
+    inline void
+    NoteManager::
+    index_voice(voice_index vi, channel_index ci, note_number note)
+    {
+        auto& v_data = m_voices[vi];
+
+        // Unlink from the old lists.
+        if (v_data.channel != NO_CHANNEL) {
+            auto& c_head = m_channel_voices[v_data.channel];
+            if (v_data.channel_prev == NO_VOICE)
+                c_head = v_data.channel_next;
+            else
+                m_voices[v_data.channel_prev].channel_next =
+                    v_data.channel_next;
+            if (v_data.channel_next != NO_VOICE)
+                m_voices[v_data.channel_next].channel_prev =
+                    v_data.channel_prev;
+            if (v_data.note != NO_NOTE) {
+                auto& n_head = m_note_voices[v_data.channel][v_data.note];
+                if (v_data.note_prev == NO_VOICE)
+                    n_head = v_data.note_next;
+                else
+                    m_voices[v_data.note_prev].note_next = v_data.note_next;
+                if (v_data.note_next != NO_VOICE)
+                    m_voices[v_data.note_next].note_prev = v_data.note_prev;
+            }
+        }
+        v_data.channel_prev = v_data.channel_next = NO_VOICE;
+        v_data.note_prev = v_data.note_next = NO_VOICE;
+
+        v_data.channel = ci;
+        v_data.note = note;
+
+        // Link into the new ones, at the front.
+        if (ci != NO_CHANNEL) {
+            auto& c_head = m_channel_voices[ci];
+            v_data.channel_next = c_head;
+            if (c_head != NO_VOICE)
+                m_voices[c_head].channel_prev = vi;
+            c_head = vi;
+            if (note != NO_NOTE) {
+                auto& n_head = m_note_voices[ci][note];
+                v_data.note_next = n_head;
+                if (n_head != NO_VOICE)
+                    m_voices[n_head].note_prev = vi;
+                n_head = vi;
+            }
+        }
+    }
+
 }
 
 #endif /* !MIDI_NOTE_MGR_included */
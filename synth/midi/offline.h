@@ -0,0 +1,77 @@
+#ifndef MIDI_OFFLINE_included
+#define MIDI_OFFLINE_included
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "synth/core/sizes.h"
+#include "synth/midi/messages.h"
+
+namespace midi {
+
+    // -- Offline Rendering  -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+    //
+    // Helpers for the offline renderers, PartRenderer and RenderFarm.
+    //
+    // `run_in_parallel` calls `work(i)` for each i below `count` on
+    // up to `threads` threads, 0 meaning one per hardware thread.
+    // Each thread takes the next i until there are none left.  The
+    // calling thread is one of them.
+    //
+    // `render_chunks` renders `frame_count` frames in chunks of at
+    // most MAX_FRAMES.  Before each chunk it calls `deliver(message)`
+    // for the messages that are due, then `render(chunk_size)`.
+    // Chunks are split at messages so each lands on its frame.
+
+    template <class Work>
+    inline void
+    run_in_parallel(size_t count, unsigned threads, Work work)
+    {
+        if (!threads)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        threads = std::max<size_t>(std::min<size_t>(threads, count), 1);
+
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            size_t i;
+            while ((i = next++) < count)
+                work(i);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; i++)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& t: pool)
+            t.join();
+    }
+
+    template <class Deliver, class Render>
+    inline void
+    render_chunks(const TimedMessage *messages,
+                  size_t message_count,
+                  size_t frame_count,
+                  Deliver deliver,
+                  Render render)
+    {
+        const TimedMessage *msg = messages;
+        const TimedMessage *end = msg + message_count;
+        for (size_t frame = 0, chunk_size; frame < frame_count;
+             frame += chunk_size) {
+
+            for ( ; msg < end && msg->frame <= frame; msg++)
+                deliver(msg->message);
+
+            chunk_size = std::min<size_t>(MAX_FRAMES, frame_count - frame);
+            if (msg < end && msg->frame - frame < chunk_size)
+                chunk_size = msg->frame - frame;
+
+            render(chunk_size);
+        }
+    }
+
+}
+
+#endif /* !MIDI_OFFLINE_included */
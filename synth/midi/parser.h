@@ -3,12 +3,14 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <stdexcept>
 
 #include "synth/midi/defs.h"
 #include "synth/midi/messages.h"
 #include "synth/midi/sizes.h"
+#include "synth/util/function.h"
 
 namespace midi {
 
@@ -19,24 +21,69 @@ namespace midi {
         typedef std::function<void(const SmallMessage&)> small_handler;
         typedef std::function<void(const SysexMessage&)> sysex_handler;
 
+        // A batch handler receives up to BATCH_SIZE small messages
+        // per call.  If one is registered, it replaces the small
+        // handler.  Batches are delivered before any SYSEX message
+        // that follows them and at the end of each `process_*` call.
+        typedef function<void(const SmallMessage *, size_t)> batch_handler;
+
+        static const size_t BATCH_SIZE = 32;
+
+        // A chunk handler receives SYSEX messages as they arrive, as
+        // SysexChunks pointing into the caller's buffer.  Nothing is
+        // copied, and there is no size limit.  If one is registered,
+        // it replaces the SYSEX handler.
+        typedef function<void(const SysexChunk&)> chunk_handler;
+
         Parser()
         : m_small_handler{nullptr},
           m_sysex_handler{nullptr},
-          m_state{NO}
+          m_state{NO},
+          m_batch_count{0},
+          m_chunk_begin{nullptr},
+          m_chunk_flags{0}
         {}
 
         void register_handler(small_handler h) { m_small_handler = h; }
         void register_handler(sysex_handler h) { m_sysex_handler = h; }
+        void register_handler(batch_handler h) { m_batch_handler = h; }
+        void register_handler(chunk_handler h) { m_chunk_handler = h; }
 
         void process_byte(char byte)
         {
-            parse_byte(byte);
+            process_bytes(&byte, 1);
         }
 
         void process_bytes(const char *bytes, size_t count)
         {
-            for (size_t i = 0; i < count; i++)
-                parse_byte(bytes[i]);
+            auto *p = reinterpret_cast<const std::uint8_t *>(bytes);
+            auto *end = p + count;
+            begin_buffer(p);
+            for ( ; p < end; p++)
+                parse_byte_at(p);
+            end_buffer(end);
+        }
+
+        // process_bulk is equivalent to process_bytes, but faster on
+        // large buffers (e.g., replayed captures or file data).  Most
+        // of a dense stream is runs of data bytes under running
+        // status.  Those are found eight bytes at a time and turned
+        // into messages in a tight loop; only status bytes go through
+        // the state machine.
+        void process_bulk(const char *bytes, size_t count)
+        {
+            auto *p = reinterpret_cast<const std::uint8_t *>(bytes);
+            auto *end = p + count;
+            begin_buffer(p);
+            while (p < end) {
+                if (m_state == C31 || m_state == C21)
+                    p = parse_channel_run(p, data_run_end(p, end));
+                else if (m_state == SX && m_chunk_handler)
+                    p = data_run_end(p, end);
+                if (p < end)
+                    parse_byte_at(p++);
+            }
+            end_buffer(end);
         }
 
         // These messages do not use running status.
@@ -72,6 +119,16 @@ namespace midi {
                 auto e = static_cast<StatusByte>(msg[count - 1]);
                 if (state != SX || e != StatusByte::EOX)
                     goto malformed;
+                if (m_chunk_handler) {
+                    for (size_t i = 1; i < count - 1; i++)
+                        if (msg[i] & 0x80)
+                            goto malformed;
+                    auto *data = reinterpret_cast<const std::uint8_t *>(msg);
+                    emit_chunk(data, data + count, SysexChunk::BEGIN |
+                                                   SysexChunk::END);
+                    reset();
+                    return;
+                }
                 SysexMessage sysex;
                 for (size_t i = 0; i < count; i++) {
                     if (i && i < count - 1 && msg[i] & 0x80)
@@ -81,6 +138,7 @@ namespace midi {
                 emit_sysex_msg(sysex);
             }
             reset();            // can't interleave messages and bytes.
+            flush_batch();
         }
 
         void reset()
@@ -88,6 +146,7 @@ namespace midi {
             m_state = NO;
             m_msg.clear();
             m_sysex_msg.clear();
+            m_chunk_flags = 0;
         }
 
     private:
@@ -108,9 +167,15 @@ namespace midi {
 
         small_handler m_small_handler;
         sysex_handler m_sysex_handler;
+        batch_handler m_batch_handler;
         State m_state;
         SmallMessage m_msg;
         SysexMessage m_sysex_msg;
+        chunk_handler m_chunk_handler;
+        size_t m_batch_count;
+        SmallMessage m_batch[BATCH_SIZE];
+        const std::uint8_t *m_chunk_begin;
+        std::uint8_t m_chunk_flags;
 
         static const State s_state_table[128];
 
@@ -224,18 +289,132 @@ namespace midi {
             }
         }
 
+        // In chunk mode, a SYSEX message in progress continues at the
+        // start of each buffer, and the part in this buffer is
+        // emitted at its end.
+        void begin_buffer(const std::uint8_t *p)
+        {
+            m_chunk_begin = p;
+        }
+
+        void end_buffer(const std::uint8_t *end)
+        {
+            if (m_chunk_handler && m_state == SX)
+                emit_chunk(m_chunk_begin, end, m_chunk_flags);
+            flush_batch();
+        }
+
+        // parse_byte, plus SYSEX chunking.  The chunk in progress runs
+        // from m_chunk_begin up to p.  Real time messages split it,
+        // EOX ends it, and any other status byte aborts it.
+        void parse_byte_at(const std::uint8_t *p)
+        {
+            std::uint8_t c = *p;
+            if (!m_chunk_handler)
+                return parse_byte(c);
+            if (!(c & 0x80)) {
+                if (m_state != SX)
+                    parse_byte(c);
+                return;
+            }
+            if (m_state == SX) {
+                State s = s_state_table[c & 0x7F];
+                if (s == RT || s == URT) {
+                    emit_chunk(m_chunk_begin, p, m_chunk_flags);
+                    parse_byte(c);
+                    m_chunk_begin = p + 1;
+                } else if (s == EX) {
+                    emit_chunk(m_chunk_begin, p + 1,
+                               m_chunk_flags | SysexChunk::END);
+                    m_state = NO;
+                } else {
+                    emit_chunk(m_chunk_begin, p,
+                               m_chunk_flags |
+                               SysexChunk::END |
+                               SysexChunk::ABORT);
+                    m_state = NO;
+                    parse_byte_at(p);
+                }
+            } else if (s_state_table[c & 0x7F] == SX) {
+                m_state = SX;
+                m_chunk_begin = p;
+                m_chunk_flags = SysexChunk::BEGIN;
+            } else {
+                parse_byte(c);
+            }
+        }
+
+        // The end of the run of data bytes starting at p.
+        static const std::uint8_t *data_run_end(const std::uint8_t *p,
+                                                const std::uint8_t *end)
+        {
+            const std::uint64_t STATUS_BITS = 0x8080808080808080;
+            while (end - p >= 8) {
+                std::uint64_t w;
+                std::memcpy(&w, p, sizeof w);
+                if (w & STATUS_BITS)
+                    break;
+                p += 8;
+            }
+            while (p < end && !(*p & 0x80))
+                p++;
+            return p;
+        }
+
+        // Emit every complete running status message in [p, end),
+        // starting at a message boundary.  Returns the first byte not
+        // used; any leftover data byte goes through parse_byte.
+        const std::uint8_t *parse_channel_run(const std::uint8_t *p,
+                                              const std::uint8_t *end)
+        {
+            const std::uint8_t s = m_msg.status_byte;
+            if (m_state == C31) {
+                for ( ; end - p >= 2; p += 2)
+                    emit_msg(SmallMessage(s, p[0], p[1]));
+            } else {
+                for ( ; p < end; p++)
+                    emit_msg(SmallMessage(s, p[0]));
+            }
+            return p;
+        }
+
         void emit_msg(const SmallMessage& msg)
         {
-            if (m_small_handler)
+            if (m_batch_handler) {
+                m_batch[m_batch_count++] = msg;
+                if (m_batch_count == BATCH_SIZE)
+                    flush_batch();
+            } else if (m_small_handler)
                 m_small_handler(msg);
         }
 
+        void emit_chunk(const std::uint8_t *begin,
+                        const std::uint8_t *end,
+                        std::uint8_t flags)
+        {
+            if (begin == end && !flags)
+                return;
+            flush_batch();
+            SysexChunk chunk{begin, size_t(end - begin), flags};
+            m_chunk_handler(chunk);
+            m_chunk_flags = 0;
+        }
+
         void emit_sysex_msg(const SysexMessage& msg)
         {
+            flush_batch();
             if (m_sysex_handler)
                 m_sysex_handler(msg);
         }
 
+        void flush_batch()
+        {
+            if (m_batch_count) {
+                m_batch_handler(m_batch, m_batch_count);
+                m_batch_count = 0;
+            }
+        }
+
     };
 
     const Parser::State Parser::s_state_table[128] = {
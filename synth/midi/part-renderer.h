@@ -0,0 +1,169 @@
+#ifndef MIDI_PART_RENDERER_included
+#define MIDI_PART_RENDERER_included
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "synth/core/config.h"
+#include "synth/core/defs.h"
+#include "synth/core/recorder.h"
+#include "synth/core/synth.h"
+#include "synth/midi/layering.h"
+#include "synth/midi/messages.h"
+#include "synth/midi/offline.h"
+
+namespace midi {
+
+    // -- Part Renderer -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+    //
+    // A PartRenderer renders a MIDI performance offline with one
+    // thread per part.  A part is one timbre of the Layering.  Each
+    // part gets its own Target instance, sees only the messages on
+    // the channels that play its timbre (and system messages), and
+    // renders only its timbre and that timbre's voices.  The parts
+    // are summed in timbre order at the end, so the output doesn't
+    // depend on the thread count.
+    //
+    // Target must have
+    //
+    //     template <class OutputModule>
+    //     Target(const ::Config&, OutputModule& output);
+    //     Synth& synth();
+    //     void process_message(const SmallMessage&);
+    //
+    // and Target instances must not share mutable state.  Since each
+    // part has the whole polyphony to itself, voice stealing may
+    // differ from a render with a single synth.
+
+    template <class Target>
+    class PartRenderer {
+
+    public:
+
+        typedef DEFAULT_SAMPLE_TYPE sample_type;
+
+        typedef TimedMessage Event;
+
+        PartRenderer(const ::Config&, const Layering&);
+        PartRenderer(const PartRenderer&) = delete;
+        PartRenderer& operator = (const PartRenderer&) = delete;
+
+        // 0 (the default) means one thread per hardware thread.
+        PartRenderer& thread_count(unsigned);
+
+        // Render frame_count frames into out.  Events must be sorted
+        // by frame.
+        void render(const Event *events,
+                    size_t event_count,
+                    sample_type *out,
+                    size_t frame_count);
+
+    private:
+
+        bool in_part(Layering::timbre_index, const SmallMessage&) const;
+        void render_part(Layering::timbre_index,
+                         const Event *events,
+                         size_t event_count,
+                         sample_type *buffer,
+                         size_t frame_count) const;
+
+        const ::Config& m_config;
+        const Layering& m_layering;
+        unsigned m_thread_count;
+
+    };
+
+
+    template <class Target>
+    inline
+    PartRenderer<Target>::
+    PartRenderer(const ::Config& cfg, const Layering& layering)
+    : m_config(cfg),
+      m_layering(layering),
+      m_thread_count{0}
+    {}
+
+    template <class Target>
+    inline auto
+    PartRenderer<Target>::
+    thread_count(unsigned n)
+    -> PartRenderer&
+    {
+        m_thread_count = n;
+        return *this;
+    }
+
+    template <class Target>
+    inline void
+    PartRenderer<Target>::
+    render(const Event *events,
+           size_t event_count,
+           sample_type *out,
+           size_t frame_count)
+    {
+        const size_t part_count = m_layering.timbrality;
+        std::vector<std::vector<sample_type>> buffers(
+            part_count,
+            std::vector<sample_type>(frame_count));
+
+        run_in_parallel(part_count, m_thread_count, [&] (size_t part) {
+            render_part(part,
+                        events, event_count,
+                        buffers[part].data(), frame_count);
+        });
+
+        // Mix in a fixed order.
+        std::fill(out, out + frame_count, sample_type(0));
+        for (const auto& buf: buffers)
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] += buf[i];
+    }
+
+    template <class Target>
+    inline auto
+    PartRenderer<Target>::
+    in_part(Layering::timbre_index part, const SmallMessage& msg) const
+    -> bool
+    {
+        if (!msg.is_channel_message())
+            return true;
+        return m_layering.timbre_channels(part) & 1 << msg.channel();
+    }
+
+    template <class Target>
+    inline void
+    PartRenderer<Target>::
+    render_part(Layering::timbre_index part,
+                const Event *events,
+                size_t event_count,
+                sample_type *buffer,
+                size_t frame_count) const
+    {
+        // The synth clones the output module for each timbre, but
+        // only the part's timbre is rendered.
+        Recorder out(buffer, frame_count);
+        Target target(m_config, out);
+        Synth& synth = target.synth();
+        Timbre& timbre = synth.timbres()[part];
+
+        render_chunks(
+            events, event_count, frame_count,
+            [&] (const SmallMessage& msg) {
+                if (in_part(part, msg))
+                    target.process_message(msg);
+            },
+            [&] (size_t chunk_size) {
+                timbre.pre_render(chunk_size);
+                const auto& voices = timbre.attached_voices();
+                for (size_t vi = 0; vi < synth.voices().size(); vi++)
+                    if (voices.test(vi))
+                        synth.voices()[vi].render(chunk_size);
+                timbre.post_render(chunk_size);
+            });
+    }
+
+}
+
+#endif /* !MIDI_PART_RENDERER_included */
@@ -0,0 +1,232 @@
+#ifndef MIDI_RENDER_FARM_included
+#define MIDI_RENDER_FARM_included
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "synth/core/config.h"
+#include "synth/core/recorder.h"
+#include "synth/core/synth.h"
+#include "synth/midi/messages.h"
+#include "synth/midi/offline.h"
+
+namespace midi {
+
+    // -- Render Farm -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- - //
+    //
+    // A RenderFarm renders a batch of jobs on a pool of threads, one
+    // Target (synth) per job, and reports each job's output hash and
+    // the aggregate throughput.
+    //
+    // A job is a list of timed messages, a patch number, an
+    // optional saved plan, and a length.  Jobs point to their
+    // messages and plans, so many jobs can share one parsed file,
+    // and jobs with the same patch can share the plan `save_plan`
+    // made and skip the Planner.  All jobs share the farm's Config,
+    // which is the place for other immutable data like tables:
+    // register it as a Config subsystem and the modules find it when
+    // they configure.  targets/offline/farm.cpp reads MIDI files into
+    // jobs.
+    //
+    // Target must have
+    //
+    //     template <class OutputModule>
+    //     Target(const ::Config&, OutputModule& output);
+    //     Synth& synth();
+    //     void select_patch(size_t patch,
+    //                       const std::uint8_t *plan,  // may be null
+    //                       size_t plan_size);
+    //     void process_message(const SmallMessage&);
+    //
+    // `select_patch` is called once, before any message.  It applies
+    // the patch to timbre 0 with the saved plan, or with the Planner
+    // if there is none or it does not match.  Target instances must
+    // not share mutable state.  Then each job's output depends only
+    // on the job, so hashes can be compared across runs.
+
+    template <class Target>
+    class RenderFarm {
+
+    public:
+
+        typedef DEFAULT_SAMPLE_TYPE sample_type;
+
+        struct Job {
+            std::string         name;
+            const TimedMessage *messages;   // sorted by frame
+            size_t              message_count;
+            size_t              patch;
+            size_t              frame_count;
+            const std::uint8_t *plan;       // saved plan or null
+            size_t              plan_size;
+        };
+
+        struct Result {
+            std::uint64_t       hash;       // FNV-1a of the samples
+            double              seconds;    // job's render time
+            std::vector<sample_type> output;    // if keep_output
+        };
+
+        struct Report {
+            std::vector<Result> results;    // in job order
+            std::uint64_t       frames;
+            double              seconds;    // wall clock
+
+            double frames_per_second() const
+            {
+                return seconds ? frames / seconds : 0;
+            }
+        };
+
+        RenderFarm(const ::Config&);
+        RenderFarm(const RenderFarm&) = delete;
+        RenderFarm& operator = (const RenderFarm&) = delete;
+
+        // 0 (the default) means one thread per hardware thread.
+        RenderFarm& thread_count(unsigned);
+
+        // Keep each job's samples in its result.
+        RenderFarm& keep_output(bool);
+
+        Report run(const std::vector<Job>&) const;
+
+        // Plan a patch once, for jobs to share.
+        std::vector<std::uint8_t> save_plan(size_t patch) const;
+
+        static std::uint64_t hash(const sample_type *, size_t count);
+
+    private:
+
+        void render_job(const Job&, Result&) const;
+
+        const ::Config& m_config;
+        unsigned m_thread_count;
+        bool m_keep_output;
+
+    };
+
+    template <class Target>
+    inline
+    RenderFarm<Target>::
+    RenderFarm(const ::Config& cfg)
+    : m_config(cfg),
+      m_thread_count{0},
+      m_keep_output{false}
+    {}
+
+    template <class Target>
+    inline auto
+    RenderFarm<Target>::
+    thread_count(unsigned n)
+    -> RenderFarm&
+    {
+        m_thread_count = n;
+        return *this;
+    }
+
+    template <class Target>
+    inline auto
+    RenderFarm<Target>::
+    keep_output(bool keep)
+    -> RenderFarm&
+    {
+        m_keep_output = keep;
+        return *this;
+    }
+
+    template <class Target>
+    inline auto
+    RenderFarm<Target>::
+    run(const std::vector<Job>& jobs) const
+    -> Report
+    {
+        Report report;
+        report.results.resize(jobs.size());
+        report.frames = 0;
+        for (const auto& job: jobs)
+            report.frames += job.frame_count;
+
+        auto t0 = std::chrono::steady_clock::now();
+        run_in_parallel(jobs.size(), m_thread_count, [&] (size_t i) {
+            render_job(jobs[i], report.results[i]);
+        });
+
+        std::chrono::duration<double> dt =
+            std::chrono::steady_clock::now() - t0;
+        report.seconds = dt.count();
+        return report;
+    }
+
+    template <class Target>
+    inline auto
+    RenderFarm<Target>::
+    save_plan(size_t patch) const
+    -> std::vector<std::uint8_t>
+    {
+        Recorder out(nullptr, 0);
+        Target target(m_config, out);
+        target.select_patch(patch, nullptr, 0);
+        const Synth& synth = target.synth();
+        const Timbre& timbre = synth.timbres().front();
+        std::vector<std::uint8_t> plan(synth.save_plan(timbre, nullptr, 0));
+        synth.save_plan(timbre, plan.data(), plan.size());
+        return plan;
+    }
+
+    template <class Target>
+    inline auto
+    RenderFarm<Target>::
+    hash(const sample_type *samples, size_t count)
+    -> std::uint64_t
+    {
+        std::uint64_t h = 0xcbf29ce484222325;
+        const unsigned char *p =
+            reinterpret_cast<const unsigned char *>(samples);
+        for (size_t i = 0; i < count * sizeof *samples; i++) {
+            h ^= p[i];
+            h *= 0x100000001b3;
+        }
+        return h;
+    }
+
+    template <class Target>
+    inline void
+    RenderFarm<Target>::
+    render_job(const Job& job, Result& result) const
+    {
+        auto t0 = std::chrono::steady_clock::now();
+
+        std::vector<sample_type> output(job.frame_count);
+        Recorder out(output.data(), output.size());
+        Target target(m_config, out);
+        target.select_patch(job.patch, job.plan, job.plan_size);
+        Synth& synth = target.synth();
+
+        render_chunks(
+            job.messages, job.message_count, job.frame_count,
+            [&] (const SmallMessage& msg) {
+                target.process_message(msg);
+            },
+            [&] (size_t chunk_size) {
+                for (auto& t: synth.timbres())
+                    t.pre_render(chunk_size);
+                for (auto& v: synth.voices())
+                    v.render(chunk_size);
+                for (auto& t: synth.timbres())
+                    t.post_render(chunk_size);
+            });
+
+        result.hash = hash(output.data(), output.size());
+        if (m_keep_output)
+            result.output.swap(output);
+        std::chrono::duration<double> dt =
+            std::chrono::steady_clock::now() - t0;
+        result.seconds = dt.count();
+    }
+
+}
+
+#endif /* !MIDI_RENDER_FARM_included */
@@ -28,6 +28,7 @@ namespace midi {
 
     // 409 is a good size.
     // That is the size of a KEY-BASED TUNING DUMP message.
+    // Longer messages can be received as SysexChunks instead.
     #ifndef MIDI_MAX_SYSEX_SIZE
     #define MIDI_MAX_SYSEX_SIZE 10
     #endif
@@ -40,6 +41,29 @@ namespace midi {
     #endif
     static const size_t MAX_SYSEX_IDS = MIDI_MAX_SYSEX_IDS;
 
+    // Number of distinct channel/controller pairs whose continuous
+    // messages a Dispatcher packet can hold back and coalesce.
+    // When it fills, the held messages are delivered early.
+    #ifndef MIDI_MAX_COALESCED
+    #define MIDI_MAX_COALESCED 32
+    #endif
+    static const size_t MAX_COALESCED = MIDI_MAX_COALESCED;
+
+    // Number of timestamped messages an Ingress queue holds between
+    // the MIDI input thread and the audio thread.  Must be a power
+    // of two.
+    #ifndef MIDI_INGRESS_QUEUE_SIZE
+    #define MIDI_INGRESS_QUEUE_SIZE 256
+    #endif
+    static const size_t INGRESS_QUEUE_SIZE = MIDI_INGRESS_QUEUE_SIZE;
+
+    // Number of SYSEX messages an Ingress can have in flight.  Must
+    // be a power of two.
+    #ifndef MIDI_INGRESS_SYSEX_SLOTS
+    #define MIDI_INGRESS_SYSEX_SLOTS 4
+    #endif
+    static const size_t INGRESS_SYSEX_SLOTS = MIDI_INGRESS_SYSEX_SLOTS;
+
     // Number of MIDI interfaces.  Each is an in/out pair.
     #ifndef MIDI_MAX_INTERFACES
     #define MIDI_MAX_INTERFACES 4
@@ -2,6 +2,14 @@
 
 #include <cxxtest/TestSuite.h>
 
+#include "synth/midi/dispatcher.h"
+#include "synth/midi/layering.h"
+
+using midi::ControllerNumber;
+using midi::Dispatcher;
+using midi::Layering;
+using midi::SmallMessage;
+
 class midi_controls_unit_test : public CxxTest::TestSuite {
 
 public:
@@ -9,6 +17,148 @@ public:
     void test_instantiate()
     {
         (void)midi::NoteFreqControl();
+        (void)midi::AttackVelocityControl();
+        (void)midi::ReleaseVelocityControl();
+        (void)midi::PolyPressureControl();
+        (void)midi::ChannelPressureControl();
+        (void)midi::PitchBendControl();
+        (void)midi::Modulation();
+        (void)midi::RPNControl<0, 1>();
+        (void)midi::NRPNControl<1, 8>();
+    }
+
+    static ::Config config()
+    {
+        ::Config cfg;
+        cfg.set_sample_rate(1000);
+        return cfg;
+    }
+
+    void test_note_freq()
+    {
+        midi::NoteFreqControl c;
+        c.configure(config());
+        c.handle_note_number(69);
+        c.start_note();
+        c.render(MAX_FRAMES);
+        for (size_t i = 0; i < MAX_FRAMES; i++)
+            TS_ASSERT_DELTA(c.out[i], 440, 0.01);
+
+        // Bend up two semitones; the frequency rises smoothly.
+        c.handle_pitch_bend(8191);
+        float prev = 440;
+        for (size_t b = 0; b < 100; b++) {
+            c.render(MAX_FRAMES);
+            for (size_t i = 0; i < MAX_FRAMES; i++) {
+                TS_ASSERT_LESS_THAN_EQUALS(prev, c.out[i]);
+                prev = c.out[i];
+            }
+        }
+        TS_ASSERT_DELTA(c.out[MAX_FRAMES - 1], 493.88, 0.05);
+    }
+
+    void test_portamento()
+    {
+        midi::NoteFreqControl c;
+        c.configure(config());
+        c.portamento_time(0.008);
+        c.handle_note_number(81);
+        c.handle_portamento_note(69);
+        c.start_note();
+        c.render(4);
+        TS_ASSERT_LESS_THAN(440, c.out[0]);
+        TS_ASSERT_DELTA(c.out[3], 622.25, 0.05);
+        c.render(4);
+        TS_ASSERT_DELTA(c.out[3], 880, 0.05);
+
+        // Without a portamento note, a new note starts on pitch.
+        c.handle_note_number(57);
+        c.start_note();
+        c.render(4);
+        TS_ASSERT_DELTA(c.out[0], 220, 0.05);
+    }
+
+    void test_retune()
+    {
+        midi::Tuning t;
+        t.freq(69, 432);
+        midi::NoteFreqControl c;
+        c.configure(config());
+        c.handle_note_number(69);
+        c.start_note();
+        c.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(c.out[0], 440, 0.01);
+        c.tuning(t);
+        c.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(c.out[0], 432, 0.01);
+    }
+
+    void test_velocity()
+    {
+        midi::AttackVelocityControl c;
+        c.configure(config());
+        c.handle_attack_velocity(127 << 7 | 127);
+        c.start_note();
+        c.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(c.out[0], 1);
+        c.handle_attack_velocity(0);
+        c.start_note();
+        c.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(c.out[0], 0);
+    }
+
+    void test_pitch_bend()
+    {
+        midi::PitchBendControl c;
+        c.configure(config());
+        c.handle_pitch_bend(-8192);
+        for (size_t b = 0; b < 100; b++)
+            c.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(c.out[0], -1);
+        TS_ASSERT(c.smoother().is_constant());
+    }
+
+    // A 14 bit CC pairs its MSB and LSB.
+    void test_cc()
+    {
+        Layering l(1);
+        Dispatcher d;
+        d.attach_layering(l);
+        midi::Modulation c;
+        c.configure(config());
+        c.smoother().curve(Smoother::Curve::STEP);
+        auto h = Dispatcher::small_handler::binding<
+                     midi::Modulation,
+                     &midi::Modulation::handle_message
+                 >(&c);
+        d.register_handler(ControllerNumber::MOD_WHEEL_MSB, 1, h);
+        d.register_handler(ControllerNumber::MOD_WHEEL_LSB, 1, h);
+
+        d.dispatch_message(SmallMessage(0xB0, 1, 127));
+        c.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(c.out[0], 1);
+
+        d.dispatch_message(SmallMessage(0xB0, 1, 64));
+        c.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(c.out[0], (64 << 7 | 64) / 16383.0, 1e-6);
+
+        d.dispatch_message(SmallMessage(0xB0, 33, 0));
+        c.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(c.out[0], (64 << 7) / 16383.0, 1e-6);
+
+        d.dispatch_message(SmallMessage(0xB0, 33, 127));
+        c.render(MAX_FRAMES);
+        TS_ASSERT_DELTA(c.out[0], (64 << 7 | 127) / 16383.0, 1e-6);
+    }
+
+    void test_seven_bit_cc()
+    {
+        midi::CCControl<74> c;
+        c.configure(config());
+        c.smoother().curve(Smoother::Curve::STEP);
+        c.handle_message(SmallMessage(0xB0, 74, 127));
+        c.render(MAX_FRAMES);
+        TS_ASSERT_EQUALS(c.out[0], 1);
     }
 
 };
@@ -4,6 +4,8 @@
 
 #include <cxxtest/TestSuite.h>
 
+#include "synth/midi/parser.h"
+
 using midi::Dispatcher;
 using midi::CHANNEL_COUNT;
 using midi::StatusByte;
@@ -365,6 +367,229 @@ public:
         TS_ASSERT_EQUALS(log(), "[FC]");
     }
 
+    void test_packet_coalesces_controllers()
+    {
+        Layering l(1);
+        l.multi_mode();
+        Dispatcher d;
+        d.attach_layering(l);
+        d.register_handler(ControllerNumber::MOD_WHEEL_MSB,
+                           l.all_timbres,
+                           small_logger);
+        d.register_handler(ControllerNumber::BREATH_CONTROLLER_MSB,
+                           l.all_timbres,
+                           small_logger);
+        d.register_handler(StatusByte::PITCH_BEND, 0x0001, small_logger);
+
+        log.clear();
+        d.begin_packet();
+        for (std::uint8_t v = 0; v < 100; v++) {
+            dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, v);
+            dispatch_cc(d, 0, ControllerNumber::BREATH_CONTROLLER_MSB, v);
+            d.dispatch_message(SmallMessage(0xE0, 0x00, v));
+        }
+        TS_ASSERT_EQUALS(log(), "");
+        d.end_packet();
+        TS_ASSERT_EQUALS(log(), "[B0 1 63][B0 2 63][E0 0 63]");
+
+        // Outside a packet, every message is delivered.
+        log.clear();
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, 1);
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, 2);
+        TS_ASSERT_EQUALS(log(), "[B0 1 1][B0 1 2]");
+    }
+
+    void test_packet_drops_stale_LSB()
+    {
+        Layering l(1);
+        l.multi_mode();
+        Dispatcher d;
+        d.attach_layering(l);
+        d.register_handler(ControllerNumber::MOD_WHEEL_MSB,
+                           l.all_timbres,
+                           small_logger);
+        d.register_handler(ControllerNumber::MOD_WHEEL_LSB,
+                           l.all_timbres,
+                           small_logger);
+
+        // The new MSB's LSB arrives in the next packet.
+        log.clear();
+        d.begin_packet();
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, 0x10);
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_LSB, 0x11);
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, 0x20);
+        d.end_packet();
+        TS_ASSERT_EQUALS(log(), "[B0 1 20]");
+        d.begin_packet();
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_LSB, 0x21);
+        d.end_packet();
+        TS_ASSERT_EQUALS(log(), "[B0 1 20][B0 21 21]");
+    }
+
+    void test_packet_orders_new_pair()
+    {
+        Layering l(1);
+        l.multi_mode();
+        Dispatcher d;
+        d.attach_layering(l);
+        d.register_handler(ControllerNumber::MOD_WHEEL_MSB,
+                           l.all_timbres,
+                           small_logger);
+        d.register_handler(ControllerNumber::MOD_WHEEL_LSB,
+                           l.all_timbres,
+                           small_logger);
+
+        // The old MSB's LSB and a new pair share a packet.  The new
+        // pair is still delivered MSB first.
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, 0x10);
+        log.clear();
+        d.begin_packet();
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_LSB, 0x11);
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_MSB, 0x20);
+        dispatch_cc(d, 0, ControllerNumber::MOD_WHEEL_LSB, 0x21);
+        d.end_packet();
+        TS_ASSERT_EQUALS(log(), "[B0 1 20][B0 21 21]");
+    }
+
+    void test_packet_keeps_order()
+    {
+        Layering l(1);
+        l.multi_mode();
+        Dispatcher d;
+        d.attach_layering(l);
+        d.register_handler(StatusByte::NOTE_ON, 0x0001, small_logger);
+        d.register_handler(StatusByte::PITCH_BEND, 0x0001, small_logger);
+        d.register_handler(StatusByte::TIMING_CLOCK, small_logger);
+        d.register_handler(ControllerNumber::DAMPER_PEDAL,
+                           l.all_timbres,
+                           small_logger);
+
+        // The bend before the note is delivered before the note.
+        // The clock does not wait.  Pedals are never merged.
+        log.clear();
+        d.begin_packet();
+        d.dispatch_message(SmallMessage(0xE0, 0x00, 0x10));
+        d.dispatch_message(SmallMessage(0xE0, 0x00, 0x20));
+        d.dispatch_message(SmallMessage(StatusByte::TIMING_CLOCK));
+        d.dispatch_message(SmallMessage(0x90, 0x3C, 0x40));
+        d.dispatch_message(SmallMessage(0xE0, 0x00, 0x30));
+        dispatch_cc(d, 0, ControllerNumber::DAMPER_PEDAL, 0x7F);
+        dispatch_cc(d, 0, ControllerNumber::DAMPER_PEDAL, 0x00);
+        d.dispatch_message(SmallMessage(0xE0, 0x00, 0x40));
+        d.end_packet();
+        TS_ASSERT_EQUALS(log(),
+                         "[F8][E0 0 20][90 3C 40][E0 0 30]"
+                         "[B0 40 7F][B0 40 0][E0 0 40]");
+    }
+
+    void test_packet_RPN_is_exact()
+    {
+        ParameterValue pv(1234);
+        Layering l(1);
+        l.multi_mode();
+        Dispatcher d;
+        d.attach_layering(l);
+        d.register_handler(RPN::FINE_TUNING, l.all_timbres, xRPN_logger);
+
+        log.clear();
+        d.begin_packet();
+        select_RPN(d, 0, RPN::FINE_TUNING);
+        dispatch_cc(d, 0, ControllerNumber::DATA_ENTRY_LSB, pv.lsb());
+        dispatch_cc(d, 0, ControllerNumber::DATA_ENTRY_MSB, pv.msb());
+        dispatch_cc(d, 0, ControllerNumber::DATA_INCREMENT, 0);
+        dispatch_cc(d, 0, ControllerNumber::DATA_INCREMENT, 0);
+        d.end_packet();
+        TS_ASSERT_EQUALS(log(), "{0/1: 1234}{0/1: 1235}{0/1: 1236}");
+    }
+
+    void test_packet_overflow()
+    {
+        Layering l(1);
+        l.multi_mode();
+        Dispatcher d;
+        d.attach_layering(l);
+        d.register_handler(StatusByte::POLY_KEY_PRESSURE,
+                           0x0001,
+                           small_logger);
+
+        // More distinct keys than can be held: all are delivered.
+        log.clear();
+        d.begin_packet();
+        for (size_t i = 0; i < 2 * midi::MAX_COALESCED + 1; i++)
+            d.dispatch_message(SmallMessage(0xA0, i, 0x01));
+        d.end_packet();
+        size_t count = 0;
+        for (char c: log())
+            count += c == '[';
+        TS_ASSERT_EQUALS(count, 2 * midi::MAX_COALESCED + 1);
+    }
+
+    void log_chunk(const midi::SysexChunk& chunk)
+    {
+        auto f = log.ss.flags();
+        log.ss << std::hex << std::uppercase
+               << (chunk.is_begin() ? "<" : "(");
+        for (size_t i = 0; i < chunk.size; i++)
+            log.ss << (i ? " " : "") << unsigned(chunk.data[i]);
+        log.ss << (chunk.is_end() ? ">" : ")");
+        log.ss.flags(f);
+    }
+
+    using chunk_handler = Dispatcher::chunk_handler;
+    using log_chunk_binding =
+        chunk_handler::binding<dispatcher_unit_test,
+                               &dispatcher_unit_test::log_chunk>;
+
+    void dispatch_chunk(Dispatcher& d,
+                        const char *data,
+                        size_t size,
+                        std::uint8_t flags)
+    {
+        auto *p = reinterpret_cast<const std::uint8_t *>(data);
+        d.dispatch_chunk(midi::SysexChunk{p, size, flags});
+    }
+
+    void test_dispatch_sysex_chunks()
+    {
+        using midi::SysexChunk;
+        using midi::SysexID;
+        const std::uint8_t B = SysexChunk::BEGIN, E = SysexChunk::END;
+        Dispatcher d;
+        d.register_handler(SysexID::NON_COMMERCIAL,
+                           chunk_handler(log_chunk_binding(this)));
+        d.register_handler(SysexID(0x00, 0x20, 0x33),
+                           chunk_handler(log_chunk_binding(this)));
+
+        // Whole message
+        log.clear();
+        dispatch_chunk(d, "\xF0\x7D\1\2\xF7", 5, B | E);
+        TS_ASSERT_EQUALS(log(), "<F0 7D)(1 2 F7>");
+
+        // Three byte ID split across chunks
+        log.clear();
+        dispatch_chunk(d, "\xF0\x00", 2, B);
+        dispatch_chunk(d, "\x20", 1, 0);
+        dispatch_chunk(d, "\x33\1", 2, 0);
+        dispatch_chunk(d, "\2\xF7", 2, E);
+        TS_ASSERT_EQUALS(log(), "<F0 0 20 33)(1)(2 F7>");
+
+        // Unregistered ID
+        log.clear();
+        dispatch_chunk(d, "\xF0\x41\1\2\xF7", 5, B | E);
+        dispatch_chunk(d, "\xF0\x00\x20\x34\xF7", 5, B | E);
+        TS_ASSERT_EQUALS(log(), "");
+
+        // Through the parser
+        midi::Parser p;
+        p.register_handler(midi::Parser::chunk_handler(
+            chunk_handler::binding<Dispatcher, &Dispatcher::dispatch_chunk>
+                (&d)));
+        log.clear();
+        p.process_bytes("\xF0\x7D\1", 3);
+        p.process_bytes("\2\3\xF7", 3);
+        TS_ASSERT_EQUALS(log(), "<F0 7D)(1)(2 3 F7>");
+    }
+
     // void test_dispatch_sysex_message()
     // {
     //     //Dispatcher d;
@@ -1,5 +1,7 @@
 #include "facade.h"
 
+#include <string>
+
 #include <cxxtest/TestSuite.h>
 
 #include "synth/core/assigners.h"
@@ -35,4 +37,37 @@ public:
          .finalize();
     }
 
+    std::string chunk_log;
+
+    void log_chunk(const midi::SysexChunk& chunk)
+    {
+        chunk_log += chunk.is_begin() ? "<" : "(";
+        chunk_log += std::to_string(chunk.size);
+        chunk_log += chunk.is_end() ? ">" : ")";
+    }
+
+    typedef midi::chunk_handler::binding<facade_unit_test,
+                                         &facade_unit_test::log_chunk>
+            log_chunk_binding;
+
+    void test_ingress_sysex()
+    {
+        Synth s("Foo", 1, 1);
+        FooAssigner a;
+        Facade f(1, 1);
+        f.attach(s)
+         .attach(a)
+         .finalize();
+        f.interface_is_input(0, true);
+        f.register_handler(midi::SysexID::NON_COMMERCIAL,
+                           log_chunk_binding(this));
+
+        midi::Ingress in;
+        const char msg[] = "\xF0\x7D\x01\x02\xF7";
+        in.process_bytes(0, 0, msg, 5);
+        chunk_log.clear();
+        TS_ASSERT_EQUALS(f.process_ingress(in, 0), 1u);
+        TS_ASSERT_EQUALS(chunk_log, "<2)(3>");
+    }
+
 };
@@ -0,0 +1,128 @@
+#include "ingress.h"
+
+#include <sstream>
+#include <thread>
+
+#include <cxxtest/TestSuite.h>
+
+using midi::Ingress;
+using midi::SmallMessage;
+using midi::SysexMessage;
+
+class ingress_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    std::ostringstream log;
+
+    size_t drain(Ingress& in, Ingress::timestamp until)
+    {
+        return in.drain(
+            until,
+            [this] (const Ingress::Event& e) {
+                log << std::hex << std::uppercase
+                    << e.time << '/' << unsigned(e.interface) << '['
+                    << unsigned(e.small.status_byte) << ' '
+                    << unsigned(e.small.data_byte_1) << ']';
+            },
+            [this] (const Ingress::Event& e) {
+                log << std::hex << std::uppercase
+                    << e.time << '/' << unsigned(e.interface) << '<';
+                for (size_t i = 0; i < e.sysex->size; i++)
+                    log << (i ? " " : "") << unsigned(e.sysex->data[i]);
+                log << '>';
+            });
+    }
+
+    void test_instantiate()
+    {
+        Ingress in;
+        TS_ASSERT(in.empty());
+        TS_TRACE("sizeof Ingress = " + std::to_string(sizeof in));
+    }
+
+    void test_timestamps()
+    {
+        Ingress in;
+        const char a[] = "\x90\x3C\x40\x3E\x40";  // running status
+        const char b[] = "\xB1\x01\x22";
+        in.process_bytes(0, 10, a, 5);
+        in.process_bytes(1, 20, b, 3);
+
+        log.str("");
+        TS_ASSERT_EQUALS(drain(in, 9), 0u);
+        TS_ASSERT_EQUALS(drain(in, 10), 2u);
+        TS_ASSERT_EQUALS(log.str(), "A/0[90 3C]A/0[90 3E]");
+        TS_ASSERT(!in.empty());
+
+        log.str("");
+        TS_ASSERT_EQUALS(drain(in, 100), 1u);
+        TS_ASSERT_EQUALS(log.str(), "14/1[B1 1]");
+        TS_ASSERT(in.empty());
+    }
+
+    void test_sysex()
+    {
+        Ingress in;
+        const char msg[] = "\xF0\x7D\x01\xF7";
+        for (size_t i = 0; i < midi::INGRESS_SYSEX_SLOTS + 1; i++)
+            in.process_bytes(0, i, msg, 4);
+        TS_ASSERT_EQUALS(in.dropped(), 1u);
+
+        log.str("");
+        TS_ASSERT_EQUALS(drain(in, 0), 1u);
+        TS_ASSERT_EQUALS(log.str(), "0/0<F0 7D 1 F7>");
+
+        // The slots are returned.
+        drain(in, 100);
+        for (size_t i = 0; i < midi::INGRESS_SYSEX_SLOTS; i++)
+            in.process_bytes(0, i, msg, 4);
+        TS_ASSERT_EQUALS(in.dropped(), 1u);
+    }
+
+    void test_overflow()
+    {
+        Ingress in;
+        const char msg[] = "\xF8";
+        for (size_t i = 0; i < midi::INGRESS_QUEUE_SIZE + 3; i++)
+            in.process_bytes(0, 0, msg, 1);
+        TS_ASSERT_EQUALS(in.dropped(), 3u);
+        log.str("");
+        TS_ASSERT_EQUALS(drain(in, 0), midi::INGRESS_QUEUE_SIZE);
+    }
+
+    void test_threads()
+    {
+        static const unsigned COUNT = 16000;
+        static Ingress in;
+        std::thread producer([] {
+            for (unsigned i = 0; i < COUNT; i++) {
+                char msg[3] = {
+                    char(0xB0),
+                    char(i >> 7 & 0x7F),
+                    char(i & 0x7F),
+                };
+                in.process_bytes(0, i, msg, 3);
+                if (i % 100 == 99)
+                    while (!in.empty())
+                        continue;   // never overflow
+            }
+        });
+        unsigned expected = 0;
+        bool in_order = true;
+        while (expected < COUNT)
+            in.drain(
+                ~Ingress::timestamp(0),
+                [&] (const Ingress::Event& e) {
+                    unsigned v = e.small.data_byte_1 << 7 |
+                                 e.small.data_byte_2;
+                    in_order &= v == expected && e.time == expected;
+                    expected++;
+                },
+                [] (const Ingress::Event&) {});
+        producer.join();
+        TS_ASSERT(in_order);
+        TS_ASSERT_EQUALS(in.dropped(), 0u);
+    }
+
+};
@@ -659,6 +659,52 @@ public:
         TS_ASSERT_EQUALS(log(), "N60 A8256 s N62 P60 N60 P62 R32 r ");
     }
 
+    // test the voice index: poly pressure and note off touch only
+    // their note's voices; damper release checks the channel.
+
+    void test_voice_index()
+    {
+        size_t POLY = 3, TIMB = 1;
+        pile_of_stuff pos(POLY, TIMB);
+        auto& m = pos.m;
+
+        pos.d.dispatch_message(SmallMessage(0x90, 60, 64));
+        pos.d.dispatch_message(SmallMessage(0x90, 62, 64));
+        pos.d.dispatch_message(SmallMessage(0x90, 64, 64));
+        auto v62 = m.m_note_voices[0][62];
+        TS_ASSERT_DIFFERS(v62, NoteManager::voice_index(~0));
+        TS_ASSERT_EQUALS(m.m_voices[v62].note, 62);
+        TS_ASSERT_EQUALS(m.m_voices[v62].note_next,
+                         NoteManager::voice_index(~0));
+        TS_ASSERT_EQUALS(m.m_note_voices[1][62],
+                         NoteManager::voice_index(~0));
+
+        log.clear();
+        pos.d.dispatch_message(SmallMessage(0xA0, 62, 99));
+        TS_ASSERT_EQUALS(log(), "K99 ");
+
+        log.clear();
+        pos.d.dispatch_message(SmallMessage(0xB0, 64, 127));
+        pos.d.dispatch_message(SmallMessage(0x80, 60, 10));
+        pos.d.dispatch_message(SmallMessage(0x80, 62, 10));
+        TS_ASSERT_EQUALS(log(), "");
+        pos.d.dispatch_message(SmallMessage(0xB0, 64, 0));
+        TS_ASSERT_EQUALS(log(), "R0 r R0 r ");
+
+        log.clear();
+        pos.d.dispatch_message(SmallMessage(0x80, 64, 20));
+        TS_ASSERT_EQUALS(log(), "R20 r ");
+
+        // All sound off on the channel kills its voices, which empties
+        // its lists.  (None of them went idle on its own; those would
+        // be listed until killed or reused.)
+        m.all_sound_off(0);
+        TS_ASSERT_EQUALS(m.m_channel_voices[0],
+                         NoteManager::voice_index(~0));
+        TS_ASSERT_EQUALS(m.m_note_voices[0][64],
+                         NoteManager::voice_index(~0));
+    }
+
     // mode-independent tests
     //  reset all controllers
     //  high res velocity
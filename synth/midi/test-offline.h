@@ -0,0 +1,60 @@
+#include "offline.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+using midi::SmallMessage;
+using midi::TimedMessage;
+
+class offline_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_run_in_parallel()
+    {
+        const size_t N = 100;
+        for (unsigned threads = 0; threads <= 4; threads++) {
+            std::vector<std::atomic<unsigned>> calls(N);
+            for (auto& c: calls)
+                c = 0;
+            midi::run_in_parallel(N, threads, [&] (size_t i) {
+                calls[i]++;
+            });
+            for (size_t i = 0; i < N; i++)
+                TS_ASSERT_EQUALS(calls[i].load(), 1u);
+        }
+        // Nothing to do is fine.
+        unsigned called = 0;
+        midi::run_in_parallel(0, 4, [&] (size_t) { called++; });
+        TS_ASSERT_EQUALS(called, 0u);
+    }
+
+    void test_render_chunks()
+    {
+        const TimedMessage messages[] = {
+            { 0, SmallMessage(0xB0, 7, 1) },
+            { 1, SmallMessage(0xB0, 7, 2) },
+            { 1, SmallMessage(0xB0, 7, 3) },
+            { MAX_FRAMES + 2, SmallMessage(0xB0, 7, 4) },
+            { 1000 * MAX_FRAMES, SmallMessage(0xB0, 7, 5) },
+        };
+        std::string log;
+        midi::render_chunks(
+            messages, 5, 2 * MAX_FRAMES + 2,
+            [&] (const SmallMessage& msg) {
+                log += "m" + std::to_string(msg.data_byte_2) + " ";
+            },
+            [&] (size_t n) {
+                log += std::to_string(n) + " ";
+            });
+
+        // Chunks are split at frames 1 and MAX_FRAMES + 2.  The last
+        // message is past the end.
+        const std::string mf = std::to_string(MAX_FRAMES);
+        TS_ASSERT_EQUALS(log, "m1 1 m2 m3 " + mf + " 1 m4 " + mf + " ");
+    }
+
+};
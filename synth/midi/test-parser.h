@@ -207,6 +207,144 @@ public:
         }
     }
 
+    static void log_batch(void *, const SmallMessage *msgs, size_t count)
+    {
+        TS_ASSERT(count > 0);
+        TS_ASSERT(count <= Parser::BATCH_SIZE);
+        for (size_t i = 0; i < count; i++)
+            log_msg(msgs[i]);
+    }
+
+    void test_process_bulk()
+    {
+        const char bytes[] =
+            "\x90\x3C\x40\x3E\x40\x40\x40"      // note on x 3
+            "\xF8"                              // timing clock
+            "\x42\x40\x43"                      // note on, half
+            "\xF0\x7D\x01\xF7"                  // sysex
+            "\xD2\x01\x02\x03"                  // channel pressure
+            "\xB0\x07\x10\xF8\x07\x11\x07";     // CC w/ clock
+        const size_t size = sizeof bytes - 1;
+        const char *expected =
+            "[0x90 60 64][0x90 62 64][0x90 64 64][0xF8][0x90 66 64]"
+            "<F0 7D 1 F7>[0xD2 1][0xD2 2][0xD2 3]"
+            "[0xB0 7 16][0xF8][0xB0 7 17]";
+
+        Parser p;
+        p.register_handler(log_msg);
+        p.register_handler(log_sysex_msg);
+        log.clear();
+        p.process_bulk(bytes, size);
+        TS_ASSERT_EQUALS(log(), expected);
+
+        // Same, split at every boundary, through a batch handler.
+        p.register_handler(Parser::batch_handler(log_batch, nullptr));
+        for (size_t split = 0; split <= size; split++) {
+            p.reset();
+            log.clear();
+            p.process_bulk(bytes, split);
+            p.process_bulk(bytes + split, size - split);
+            TS_ASSERT_EQUALS(log(), expected);
+        }
+    }
+
+    void test_bulk_matches_bytes()
+    {
+        // Mostly channel messages, with some of everything else.
+        std::string stream;
+        srandom(456);
+        for (int i = 0; i < 100000; i++) {
+            long r = random();
+            if (r % 5 == 0)
+                stream += char(0x80 | (r >> 8 & 0x7F));
+            else
+                stream += char(r >> 8 & 0x7F);
+        }
+
+        Parser p;
+        p.register_handler(log_msg);
+        p.register_handler(log_sysex_msg);
+        log.clear();
+        p.process_bytes(stream.data(), stream.size());
+        std::string by_byte = log();
+
+        Parser q;
+        q.register_handler(log_sysex_msg);
+        q.register_handler(Parser::batch_handler(log_batch, nullptr));
+        log.clear();
+        for (size_t i = 0; i < stream.size(); i += 1000)
+            q.process_bulk(stream.data() + i, 1000);
+        TS_ASSERT(by_byte == log());
+        TS_ASSERT(by_byte.size() > 100000);
+    }
+
+    static void log_chunk(void *, const midi::SysexChunk& chunk)
+    {
+        auto f = log.ss.flags();
+        log.ss << std::hex << std::uppercase
+               << (chunk.is_begin() ? "<" : "(");
+        for (size_t i = 0; i < chunk.size; i++)
+            log.ss << (i ? " " : "") << unsigned(chunk.data[i]);
+        log.ss << (chunk.is_aborted() ? "!" : "")
+               << (chunk.is_end() ? ">" : ")");
+        log.ss.flags(f);
+    }
+
+    void test_sysex_chunks()
+    {
+        struct ccase {
+            const char *in;
+            size_t size;
+            size_t split;
+            const char *out;
+        };
+        static const ccase cases[] = {
+
+            // one chunk
+            { "\xF0\1\2\3\xF7", 5, 5, "<F0 1 2 3 F7>" },
+
+            // two chunks
+            { "\xF0\1\2\3\xF7", 5, 2, "<F0 1)(2 3 F7>" },
+
+            // split just after F0 and just before F7
+            { "\xF0\1\2\3\xF7", 5, 1, "<F0)(1 2 3 F7>" },
+            { "\xF0\1\2\3\xF7", 5, 4, "<F0 1 2 3)(F7>" },
+
+            // split by a real time message
+            { "\xF0\1\xF8\2\xF7", 5, 5, "<F0 1)[0xF8](2 F7>" },
+
+            // cut off by a status byte
+            { "\xF0\1\2\x90\3\4", 6, 6, "<F0 1 2!>[0x90 3 4]" },
+
+            // back to back
+            { "\xF0\1\xF7\xF0\2\xF7", 6, 4, "<F0 1 F7><F0)(2 F7>" },
+
+        };
+
+        Parser p;
+        p.register_handler(log_msg);
+        p.register_handler(log_sysex_msg);
+        p.register_handler(Parser::chunk_handler(log_chunk, nullptr));
+        for (const auto& c: cases) {
+            log.clear();
+            p.process_bytes(c.in, c.split);
+            p.process_bulk(c.in + c.split, c.size - c.split);
+            TS_ASSERT_EQUALS(log(), c.out);
+        }
+
+        // A message much longer than MAX_SYSEX_SIZE.
+        std::string dump = "\xF0\x7D";
+        dump += std::string(1000, '\x55');
+        dump += "\xF7";
+        log.clear();
+        p.process_bulk(dump.data(), dump.size());
+        TS_ASSERT_EQUALS(log().size(), 3 * dump.size() + 1);
+
+        log.clear();
+        p.process_message(dump.data(), dump.size());
+        TS_ASSERT_EQUALS(log().size(), 3 * dump.size() + 1);
+    }
+
     void test_reset()
     {
         Parser p;
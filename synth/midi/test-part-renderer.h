@@ -0,0 +1,127 @@
+#include "part-renderer.h"
+
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/synth.h"
+
+using midi::Layering;
+using midi::SmallMessage;
+
+class part_renderer_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    static const size_t POLY = 2;
+    static const size_t TIMB = 3;
+
+    // Outputs a constant level.
+    class Level : public ModuleType<Level> {
+    public:
+        Level()
+        : level{0}
+        {
+            out.name("out");
+            ports(out);
+        }
+        Output<> out;
+        float level;
+        void render(size_t frame_count)
+        {
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] = level;
+        }
+    };
+
+    // Every message sets every timbre's level, so a message that
+    // reaches the wrong part is heard.
+    class LevelTarget {
+    public:
+        template <class OutputModule>
+        LevelTarget(const Config& cfg, OutputModule& out)
+        : m_synth{"Level", POLY, TIMB}
+        {
+            m_synth.add_timbre_module(m_level)
+                   .add_timbre_module(out, true)
+                   .finalize(cfg);
+            m_patch.connect(out.in, m_level.out);
+            for (auto& t: m_synth.timbres())
+                m_synth.apply_patch(m_patch, t);
+        }
+        Synth& synth() { return m_synth; }
+        void process_message(const SmallMessage& msg)
+        {
+            for (auto& t: m_synth.timbres())
+                static_cast<Level *>(t.modules()[0])->level =
+                    msg.data_byte_2;
+        }
+    private:
+        Level m_level;
+        Patch m_patch;
+        Synth m_synth;
+    };
+
+    typedef midi::PartRenderer<LevelTarget> renderer;
+
+    static SmallMessage cc(std::uint8_t chan, std::uint8_t value)
+    {
+        return SmallMessage(0xB0 | chan, 7, value);
+    }
+
+    Config cfg;
+
+    part_renderer_unit_test()
+    {
+        cfg.set_sample_rate(44100);
+    }
+
+    void test_instantiate()
+    {
+        Layering l(TIMB);
+        (void)renderer(cfg, l);
+    }
+
+    void test_render()
+    {
+        Layering l(TIMB);
+        l.multi_mode();
+        const renderer::Event events[] = {
+            { 0, cc(0, 1) },
+            { 3, cc(1, 10) },
+            { 5, cc(2, 100) },
+            { 6, cc(9, 50) },           // no timbre
+            { 7, cc(0, 2) },
+        };
+        const size_t n = sizeof events / sizeof *events;
+        const float expected[] = {
+            1, 1, 1, 11, 11, 111, 111, 112, 112, 112,
+        };
+        const size_t frames = sizeof expected / sizeof *expected;
+
+        for (unsigned threads = 1; threads <= TIMB + 1; threads++) {
+            std::vector<float> out(frames, -1);
+            renderer(cfg, l).thread_count(threads)
+                            .render(events, n, out.data(), frames);
+            for (size_t i = 0; i < frames; i++)
+                TS_ASSERT_EQUALS(out[i], expected[i]);
+        }
+    }
+
+    void test_layered_channel()
+    {
+        // Channel 0 plays timbres 0 and 2; it reaches both parts.
+        Layering l(TIMB);
+        l.multi_mode();
+        l.channel_timbres(0, 0b101);
+        const renderer::Event events[] = {
+            { 2, cc(0, 3) },
+        };
+        std::vector<float> out(4);
+        renderer(cfg, l).render(events, 1, out.data(), out.size());
+        TS_ASSERT_EQUALS(out, std::vector<float>({0, 0, 6, 6}));
+    }
+
+};
@@ -0,0 +1,172 @@
+#include "render-farm.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/recorder.h"
+#include "synth/core/synth.h"
+
+using midi::SmallMessage;
+using midi::TimedMessage;
+
+class render_farm_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    // Outputs level + offset.
+    class Level : public ModuleType<Level> {
+    public:
+        Level()
+        : level{0},
+          offset{0}
+        {
+            out.name("out");
+            ports(out);
+        }
+        Output<> out;
+        float level;
+        float offset;
+        void render(size_t frame_count)
+        {
+            for (size_t i = 0; i < frame_count; i++)
+                out[i] = level + offset;
+        }
+    };
+
+    // The patch number sets the offset; messages set the level.  A
+    // saved plan that does not match falls back to the Planner.
+    class LevelTarget {
+    public:
+        template <class OutputModule>
+        LevelTarget(const Config& cfg, OutputModule& out)
+        : m_synth{"Level", 1, 1},
+          m_used_saved_plan{false}
+        {
+            m_synth.add_timbre_module(m_level)
+                   .add_timbre_module(out, true)
+                   .finalize(cfg);
+            m_patch.connect(out.in, m_level.out);
+        }
+        Synth& synth() { return m_synth; }
+        void select_patch(size_t n,
+                          const std::uint8_t *plan,
+                          size_t plan_size)
+        {
+            Timbre& t = m_synth.timbres().front();
+            if (plan)
+                m_used_saved_plan =
+                    m_synth.apply_saved_plan(m_patch, t, plan, plan_size);
+            if (!m_used_saved_plan)
+                m_synth.apply_patch(m_patch, t);
+            m_level.offset = n;
+        }
+        void process_message(const SmallMessage& msg)
+        {
+            m_level.level = msg.data_byte_2;
+        }
+        bool used_saved_plan() const { return m_used_saved_plan; }
+    private:
+        Level m_level;
+        Patch m_patch;
+        Synth m_synth;
+        bool m_used_saved_plan;
+    };
+
+    typedef midi::RenderFarm<LevelTarget> farm;
+
+    Config cfg;
+    std::vector<TimedMessage> messages;
+    std::vector<farm::Job> jobs;
+
+    render_farm_unit_test()
+    {
+        cfg.set_sample_rate(44100);
+        messages = {
+            { 1, SmallMessage(0xB0, 7, 10) },
+            { 6, SmallMessage(0xB0, 7, 20) },
+        };
+        // Jobs share the messages.
+        for (size_t i = 0; i < 8; i++)
+            jobs.push_back(farm::Job{
+                "job" + std::to_string(i),
+                messages.data(),
+                messages.size(),
+                i % 3,
+                8 + i,
+                nullptr,
+                0,
+            });
+    }
+
+    void test_instantiate()
+    {
+        (void)farm(cfg);
+    }
+
+    void test_output()
+    {
+        auto report = farm(cfg).keep_output(true).run(jobs);
+        TS_ASSERT_EQUALS(report.results.size(), jobs.size());
+        TS_ASSERT_EQUALS(report.frames, 8u * 8 + 28);
+        TS_ASSERT(report.frames_per_second() > 0);
+
+        const auto& r = report.results[2];
+        const std::vector<float> expected = {
+            2, 12, 12, 12, 12, 12, 22, 22, 22, 22,
+        };
+        TS_ASSERT_EQUALS(r.output, expected);
+        TS_ASSERT_EQUALS(r.hash, farm::hash(expected.data(), 10));
+    }
+
+    void test_deterministic()
+    {
+        auto one = farm(cfg).thread_count(1).run(jobs);
+        TS_ASSERT(one.results[0].output.empty());
+        for (unsigned n = 2; n <= 4; n++) {
+            auto many = farm(cfg).thread_count(n).run(jobs);
+            for (size_t i = 0; i < jobs.size(); i++)
+                TS_ASSERT_EQUALS(many.results[i].hash, one.results[i].hash);
+        }
+        // Different patches, different hashes.
+        TS_ASSERT_DIFFERS(one.results[0].hash, one.results[1].hash);
+    }
+
+    void test_saved_plan()
+    {
+        auto plan = farm(cfg).save_plan(0);
+        TS_ASSERT(!plan.empty());
+        std::vector<float> buf(MAX_FRAMES);
+        Recorder rec(buf.data(), buf.size());
+
+        // Another target can use the plan.
+        {
+            LevelTarget t(cfg, rec);
+            t.select_patch(0, plan.data(), plan.size());
+            TS_ASSERT(t.used_saved_plan());
+        }
+
+        // A damaged plan falls back to the Planner.
+        {
+            LevelTarget t(cfg, rec);
+            t.select_patch(0, plan.data(), plan.size() - 1);
+            TS_ASSERT(!t.used_saved_plan());
+        }
+
+        // Jobs that share the plan render the same samples.
+        auto planned = farm(cfg).run(jobs);
+        auto shared = jobs;
+        for (auto& job: shared) {
+            job.plan = plan.data();
+            job.plan_size = plan.size();
+        }
+        auto saved = farm(cfg).run(shared);
+        for (size_t i = 0; i < jobs.size(); i++)
+            TS_ASSERT_EQUALS(saved.results[i].hash,
+                             planned.results[i].hash);
+    }
+
+};
@@ -0,0 +1,114 @@
+#include "tuning.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+using midi::Tuning;
+
+class tuning_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)Tuning();
+    }
+
+    void test_equal_temperament()
+    {
+        const Tuning& et = Tuning::equal_temperament();
+        TS_ASSERT_DELTA(et.freq(std::uint8_t(69)), 440, 1e-3);
+        TS_ASSERT_DELTA(et.freq(std::uint8_t(57)), 220, 1e-3);
+        TS_ASSERT_DELTA(et.freq(std::uint8_t(60)), 261.626, 1e-3);
+        for (int i = 0; i < 128; i++)
+            TS_ASSERT_DELTA(et.freq(std::uint8_t(i)),
+                            440 * std::pow(2, (i - 69) / 12.0),
+                            1e-4 * et.freq(std::uint8_t(i)));
+    }
+
+    // Fractional pitches interpolate exponentially.
+    void test_fractional()
+    {
+        const Tuning& et = Tuning::equal_temperament();
+        for (float p = 20; p < 120; p += 0.013) {
+            float expected = 440 * std::pow(2, (p - 69) / 12.0);
+            TS_ASSERT_DELTA(et.freq(p) / expected, 1, 2e-5);
+        }
+        TS_ASSERT_DELTA(et.freq(69.5f), 452.893, 1e-2);
+        TS_ASSERT_DELTA(et.freq(-3.0f), et.freq(std::uint8_t(0)), 1e-6);
+    }
+
+    static std::vector<std::uint8_t> bulk_dump(std::uint8_t program)
+    {
+        // Tune every key a quarter tone sharp, except leave key 0.
+        std::vector<std::uint8_t> msg{0xF0, 0x7E, 0x7F, 0x08, 0x01};
+        msg.push_back(program);
+        const char *name = "quarter sharp   ";
+        for (size_t i = 0; i < 16; i++)
+            msg.push_back(name[i]);
+        for (int i = 0; i < 3; i++)
+            msg.push_back(0x7F);
+        for (int i = 1; i < 128; i++) {
+            msg.push_back(i);
+            msg.push_back(0x40);    // 0.5 semitone
+            msg.push_back(0x00);
+        }
+        std::uint8_t sum = 0;
+        for (size_t i = 1; i < msg.size(); i++)
+            sum ^= msg[i];
+        msg.push_back(sum & 0x7F);
+        msg.push_back(0xF7);
+        return msg;
+    }
+
+    void test_bulk_dump()
+    {
+        auto msg = bulk_dump(3);
+        TS_ASSERT_EQUALS(msg.size(), Tuning::BULK_DUMP_SIZE);
+        Tuning t;
+        TS_ASSERT(t.apply_sysex(msg.data(), msg.size()));
+        TS_ASSERT_EQUALS(t.program(), 3);
+        TS_ASSERT_EQUALS(std::strcmp(t.name(), "quarter sharp   "), 0);
+        TS_ASSERT_DELTA(t.freq(std::uint8_t(69)), 452.893, 1e-2);
+        TS_ASSERT_EQUALS(t.freq(std::uint8_t(0)),
+                         Tuning::equal_temperament().freq(std::uint8_t(0)));
+
+        // bad checksum
+        msg[100] ^= 1;
+        Tuning u;
+        TS_ASSERT(!u.apply_sysex(msg.data(), msg.size()));
+        TS_ASSERT_EQUALS(u.freq(std::uint8_t(69)), 440);
+    }
+
+    void test_single_note()
+    {
+        Tuning t;
+        // A4 -> A5, on program 0
+        std::uint8_t msg[] = {
+            0xF0, 0x7F, 0x7F, 0x08, 0x02, 0x00, 0x01,
+            69, 81, 0x00, 0x00,
+            0xF7,
+        };
+        TS_ASSERT(t.apply_sysex(msg, sizeof msg));
+        TS_ASSERT_DELTA(t.freq(std::uint8_t(69)), 880, 1e-2);
+
+        // wrong program
+        msg[5] = 1;
+        msg[8] = 57;
+        TS_ASSERT(!t.apply_sysex(msg, sizeof msg));
+        TS_ASSERT_DELTA(t.freq(std::uint8_t(69)), 880, 1e-2);
+
+        // bank form
+        std::uint8_t bank_msg[] = {
+            0xF0, 0x7E, 0x7F, 0x08, 0x07, 0x00, 0x00, 0x01,
+            69, 57, 0x00, 0x00,
+            0xF7,
+        };
+        TS_ASSERT(t.apply_sysex(bank_msg, sizeof bank_msg));
+        TS_ASSERT_DELTA(t.freq(std::uint8_t(69)), 220, 1e-2);
+    }
+
+};
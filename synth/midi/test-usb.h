@@ -0,0 +1,149 @@
+#include "usb.h"
+
+#include <sstream>
+
+#include <cxxtest/TestSuite.h>
+
+using midi::SmallMessage;
+using midi::SysexChunk;
+using midi::USBDecoder;
+
+class usb_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    std::ostringstream log;
+
+    void log_small(const SmallMessage& msg)
+    {
+        log << std::hex << std::uppercase
+            << '[' << unsigned(msg.status_byte);
+        if (msg.data_byte_1 != SmallMessage::NO_DATA) {
+            log << ' ' << unsigned(msg.data_byte_1);
+            if (msg.data_byte_2 != SmallMessage::NO_DATA)
+                log << ' ' << unsigned(msg.data_byte_2);
+        }
+        log << ']';
+    }
+
+    void log_chunk(const SysexChunk& chunk)
+    {
+        log << std::hex << std::uppercase
+            << (chunk.is_begin() ? "<" : "(");
+        for (size_t i = 0; i < chunk.size; i++)
+            log << (i ? " " : "") << unsigned(chunk.data[i]);
+        log << (chunk.is_aborted() ? "!" : "")
+            << (chunk.is_end() ? ">" : ")");
+    }
+
+    using log_small_binding =
+        USBDecoder::small_handler::binding<usb_unit_test,
+                                           &usb_unit_test::log_small>;
+    using log_chunk_binding =
+        USBDecoder::chunk_handler::binding<usb_unit_test,
+                                           &usb_unit_test::log_chunk>;
+
+    std::string decode(const std::uint8_t *packets, size_t count)
+    {
+        USBDecoder d;
+        d.register_handler(log_small_binding(this));
+        d.register_handler(log_chunk_binding(this));
+        log.str("");
+        d.process_packets(packets, count);
+        return log.str();
+    }
+
+    void test_instantiate()
+    {
+        (void)USBDecoder();
+    }
+
+    void test_channel_messages()
+    {
+        const std::uint8_t packets[] = {
+            0x09, 0x90, 0x3C, 0x40,     // note on
+            0x08, 0x80, 0x3C, 0x00,     // note off
+            0x0B, 0xB3, 0x07, 0x64,     // control change
+            0x0C, 0xC1, 0x05, 0x00,     // program change
+            0x0D, 0xD2, 0x22, 0x00,     // channel pressure
+            0x1E, 0xEF, 0x00, 0x40,     // pitch bend, cable 1
+        };
+        TS_ASSERT_EQUALS(decode(packets, 6),
+                         "[90 3C 40][80 3C 0][B3 7 64]"
+                         "[C1 5][D2 22][EF 0 40]");
+    }
+
+    void test_system_messages()
+    {
+        const std::uint8_t packets[] = {
+            0x02, 0xF3, 0x01, 0x00,     // song select
+            0x03, 0xF2, 0x10, 0x20,     // song position
+            0x05, 0xF6, 0x00, 0x00,     // tune request
+            0x0F, 0xF8, 0x00, 0x00,     // timing clock
+            0x0F, 0xFA, 0x00, 0x00,     // start
+        };
+        TS_ASSERT_EQUALS(decode(packets, 5),
+                         "[F3 1][F2 10 20][F6][F8][FA]");
+    }
+
+    void test_malformed()
+    {
+        const std::uint8_t packets[] = {
+            0x00, 0x90, 0x3C, 0x40,     // reserved CIN
+            0x01, 0x90, 0x3C, 0x40,     // reserved CIN
+            0x09, 0x80, 0x3C, 0x40,     // CIN doesn't match status
+            0x09, 0x90, 0xBC, 0x40,     // status byte as data
+            0x0F, 0x3C, 0x00, 0x00,     // single data byte
+            0x06, 0x01, 0xF7, 0x00,     // SYSEX end without start
+        };
+        TS_ASSERT_EQUALS(decode(packets, 6), "");
+    }
+
+    void test_sysex()
+    {
+        const std::uint8_t packets[] = {
+            0x04, 0xF0, 0x7D, 0x01,
+            0x0F, 0xF8, 0x00, 0x00,     // real time in the middle
+            0x04, 0x02, 0x03, 0x04,
+            0x06, 0x05, 0xF7, 0x00,
+            0x05, 0xF7, 0x00, 0x00,     // stray EOX
+            0x07, 0xF0, 0x7D, 0xF7,     // short message
+            0x06, 0xF0, 0xF7, 0x00,     // shortest message
+        };
+        TS_ASSERT_EQUALS(decode(packets, 7),
+                         "<F0 7D 1)[F8](2 3 4)(5 F7>"
+                         "<F0 7D F7><F0 F7>");
+    }
+
+    void test_sysex_interrupted()
+    {
+        const std::uint8_t packets[] = {
+            0x04, 0xF0, 0x7D, 0x01,
+            0x14, 0xF0, 0x7D, 0x02,     // cable 1 is ignored
+            0x09, 0x90, 0x3C, 0x40,     // cable 0 note on
+            0x15, 0xF7, 0x00, 0x00,     // cable 1 ends
+            0x04, 0x02, 0x03, 0x04,     // cable 0 continues nothing
+        };
+        TS_ASSERT_EQUALS(decode(packets, 5),
+                         "<F0 7D 1)(!>[90 3C 40]");
+    }
+
+    // One cable's SYSEX at a time.  The first to start is passed
+    // whole; the other's is dropped.
+    void test_sysex_interleaved()
+    {
+        const std::uint8_t packets[] = {
+            0x04, 0xF0, 0x7D, 0x01,
+            0x14, 0xF0, 0x7D, 0x02,
+            0x04, 0x02, 0x03, 0x04,
+            0x19, 0x90, 0x3C, 0x40,     // cable 1 note on
+            0x14, 0x05, 0x06, 0x07,
+            0x06, 0x05, 0xF7, 0x00,
+            0x16, 0x08, 0xF7, 0x00,
+            0x17, 0xF0, 0x7D, 0xF7,     // cable 1, after cable 0
+        };
+        TS_ASSERT_EQUALS(decode(packets, 8),
+                         "<F0 7D 1)(2 3 4)[90 3C 40](5 F7><F0 7D F7>");
+    }
+
+};
@@ -0,0 +1,259 @@
+#ifndef MIDI_TUNING_included
+#define MIDI_TUNING_included
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include "synth/midi/defs.h"
+#include "synth/midi/messages.h"
+#include "synth/util/exp2-table.h"
+
+namespace midi {
+
+    // -- Tuning -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+    //
+    // A Tuning is a table of the frequencies of the 128 MIDI keys.
+    // The default is twelve tone equal temperament, A4 = 440 Hz.
+    //
+    // A fractional pitch (e.g., a bent note) is the nearest key's
+    // frequency times 2**(offset / 12).  The exponential comes from a
+    // small interpolated table, so there is no `pow` on the hot path.
+    //
+    // A Tuning can be loaded from MIDI Tuning Standard messages.
+    //
+    //   bulk tuning dump         F0 7E dev 08 01 tt name[16]
+    //                               [xx yy zz] * 128 checksum F7
+    //   single note change       F0 7F dev 08 02 tt ll
+    //                               [kk xx yy zz] * ll F7
+    //   single note change/bank  F0 7E dev 08 07 bb tt ll
+    //                               [kk xx yy zz] * ll F7
+    //
+    // `xx` is a key number and `yy zz` is a 14 bit fraction of a
+    // semitone above it.  7F 7F 7F means "no change".  The bulk dump
+    // is 408 bytes, so MIDI_MAX_SYSEX_SIZE must be at least that to
+    // receive one through a SysexMessage.
+    //
+    // Loading a tuning computes the whole table once.  Voices hold a
+    // pointer to a Tuning, so retuning is a pointer swap.
+
+    class Tuning {
+
+    public:
+
+        typedef std::array<float, NOTE_COUNT> freq_table;
+        typedef std::uint8_t program_number;
+
+        static const size_t NAME_SIZE = 16;
+        static const size_t BULK_DUMP_SIZE = 408;
+
+        Tuning();
+
+        static const Tuning& equal_temperament();
+
+        program_number program() const;
+        const char *name() const;
+        const freq_table& table() const;
+
+        float freq(std::uint8_t note) const;
+        float freq(float pitch) const;
+
+        void freq(std::uint8_t note, float hz);
+
+        // Apply a complete MTS message, F0 through F7.  Returns false
+        // if the message is not one of the above, or is malformed,
+        // or (for single note changes) is for another program.
+        bool apply_sysex(const std::uint8_t *msg, size_t size);
+        bool apply_sysex(const SysexMessage&);
+
+    private:
+
+        static const exp2_table<64>& exp2();
+        static float mts_freq(std::uint8_t xx,
+                              std::uint8_t yy,
+                              std::uint8_t zz);
+
+        bool apply_bulk_dump(const std::uint8_t *msg, size_t size);
+        bool apply_note_changes(std::uint8_t program,
+                                const std::uint8_t *changes,
+                                size_t count);
+
+        freq_table m_freqs;
+        program_number m_program;
+        char m_name[NAME_SIZE + 1];
+
+    };
+
+    inline
+    Tuning::
+    Tuning()
+    : m_program{0},
+      m_name{}
+    {
+        for (size_t i = 0; i < NOTE_COUNT; i++)
+            m_freqs[i] = mts_freq(i, 0, 0);
+    }
+
+    inline auto
+    Tuning::
+    equal_temperament()
+    -> const Tuning&
+    {
+        static const Tuning et;
+        return et;
+    }
+
+    inline auto
+    Tuning::
+    program() const
+    -> program_number
+    {
+        return m_program;
+    }
+
+    inline auto
+    Tuning::
+    name() const
+    -> const char *
+    {
+        return m_name;
+    }
+
+    inline auto
+    Tuning::
+    table() const
+    -> const freq_table&
+    {
+        return m_freqs;
+    }
+
+    inline float
+    Tuning::
+    freq(std::uint8_t note) const
+    {
+        assert(note < NOTE_COUNT);
+        return m_freqs[note];
+    }
+
+    inline float
+    Tuning::
+    freq(float pitch) const
+    {
+        if (pitch < 0)
+            pitch = 0;
+        if (pitch > NOTE_COUNT - 1)
+            pitch = NOTE_COUNT - 1;
+        size_t key = size_t(pitch + 0.5f);
+        float offset = pitch - key;
+        if (offset == 0)
+            return m_freqs[key];
+        return m_freqs[key] * exp2()(offset * (1.0f / 12));
+    }
+
+    inline void
+    Tuning::
+    freq(std::uint8_t note, float hz)
+    {
+        assert(note < NOTE_COUNT);
+        m_freqs[note] = hz;
+    }
+
+    inline bool
+    Tuning::
+    apply_sysex(const std::uint8_t *msg, size_t size)
+    {
+        if (size < 8 || msg[0] != 0xF0 || msg[size - 1] != 0xF7)
+            return false;
+        if (msg[3] != 0x08)     // MIDI Tuning Standard
+            return false;
+        auto universal = msg[1];
+        auto sub_id_2 = msg[4];
+        if (universal == 0x7E && sub_id_2 == 0x01)
+            return apply_bulk_dump(msg, size);
+        if (universal == 0x7F && sub_id_2 == 0x02) {
+            size_t count = msg[6];
+            if (size != 8 + 4 * count)
+                return false;
+            return apply_note_changes(msg[5], msg + 7, count);
+        }
+        if (universal == 0x7E && sub_id_2 == 0x07) {
+            size_t count = msg[7];
+            if (size != 9 + 4 * count)
+                return false;
+            return apply_note_changes(msg[6], msg + 8, count);
+        }
+        return false;
+    }
+
+    inline bool
+    Tuning::
+    apply_sysex(const SysexMessage& msg)
+    {
+        return apply_sysex(msg.data, msg.size);
+    }
+
+    inline auto
+    Tuning::
+    exp2()
+    -> const exp2_table<64>&
+    {
+        static const exp2_table<64> table;
+        return table;
+    }
+
+    inline float
+    Tuning::
+    mts_freq(std::uint8_t xx, std::uint8_t yy, std::uint8_t zz)
+    {
+        float semis = xx + (yy << 7 | zz) * (1.0f / 16384) - 69;
+        return 440.0f * std::pow(2.0f, semis * (1.0f / 12));
+    }
+
+    inline bool
+    Tuning::
+    apply_bulk_dump(const std::uint8_t *msg, size_t size)
+    {
+        if (size != BULK_DUMP_SIZE)
+            return false;
+
+        // The checksum is the XOR of everything from the 7E through
+        // the last data byte.
+        std::uint8_t sum = 0;
+        for (size_t i = 1; i < size - 2; i++)
+            sum ^= msg[i];
+        if ((sum & 0x7F) != msg[size - 2])
+            return false;
+
+        const std::uint8_t *name = msg + 6;
+        const std::uint8_t *data = name + NAME_SIZE;
+        for (size_t i = 0; i < NOTE_COUNT; i++, data += 3)
+            if (data[0] != 0x7F || data[1] != 0x7F || data[2] != 0x7F)
+                m_freqs[i] = mts_freq(data[0], data[1], data[2]);
+        for (size_t i = 0; i < NAME_SIZE; i++)
+            m_name[i] = name[i];
+        m_name[NAME_SIZE] = '\0';
+        m_program = msg[5];
+        return true;
+    }
+
+    inline bool
+    Tuning::
+    apply_note_changes(std::uint8_t program,
+                       const std::uint8_t *changes,
+                       size_t count)
+    {
+        if (program != m_program)
+            return false;
+        for (size_t i = 0; i < count; i++, changes += 4) {
+            auto kk = changes[0];
+            auto xx = changes[1], yy = changes[2], zz = changes[3];
+            if (xx != 0x7F || yy != 0x7F || zz != 0x7F)
+                m_freqs[kk & 0x7F] = mts_freq(xx, yy, zz);
+        }
+        return true;
+    }
+
+}
+
+#endif /* !MIDI_TUNING_included */
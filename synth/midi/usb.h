@@ -0,0 +1,233 @@
+#ifndef MIDI_USB_included
+#define MIDI_USB_included
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "synth/midi/defs.h"
+#include "synth/midi/messages.h"
+#include "synth/util/function.h"
+
+namespace midi {
+
+    // -- USB Decoder -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- - //
+    //
+    // USB MIDI devices send 4 byte event packets.  The first byte's
+    // high nybble is the virtual cable number and its low nybble is
+    // the Code Index Number (CIN), which says how many of the other
+    // three bytes are MIDI.  So there is no need to parse byte by
+    // byte: each packet is at most one message, or part of a SYSEX
+    // message.
+    //
+    //   CIN  size  meaning
+    //    2    2    system common, two bytes
+    //    3    3    system common, three bytes
+    //    4    3    SYSEX starts or continues
+    //    5    1    system common, one byte, or SYSEX ends
+    //    6    2    SYSEX ends
+    //    7    3    SYSEX ends
+    //   8-E  2-3   channel message, CIN = status high nybble
+    //    F    1    single byte (real time)
+    //
+    // SYSEX messages are streamed as SysexChunks, one per packet,
+    // pointing into the packet buffer.  The chunks carry no cable, so
+    // only one cable's SYSEX is passed at a time: while a message is
+    // open, SYSEX on the other cables is ignored.  Packets that are
+    // reserved (CIN 0 and 1) or malformed are ignored.
+
+    class USBDecoder {
+
+    public:
+
+        typedef function<void(const SmallMessage&)> small_handler;
+        typedef function<void(const SysexChunk&)>   chunk_handler;
+
+        static const size_t PACKET_SIZE = 4;
+        static const size_t CABLE_COUNT = 16;
+
+        USBDecoder();
+
+        void register_handler(const small_handler& h);
+        void register_handler(const chunk_handler& h);
+
+        // `packets` holds `count` packets, i.e., 4 * count bytes.
+        void process_packets(const std::uint8_t *packets, size_t count);
+
+        void reset();
+
+    private:
+
+        void process_packet(const std::uint8_t *packet);
+        void process_sysex(std::uint8_t cable,
+                           const std::uint8_t *data,
+                           size_t size,
+                           bool is_end);
+        void abort_sysex(std::uint8_t cable);
+
+        static const std::uint8_t NO_CABLE = 0xFF;
+
+        small_handler m_small_handler;
+        chunk_handler m_chunk_handler;
+        std::uint8_t  m_sysex_cable;        // NO_CABLE when none open
+
+    };
+
+    inline
+    USBDecoder::
+    USBDecoder()
+    : m_sysex_cable{NO_CABLE}
+    {}
+
+    inline void
+    USBDecoder::
+    register_handler(const small_handler& h)
+    {
+        m_small_handler = h;
+    }
+
+    inline void
+    USBDecoder::
+    register_handler(const chunk_handler& h)
+    {
+        m_chunk_handler = h;
+    }
+
+    inline void
+    USBDecoder::
+    process_packets(const std::uint8_t *packets, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            process_packet(packets + i * PACKET_SIZE);
+    }
+
+    inline void
+    USBDecoder::
+    reset()
+    {
+        m_sysex_cable = NO_CABLE;
+    }
+
+    inline void
+    USBDecoder::
+    process_packet(const std::uint8_t *packet)
+    {
+        std::uint8_t cable = packet[0] >> 4;
+        std::uint8_t cin = packet[0] & 0x0F;
+        std::uint8_t s = packet[1];
+        const std::uint8_t *data = packet + 1;
+
+        switch (cin) {
+
+        case 0x4:                       // SYSEX starts or continues
+            return process_sysex(cable, data, 3, false);
+
+        case 0x5:                       // one byte
+            if (s == 0xF7)
+                return process_sysex(cable, data, 1, true);
+            if (s != 0xF6)              // Tune Request is the only one
+                return;
+            abort_sysex(cable);
+            break;
+
+        case 0x6:                       // SYSEX ends
+            return process_sysex(cable, data, 2, true);
+
+        case 0x7:
+            return process_sysex(cable, data, 3, true);
+
+        case 0x2:                       // system common
+            if (s != 0xF1 && s != 0xF3)
+                return;
+            if (data[1] & 0x80)
+                return;
+            abort_sysex(cable);
+            if (m_small_handler)
+                m_small_handler(SmallMessage(s, data[1]));
+            return;
+
+        case 0x3:
+            if (s != 0xF2)
+                return;
+            if ((data[1] | data[2]) & 0x80)
+                return;
+            abort_sysex(cable);
+            if (m_small_handler)
+                m_small_handler(SmallMessage(s, data[1], data[2]));
+            return;
+
+        case 0xC:                       // two byte channel messages
+        case 0xD:
+            if (s >> 4 != cin || (data[1] & 0x80))
+                return;
+            abort_sysex(cable);
+            if (m_small_handler)
+                m_small_handler(SmallMessage(s, data[1]));
+            return;
+
+        case 0x8:                       // three byte channel messages
+        case 0x9:
+        case 0xA:
+        case 0xB:
+        case 0xE:
+            if (s >> 4 != cin || ((data[1] | data[2]) & 0x80))
+                return;
+            abort_sysex(cable);
+            if (m_small_handler)
+                m_small_handler(SmallMessage(s, data[1], data[2]));
+            return;
+
+        case 0xF:                       // single byte
+            // Real time messages may come in the middle of SYSEX.
+            if (s < 0xF8 || s == 0xF9 || s == 0xFD)
+                return;
+            break;
+
+        default:                        // CIN 0 and 1 are reserved
+            return;
+        }
+
+        if (m_small_handler)
+            m_small_handler(SmallMessage(s));
+    }
+
+    inline void
+    USBDecoder::
+    process_sysex(std::uint8_t cable,
+                  const std::uint8_t *data,
+                  size_t size,
+                  bool is_end)
+    {
+        std::uint8_t flags = is_end ? SysexChunk::END : 0;
+        if (data[0] == 0xF0) {
+            if (m_sysex_cable != NO_CABLE && m_sysex_cable != cable)
+                return;                 // another cable is sending
+            abort_sysex(cable);
+            flags |= SysexChunk::BEGIN;
+            m_sysex_cable = cable;
+        } else if (m_sysex_cable != cable) {
+            return;                     // continuation of nothing
+        }
+        if (is_end)
+            m_sysex_cable = NO_CABLE;
+        if (m_chunk_handler)
+            m_chunk_handler(SysexChunk{data, size, flags});
+    }
+
+    // Any message but real time ends a SYSEX message in progress on
+    // the same cable.
+    inline void
+    USBDecoder::
+    abort_sysex(std::uint8_t cable)
+    {
+        if (m_sysex_cable == cable) {
+            m_sysex_cable = NO_CABLE;
+            const std::uint8_t flags = SysexChunk::END | SysexChunk::ABORT;
+            if (m_chunk_handler)
+                m_chunk_handler(SysexChunk{nullptr, 0, flags});
+        }
+    }
+
+}
+
+#endif /* !MIDI_USB_included */
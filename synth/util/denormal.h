@@ -0,0 +1,29 @@
+#ifndef DENORMAL_included
+#define DENORMAL_included
+
+#include <cmath>
+
+
+// -- Denormals -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// Recursive filters decay toward zero forever.  On many CPUs,
+// arithmetic on denormal floats is very slow, so a silent filter can
+// cost more than a loud one.  Filters call `flush_denormal` on their
+// state once per block; anything below DENORMAL_THRESHOLD (about
+// -300 dB) is set to exactly zero.
+
+#define DENORMAL_THRESHOLD 1.0e-15f
+
+inline void flush_denormal(float& x)
+{
+    if (std::fabs(x) < DENORMAL_THRESHOLD)
+        x = 0;
+}
+
+inline void flush_denormal(double& x)
+{
+    if (std::fabs(x) < DENORMAL_THRESHOLD)
+        x = 0;
+}
+
+#endif /* !DENORMAL_included */
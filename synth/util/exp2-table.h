@@ -0,0 +1,46 @@
+#ifndef EXP2_TABLE_included
+#define EXP2_TABLE_included
+
+#include <cassert>
+#include <cmath>
+
+
+// exp2_table<N> approximates 2**x with an N-segment table of one
+// octave and linear interpolation.  Integer octaves are exact.
+//
+// Relative error is about (ln 2)**2 / (8 * N**2): for N = 64, that is
+// 1.5e-5, or 0.03 cents.
+
+
+template <size_t N>
+class exp2_table {
+
+    static_assert(N > 0, "table must have at least one segment");
+
+public:
+
+    exp2_table()
+    {
+        for (size_t i = 0; i <= N; i++)
+            m_table[i] = std::pow(2.0, double(i) / N);
+    }
+
+    float operator () (float x) const
+    {
+        float octave = std::floor(x);
+        float t = (x - octave) * N;
+        size_t i = size_t(t);
+        if (i >= N)             // x was a hair below an integer
+            i = N - 1;
+        float frac = t - i;
+        float y = m_table[i] + (m_table[i + 1] - m_table[i]) * frac;
+        return std::ldexp(y, int(octave));
+    }
+
+private:
+
+    float m_table[N + 1];
+
+};
+
+#endif /* !EXP2_TABLE_included */
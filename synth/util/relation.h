@@ -1,6 +1,9 @@
 #ifndef RELATION_included
 #define RELATION_included
 
+#include <cassert>
+#include <type_traits>
+
 #include "synth/util/fixed-vector.h"
 #include "synth/util/universe.h"
 
@@ -53,6 +56,25 @@ public:
         m_matrix[m_u1.index(v1)].add(v2);
     }
 
+    // closure - transitive closure of a relation on one universe,
+    // following only paths whose every step lands in `via`.  This is
+    // Warshall's algorithm with each row a bitset, so each step
+    // unions a whole row a word at a time.
+    Relation closure(const sub2_type& via) const
+    {
+        static_assert(std::is_same<U1, U2>::value,
+                      "closure needs a relation on one universe");
+        assert(&m_u1 == &m_u2);
+        Relation c(m_u1, m_u2);
+        for (size_t i = 0; i < m_matrix.size(); i++)
+            c.m_matrix[i] = m_matrix[i] & via;
+        for (auto k: via.indices())
+            for (size_t i = 0; i < c.m_matrix.size(); i++)
+                if (c.m_matrix[i].test(k))
+                    c.m_matrix[i] |= c.m_matrix[k];
+        return c;
+    }
+
 private:
     const U1& m_u1;
     const U2& m_u2;
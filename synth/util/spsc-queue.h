@@ -0,0 +1,182 @@
+#ifndef SPSC_QUEUE_included
+#define SPSC_QUEUE_included
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+
+// spsc_queue<T, N> is a fixed size FIFO that passes values from one
+// producer thread to one consumer thread without locks.
+//
+//   - N must be a power of two.  The queue holds N elements.
+//   - push and pop are wait-free: they never block, never allocate,
+//     and finish in a bounded number of steps.  push fails when the
+//     queue is full; pop fails when it is empty.
+//   - Only the producer may call push.  Only the consumer may call
+//     front and pop.  size and empty are exact only on the consumer
+//     side.
+//   - The producer's and consumer's indices live on separate cache
+//     lines, and each side caches the other's index, so a burst of
+//     pushes (or pops) touches the shared lines once.
+//   - T should be cheap to copy.  Elements are assigned, not
+//     constructed, so T must be default constructible.
+
+
+template <class T, size_t N>
+class spsc_queue {
+
+    static_assert(N && !(N & (N - 1)), "N must be a power of two");
+
+public:
+
+    // Types
+    typedef T        value_type;
+    typedef T&       reference;
+    typedef const T& const_reference;
+    typedef size_t   size_type;
+
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    // Constructors
+    spsc_queue();
+    spsc_queue(const spsc_queue&) = delete;
+
+    // Assignment
+    spsc_queue& operator = (const spsc_queue&) = delete;
+
+    // Capacity
+    bool empty() const;
+    size_type size() const;
+    size_type max_size() const;
+
+    // Producer
+    bool push(const value_type&);
+
+    // Consumer
+    value_type *front();
+    void pop();
+    bool pop(value_type&);
+
+private:
+
+    static const size_t MASK = N - 1;
+
+    // Written by the consumer.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head;
+    size_t m_cached_tail;
+
+    // Written by the producer.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail;
+    size_t m_cached_head;
+
+    alignas(CACHE_LINE_SIZE) T m_slots[N];
+
+};
+
+
+// -- Constructors - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+template <class T, size_t N>
+inline
+spsc_queue<T, N>::spsc_queue()
+: m_head{0},
+  m_cached_tail{0},
+  m_tail{0},
+  m_cached_head{0},
+  m_slots{}
+{}
+
+
+// -- Capacity -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+template <class T, size_t N>
+inline
+bool
+spsc_queue<T, N>::empty() const
+{
+    return size() == 0;
+}
+
+template <class T, size_t N>
+inline
+typename spsc_queue<T, N>::size_type
+spsc_queue<T, N>::size() const
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    return m_tail.load(std::memory_order_acquire) - head;
+}
+
+template <class T, size_t N>
+inline
+typename spsc_queue<T, N>::size_type
+spsc_queue<T, N>::max_size() const
+{
+    return N;
+}
+
+
+// -- Producer -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+// The indices run freely and wrap modulo 2**64, so head == tail is
+// empty and tail - head == N is full.
+
+template <class T, size_t N>
+inline
+bool
+spsc_queue<T, N>::push(const value_type& v)
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cached_head == N) {
+        m_cached_head = m_head.load(std::memory_order_acquire);
+        if (tail - m_cached_head == N)
+            return false;
+    }
+    m_slots[tail & MASK] = v;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+
+// -- Consumer -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+// The oldest element, or nullptr if the queue is empty.  It stays
+// valid until pop.
+template <class T, size_t N>
+inline
+typename spsc_queue<T, N>::value_type *
+spsc_queue<T, N>::front()
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cached_tail) {
+        m_cached_tail = m_tail.load(std::memory_order_acquire);
+        if (head == m_cached_tail)
+            return nullptr;
+    }
+    return &m_slots[head & MASK];
+}
+
+template <class T, size_t N>
+inline
+void
+spsc_queue<T, N>::pop()
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    assert(head != m_tail.load(std::memory_order_acquire));
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+template <class T, size_t N>
+inline
+bool
+spsc_queue<T, N>::pop(value_type& v)
+{
+    value_type *p = front();
+    if (!p)
+        return false;
+    v = *p;
+    pop();
+    return true;
+}
+
+#endif /* !SPSC_QUEUE_included */
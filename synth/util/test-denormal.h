@@ -0,0 +1,37 @@
+#include "denormal.h"
+
+#include <limits>
+
+#include <cxxtest/TestSuite.h>
+
+class denormal_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_flush()
+    {
+        float f = std::numeric_limits<float>::denorm_min();
+        flush_denormal(f);
+        TS_ASSERT_EQUALS(f, 0);
+
+        f = -1.0e-20f;
+        flush_denormal(f);
+        TS_ASSERT_EQUALS(f, 0);
+
+        double d = 1.0e-30;
+        flush_denormal(d);
+        TS_ASSERT_EQUALS(d, 0);
+    }
+
+    void test_keep()
+    {
+        float f = 1.0e-6f;
+        flush_denormal(f);
+        TS_ASSERT_EQUALS(f, 1.0e-6f);
+
+        f = -0.5f;
+        flush_denormal(f);
+        TS_ASSERT_EQUALS(f, -0.5f);
+    }
+
+};
@@ -0,0 +1,35 @@
+#include "exp2-table.h"
+
+#include <cmath>
+
+#include <cxxtest/TestSuite.h>
+
+class exp2_table_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        (void)exp2_table<1>();
+        (void)exp2_table<64>();
+    }
+
+    void test_octaves()
+    {
+        exp2_table<64> e;
+        TS_ASSERT_EQUALS(e(0), 1);
+        TS_ASSERT_EQUALS(e(1), 2);
+        TS_ASSERT_EQUALS(e(-1), 0.5);
+        TS_ASSERT_EQUALS(e(10), 1024);
+    }
+
+    void test_accuracy()
+    {
+        exp2_table<64> e;
+        for (float x = -4; x < 4; x += 0.001) {
+            float expected = std::pow(2.0, x);
+            TS_ASSERT_DELTA(e(x) / expected, 1, 2e-5);
+        }
+    }
+
+};
@@ -78,4 +78,29 @@ public:
         TS_ASSERT_THROWS(rel.get(4.4f), std::logic_error);
     }
 
+    void test_closure()
+    {
+        // 0 -> 1 -> 2 -> 3, 4 -> 0
+        typedef Universe<std::vector<int>, 5> U;
+        const U::referent ref{0, 1, 2, 3, 4};
+        const U u{ref};
+        Relation<U, U> r{u, u};
+        r.add(0, 1);
+        r.add(1, 2);
+        r.add(2, 3);
+        r.add(4, 0);
+
+        auto c = r.closure(u.all);
+        TS_ASSERT_EQUALS(c.at(0), u.subset(0b01110));
+        TS_ASSERT_EQUALS(c.at(1), u.subset(0b01100));
+        TS_ASSERT_EQUALS(c.at(3), u.none);
+        TS_ASSERT_EQUALS(c.at(4), u.subset(0b01111));
+
+        // Paths may not pass through 2.
+        auto c2 = r.closure(u.subset(0b11011));
+        TS_ASSERT_EQUALS(c2.at(0), u.subset(0b00010));
+        TS_ASSERT_EQUALS(c2.at(4), u.subset(0b00011));
+        TS_ASSERT_EQUALS(r.at(0), u.subset(0b00010));
+    }
+
 };
@@ -0,0 +1,98 @@
+#include "spsc-queue.h"
+
+#include <cstdint>
+#include <thread>
+
+#include <cxxtest/TestSuite.h>
+
+class spsc_queue_unit_test : public CxxTest::TestSuite {
+
+public:
+
+    void test_instantiate()
+    {
+        spsc_queue<int, 4> q;
+        (void)q;
+        TS_TRACE("sizeof spsc_queue<int, 4> = " +
+                 std::to_string(sizeof q));
+    }
+
+    void test_empty()
+    {
+        spsc_queue<int, 4> q;
+        TS_ASSERT(q.empty());
+        TS_ASSERT_EQUALS(q.size(), 0u);
+        TS_ASSERT_EQUALS(q.max_size(), 4u);
+        TS_ASSERT(q.front() == nullptr);
+        int x = 0;
+        TS_ASSERT(!q.pop(x));
+    }
+
+    void test_push_pop()
+    {
+        spsc_queue<int, 4> q;
+        TS_ASSERT(q.push(1));
+        TS_ASSERT(q.push(2));
+        TS_ASSERT_EQUALS(q.size(), 2u);
+        TS_ASSERT_EQUALS(*q.front(), 1);
+        q.pop();
+        int x = 0;
+        TS_ASSERT(q.pop(x));
+        TS_ASSERT_EQUALS(x, 2);
+        TS_ASSERT(q.empty());
+    }
+
+    void test_full()
+    {
+        spsc_queue<int, 4> q;
+        for (int i = 0; i < 4; i++)
+            TS_ASSERT(q.push(i));
+        TS_ASSERT(!q.push(4));
+        TS_ASSERT_EQUALS(q.size(), 4u);
+        q.pop();
+        TS_ASSERT(q.push(4));
+        for (int i = 1; i <= 4; i++) {
+            int x = -1;
+            TS_ASSERT(q.pop(x));
+            TS_ASSERT_EQUALS(x, i);
+        }
+        TS_ASSERT(q.empty());
+    }
+
+    void test_wrap()
+    {
+        spsc_queue<int, 4> q;
+        for (int i = 0; i < 100; i++) {
+            TS_ASSERT(q.push(i));
+            TS_ASSERT(q.push(i + 1000));
+            int x = -1, y = -1;
+            TS_ASSERT(q.pop(x));
+            TS_ASSERT(q.pop(y));
+            TS_ASSERT_EQUALS(x, i);
+            TS_ASSERT_EQUALS(y, i + 1000);
+        }
+    }
+
+    void test_threads()
+    {
+        static const std::uint32_t COUNT = 200000;
+        static spsc_queue<std::uint32_t, 64> q;
+
+        std::thread producer([] {
+            for (std::uint32_t i = 0; i < COUNT; )
+                if (q.push(i))
+                    i++;
+        });
+        std::uint32_t expected = 0;
+        bool in_order = true;
+        while (expected < COUNT) {
+            std::uint32_t x;
+            if (q.pop(x))
+                in_order &= x == expected++;
+        }
+        producer.join();
+        TS_ASSERT(in_order);
+        TS_ASSERT(q.empty());
+    }
+
+};
@@ -93,6 +93,71 @@ public:
         TS_ASSERT_THROWS(u.index(Turtle::Splinter), std::logic_error);
     }
 
+    void test_find_pointers()
+    {
+        static const size_t n = 200;
+        std::vector<int> targets(n);
+        fixed_vector<const int *, n> ptrs;
+        for (size_t i = 0; i < n; i++)
+            ptrs.push_back(&targets[i]);
+        const Universe<fixed_vector<const int *, n>, n> u(ptrs);
+        for (size_t i = 0; i < n; i++)
+            TS_ASSERT_EQUALS(u.find(&targets[i]), ssize_t(i));
+        int other;
+        TS_ASSERT_EQUALS(u.find(&other), -1);
+        TS_ASSERT_EQUALS(u.find(nullptr), -1);
+    }
+
+    void test_large()
+    {
+        typedef fixed_vector<int, 150> V;
+        V ref;
+        for (int i = 0; i < 100; i++)
+            ref.push_back(i * i);
+        const Universe<V, 150> u(ref);
+        TS_ASSERT_EQUALS(u.all.count(), 100);
+        TS_ASSERT(u.all.test(99));
+        TS_ASSERT(!u.all.test(100));
+
+        auto s = u.none;
+        s.add(0);
+        s.add(64 * 64);
+        s.add(99 * 99);
+        std::vector<size_t> indices(s.indices().begin(), s.indices().end());
+        TS_ASSERT_EQUALS(indices, (std::vector<size_t>{0, 64, 99}));
+    }
+
+    void test_find_after_change()
+    {
+        typedef fixed_vector<short, 8> V;
+        V ref{2, 3, 5};
+        Universe<V, 8> u(ref, 8);
+        TS_ASSERT_EQUALS(u.find(5), 2);
+        ref.push_back(7);
+        TS_ASSERT_EQUALS(u.find(7), 3);
+        ref[0] = 11;
+        TS_ASSERT_EQUALS(u.find(11), 0);
+        TS_ASSERT_EQUALS(u.find(2), -1);
+    }
+
+    void test_find_by_address()
+    {
+        struct Point {
+            int x, y;
+            bool operator == (const Point& that) const
+            {
+                return x == that.x && y == that.y;
+            }
+        };
+        typedef fixed_vector<Point, 4> V;
+        const V points{{1, 2}, {3, 4}, {1, 2}};
+        const Universe<V, 4> u(points);
+        TS_ASSERT_EQUALS(u.find(points[1]), 1);
+        TS_ASSERT_EQUALS(u.find(points[2]), 2);
+        TS_ASSERT_EQUALS(u.find(Point{1, 2}), 0);
+        TS_ASSERT_EQUALS(u.find(Point{5, 6}), -1);
+    }
+
     void test_subscript()
     {
         const U u(turtles);
@@ -3,11 +3,15 @@
 
 #include <algorithm>
 #include <bitset>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 
 template <class C, size_t N>
 class Subset;
@@ -34,6 +38,111 @@ class Subset;
 //      u.none                  // {}
 //      u.all                   // {a b c}
 
+// -- Universe Index - -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+//
+// A UniverseIndex maps members to indices in constant time.  It is
+// an open addressing hash table, at most half full, of indices into
+// the referent.  Only pointers, enums and integers are hashed; other
+// member types have an empty index and are found by address or by
+// linear search.
+//
+// The referent may be filled in after the Universe is built, so the
+// table is built on first use and rebuilt when the referent's size
+// changes.  Hits are checked against the referent, and misses fall
+// back to linear search, so a stale table is slow but never wrong.
+
+template <class T>
+struct universe_hashable
+: std::integral_constant<bool,
+                         std::is_pointer<T>::value ||
+                         std::is_integral<T>::value ||
+                         std::is_enum<T>::value> {};
+
+constexpr size_t universe_table_size(size_t n, size_t size = 1)
+{
+    return size >= 2 * n ? size : universe_table_size(n, 2 * size);
+}
+
+template <class T, size_t N, bool = universe_hashable<T>::value>
+class UniverseIndex {
+
+public:
+
+    template <class C>
+    ssize_t find(const C&, const T&) const { return -1; }
+
+};
+
+template <class T, size_t N>
+class UniverseIndex<T, N, true> {
+
+public:
+
+    UniverseIndex() : m_built_size{NOT_BUILT} {}
+
+    template <class C>
+    ssize_t find(const C& ref, const T& m) const
+    {
+        if (m_built_size != ref.size())
+            build(ref);
+        for (size_t h = hash(m); ; h = (h + 1) & MASK) {
+            slot_type i = m_table[h];
+            if (i == EMPTY)
+                return -1;
+            if (i < ref.size() && ref[i] == m)
+                return i;
+        }
+    }
+
+private:
+
+    typedef typename std::conditional<(N < 0xFFFF),
+                                      std::uint16_t,
+                                      std::uint32_t>::type slot_type;
+    static const size_t TABLE_SIZE = universe_table_size(N);
+    static const size_t MASK = TABLE_SIZE - 1;
+    static const slot_type EMPTY = slot_type(~slot_type(0));
+    static const size_t NOT_BUILT = ~size_t(0);
+
+    static std::uint64_t key(const T& m, std::true_type /* pointer */)
+    {
+        return reinterpret_cast<std::uintptr_t>(m);
+    }
+
+    static std::uint64_t key(const T& m, std::false_type /* pointer */)
+    {
+        return static_cast<std::uint64_t>(m);
+    }
+
+    // Fibonacci hashing: the multiply mixes the low bits upward.
+    static size_t hash(const T& m)
+    {
+        std::uint64_t k = key(m, std::is_pointer<T>());
+        k *= 0x9E3779B97F4A7C15;
+        return (k ^ k >> 32) & MASK;
+    }
+
+    template <class C>
+    void build(const C& ref) const
+    {
+        assert(ref.size() <= N);
+        m_table.fill(slot_type(EMPTY));
+        for (size_t i = 0; i < ref.size(); i++) {
+            size_t h = hash(ref[i]);
+            while (m_table[h] != EMPTY && !(ref[m_table[h]] == ref[i]))
+                h = (h + 1) & MASK;
+            if (m_table[h] == EMPTY)    // first duplicate wins
+                m_table[h] = i;
+        }
+        m_built_size = ref.size();
+    }
+
+    mutable std::array<slot_type, TABLE_SIZE> m_table;
+    mutable size_t m_built_size;
+
+};
+
+
 template <class C, size_t N>
 class Universe {
 
@@ -46,13 +155,13 @@ public:
     static const size_t max_size = N;
 
     Universe(const referent& ref)
-    : all{*this, (1 << ref.size()) - 1},
+    : all{*this, first_bits(ref.size())},
       none{*this},
       m_ref{ref}
     {}
 
     Universe(const referent& ref, size_t size)
-    : all{*this, (1 << size) - 1},
+    : all{*this, first_bits(size)},
       none{*this},
       m_ref{ref}
     {}
@@ -63,8 +172,23 @@ public:
 
     size_t size() const { return m_ref.size(); }
 
+    // Members are found by address if m refers into the referent,
+    // then by hash if member_type is hashable, then by linear search.
+    // The address is checked, so the referent need not be contiguous.
     ssize_t find(const member_type& m) const
     {
+        if (size()) {
+            const member_type *first = &m_ref[0];
+            std::less<const member_type *> before;
+            if (!before(&m, first) && before(&m, first + size())) {
+                size_t i = &m - first;
+                if (&m_ref[i] == &m)
+                    return i;
+            }
+        }
+        ssize_t i = m_index.find(m_ref, m);
+        if (i != -1)
+            return i;
         auto pos = std::find(m_ref.begin(), m_ref.end(), m);
         if (pos == m_ref.end())
             return -1;
@@ -113,7 +237,16 @@ public:
 
 private:
 
+    // The low n bits, for any n <= N.  (1 << n) - 1 overflows when
+    // n reaches the width of int.
+    static bits first_bits(size_t n)
+    {
+        assert(n <= N);
+        return ~bits() >> (N - n);
+    }
+
     const referent& m_ref;
+    UniverseIndex<member_type, N> m_index;
     friend subset_type;
 
 };
@@ -178,13 +311,8 @@ private:
     Subset(const Universe<C, N>& u, I first, I last)
     : m_universe{&u}
     {
-        auto b = m_universe->m_ref.begin();
-        auto e = m_universe->m_ref.end();
-        for (auto i = first; i != last; i++) {
-            auto there = std::find(b, e, *i);
-            auto j = there - b;
-            super::set(j, true);
-        }
+        for (auto i = first; i != last; i++)
+            super::set(m_universe->index(*i), true);
     }
 
 public:
@@ -241,9 +369,18 @@ public:
     private:
         size_t advance(size_t index)
         {
+#ifdef __GLIBCXX__
+            // libstdc++ can scan a word at a time.
+            if (index >= m_sub->size())
+                return m_sub->size();
+            if (index == 0)
+                return m_sub->_Find_first();
+            return m_sub->_Find_next(index - 1);
+#else
             while (index < m_sub->size() && !m_sub->test(index))
                 index++;
             return index;
+#endif
         }
 
         const Subset *m_sub;
@@ -0,0 +1,229 @@
+// MIDI file iterator benchmark.
+//
+// Builds format 1 MIDI files in memory with 1, 16, 64, and 256
+// tracks of note on/off pairs at pseudorandom times, iterates over
+// each one, and reports events per second.  Then it does the same
+// with each file's flat event form.  Files named on the command line
+// are timed too.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "midi-flat.h"
+
+#define EVENTS_PER_FILE (1 << 20)
+#define REPEAT          10
+
+typedef struct buffer {
+    uint8_t *data;
+    size_t   size;
+    size_t   alloc;
+} buffer;
+
+static void put_byte(buffer *b, uint8_t byte)
+{
+    if (b->size == b->alloc) {
+        b->alloc = b->alloc ? 2 * b->alloc : 4096;
+        b->data = realloc(b->data, b->alloc);
+        if (!b->data) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    b->data[b->size++] = byte;
+}
+
+static void put_u16(buffer *b, uint16_t n)
+{
+    put_byte(b, n >> 8);
+    put_byte(b, n);
+}
+
+static void put_u32(buffer *b, uint32_t n)
+{
+    put_u16(b, n >> 16);
+    put_u16(b, n);
+}
+
+static void put_vlq(buffer *b, uint32_t n)
+{
+    int shift = 21;
+    while (shift > 0 && !(n >> shift))
+        shift -= 7;
+    for ( ; shift > 0; shift -= 7)
+        put_byte(b, 0x80 | (n >> shift & 0x7F));
+    put_byte(b, n & 0x7F);
+}
+
+static buffer make_file(size_t track_count, size_t events_per_track)
+{
+    buffer b = { NULL, 0, 0 };
+    put_u32(&b, 0x4d546864);            // "MThd"
+    put_u32(&b, 6);
+    put_u16(&b, 1);                     // format 1
+    put_u16(&b, track_count);
+    put_u16(&b, 480);                   // ticks per quarter note
+
+    srand(1);
+    for (size_t i = 0; i < track_count; i++) {
+        put_u32(&b, 0x4d54726b);        // "MTrk"
+        size_t size_pos = b.size;
+        put_u32(&b, 0);
+        uint8_t chan = i & 0x0F;
+        for (size_t j = 0; j < events_per_track; j += 2) {
+            uint8_t note = 36 + rand() % 48;
+            put_vlq(&b, rand() % 240);
+            put_byte(&b, 0x90 | chan);
+            put_byte(&b, note);
+            put_byte(&b, 0x64);
+            put_vlq(&b, rand() % 240);
+            put_byte(&b, 0x80 | chan);
+            put_byte(&b, note);
+            put_byte(&b, 0x40);
+        }
+        put_vlq(&b, 0);                 // end of track
+        put_byte(&b, 0xFF);
+        put_byte(&b, 0x2F);
+        put_byte(&b, 0x00);
+        uint32_t size = b.size - size_pos - 4;
+        for (int k = 0; k < 4; k++)
+            b.data[size_pos + k] = size >> (24 - 8 * k);
+    }
+    return b;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(const char *name, const uint8_t *data, size_t size)
+{
+    MIDI_file mf;
+    MIDI_status s = init_MIDI_file((const char *)data, size, &mf);
+    if (s) {
+        fprintf(stderr, "%s: init_MIDI_file: %s, %s\n",
+                name, MIDI_status_name(s), MIDI_status_description(s));
+        return;
+    }
+
+    size_t events = 0;
+    double t0 = now();
+    for (int i = 0; i < REPEAT; i++) {
+        MIDI_iterator it;
+        s = init_MIDI_file_iterator(&mf, &it);
+        if (s) {
+            fprintf(stderr, "%s: init_MIDI_file_iterator: %s, %s\n",
+                    name, MIDI_status_name(s), MIDI_status_description(s));
+            exit(1);
+        }
+        MIDI_event evt;
+        while (MIDI_iter_next(&it, &evt) != MIDI_ITER_END)
+            events++;
+        destroy_MIDI_iterator(&it);
+    }
+    double dt = now() - t0;
+
+    printf("%-24s %4lu track%s %9lu events  %6.1f Mevents/sec\n",
+           name, mf.track_count, &"s"[mf.track_count == 1],
+           events / REPEAT, events / dt / 1e6);
+    destroy_MIDI_file(&mf);
+}
+
+static void bench_flat(const char *name, const uint8_t *data, size_t size)
+{
+    MIDI_file mf;
+    MIDI_status s = init_MIDI_file((const char *)data, size, &mf);
+    void *flat_data;
+    size_t flat_size;
+    if (!s)
+        s = MIDI_flatten(&mf, &flat_data, &flat_size);
+    if (s) {
+        fprintf(stderr, "%s: MIDI_flatten: %s, %s\n",
+                name, MIDI_status_name(s), MIDI_status_description(s));
+        return;
+    }
+
+    size_t events = 0;
+    uint64_t checksum = 0;
+    double t0 = now();
+    for (int i = 0; i < REPEAT; i++) {
+        MIDI_flat flat;
+        s = init_MIDI_flat(flat_data, flat_size, &flat);
+        if (s) {
+            fprintf(stderr, "%s: init_MIDI_flat: %s, %s\n",
+                    name, MIDI_status_name(s), MIDI_status_description(s));
+            exit(1);
+        }
+        for (size_t j = 0; j < flat.event_count; j++) {
+            const MIDI_flat_event *evt = &flat.events[j];
+            checksum += evt->time_usecs + evt->status_byte;
+            if (evt->data_size)
+                checksum += *MIDI_flat_event_data(&flat, evt);
+            events++;
+        }
+    }
+    double dt = now() - t0;
+
+    printf("%-24s %4lu track%s %9lu events  %6.1f Mevents/sec (flat)\n",
+           name, mf.track_count, &"s"[mf.track_count == 1],
+           events / REPEAT, events / dt / 1e6);
+    if (checksum == 1)
+        printf("\n");                  // keep the loop
+    free(flat_data);
+    destroy_MIDI_file(&mf);
+}
+
+static void bench_file(const char *file_name)
+{
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        perror(file_name);
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror(file_name);
+        close(fd);
+        return;
+    }
+    void *addr = mmap(NULL,
+                      st.st_size,
+                      PROT_READ,
+                      MAP_FILE | MAP_PRIVATE,
+                      fd,
+                      0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        return;
+    }
+    bench(file_name, addr, st.st_size);
+    bench_flat(file_name, addr, st.st_size);
+    munmap(addr, st.st_size);
+}
+
+int main(int argc, char *argv[])
+{
+    static const size_t track_counts[] = { 1, 16, 64, 256 };
+    for (size_t i = 0; i < sizeof track_counts / sizeof *track_counts; i++) {
+        size_t n = track_counts[i];
+        char name[32];
+        snprintf(name, sizeof name, "synthetic-%lu", n);
+        buffer b = make_file(n, EVENTS_PER_FILE / n);
+        bench(name, b.data, b.size);
+        bench_flat(name, b.data, b.size);
+        free(b.data);
+    }
+    for (int i = 1; i < argc; i++)
+        bench_file(argv[i]);
+    return 0;
+}
@@ -0,0 +1,361 @@
+// Render a batch of MIDI files on a thread pool.  See
+// synth/midi/render-farm.h.
+//
+//     use: farm [-j threads] [-r rate] [-t tail-msec] file[:patch] ...
+//
+// Each argument is a job: a standard or flat MIDI file, and a patch
+// number, default 0.  Each file is read once, and its messages are
+// shared by every job that plays it.  Each patch is planned once,
+// and its saved plan is shared by every job that uses it.  All jobs
+// share one tuning table.  Each job's output hash is printed, then
+// the aggregate throughput.
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "synth/core/config.h"
+#include "synth/core/modules.h"
+#include "synth/core/synth.h"
+#include "synth/midi/messages.h"
+#include "synth/midi/render-farm.h"
+#include "synth/midi/tuning.h"
+#include "synth/osc/naive-square.h"
+
+extern "C" {
+#include "midi-flat.h"
+}
+
+using midi::SmallMessage;
+using midi::StatusByte;
+using midi::TimedMessage;
+
+// -- Beep Target -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- - //
+//
+// A one voice square wave synth that plays the last note on any
+// channel.  Patch n plays it n octaves down, modulo 4.
+
+// Outputs the last note's frequency, and a gate that is its velocity
+// while it is held.
+class Keys : public ModuleType<Keys> {
+
+public:
+
+    Keys()
+    : m_tuning{&midi::Tuning::equal_temperament()},
+      m_note{0},
+      m_freq{0},
+      m_gain{0}
+    {
+        freq.name("freq");
+        gate.name("gate");
+        ports(freq, gate);
+    }
+
+    Output<> freq;
+    Output<> gate;
+
+    void note_on(std::uint8_t note, std::uint8_t velocity)
+    {
+        m_note = note;
+        m_freq = m_tuning->freq(note);
+        m_gain = velocity / 127.0f;
+    }
+
+    void note_off(std::uint8_t note)
+    {
+        if (note == m_note)
+            m_gain = 0;
+    }
+
+    void render(size_t frame_count)
+    {
+        for (size_t i = 0; i < frame_count; i++) {
+            freq[i] = m_freq;
+            gate[i] = m_gain;
+        }
+    }
+
+private:
+
+    const midi::Tuning *m_tuning;       // shared by all jobs
+    std::uint8_t m_note;
+    float m_freq;
+    float m_gain;
+
+};
+
+class Vca : public ModuleType<Vca> {
+
+public:
+
+    Vca()
+    {
+        in.name("in");
+        gain.name("gain");
+        out.name("out");
+        ports(in, gain, out);
+    }
+
+    Input<> in;
+    Input<> gain;
+    Output<> out;
+
+    void render(size_t frame_count)
+    {
+        for (size_t i = 0; i < frame_count; i++)
+            out[i] = in[i] * gain[i];
+    }
+
+};
+
+class Beep {
+
+public:
+
+    template <class OutputModule>
+    Beep(const Config& cfg, OutputModule& out)
+    : m_synth{"Beep", 1, 1}
+    {
+        m_synth.add_timbre_module(m_keys)
+               .add_timbre_module(m_square)
+               .add_timbre_module(m_vca)
+               .add_timbre_module(out, true)
+               .finalize(cfg);
+        m_patch.connect(m_vca.in, m_square.out)
+               .connect(m_vca.gain, m_keys.gate)
+               .connect(out.in, m_vca.out);
+    }
+    Beep(const Beep&) = delete;
+    Beep& operator = (const Beep&) = delete;
+
+    Synth& synth() { return m_synth; }
+
+    void select_patch(size_t n, const std::uint8_t *plan, size_t plan_size)
+    {
+        m_patch.connect(m_square.freq,
+                        m_keys.freq,
+                        std::ldexp(1.0f, -int(n % 4)));
+        Timbre& timbre = m_synth.timbres().front();
+        if (!plan ||
+            !m_synth.apply_saved_plan(m_patch, timbre, plan, plan_size))
+            m_synth.apply_patch(m_patch, timbre);
+    }
+
+    void process_message(const SmallMessage& msg)
+    {
+        switch (msg.status()) {
+
+        case StatusByte::NOTE_ON:
+            if (msg.velocity())
+                m_keys.note_on(msg.note_number(), msg.velocity());
+            else
+                m_keys.note_off(msg.note_number());
+            break;
+
+        case StatusByte::NOTE_OFF:
+            m_keys.note_off(msg.note_number());
+            break;
+
+        default:
+            break;
+        }
+    }
+
+private:
+
+    Keys m_keys;
+    NaiveSquare m_square;
+    Vca m_vca;
+    Patch m_patch;
+    Synth m_synth;
+
+};
+
+
+// -- Front End  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- //
+
+typedef midi::RenderFarm<Beep> farm;
+
+static void fail(const char *what, MIDI_status s)
+{
+    fprintf(stderr, "%s: %d %s, %s\n",
+            what, s, MIDI_status_name(s), MIDI_status_description(s));
+    exit(1);
+}
+
+// Read a standard or flat MIDI file's channel messages.
+static std::vector<TimedMessage> read_messages(const char *file_name,
+                                               std::uint32_t sample_rate)
+{
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        perror(file_name);
+        exit(1);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror(file_name);
+        exit(1);
+    }
+    void *addr = mmap(NULL,
+                      st.st_size,
+                      PROT_READ,
+                      MAP_FILE | MAP_PRIVATE,
+                      fd,
+                      0);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+
+    MIDI_status s;
+    const void *flat_data = addr;
+    size_t flat_size = st.st_size;
+    void *flattened = NULL;
+    if (st.st_size < 4 || *(const uint32_t *)addr != MIDI_FLAT_MAGIC) {
+        MIDI_file mf;
+        s = init_MIDI_file((const char *)addr, st.st_size, &mf);
+        if (s)
+            fail("init_MIDI_file", s);
+        s = MIDI_flatten(&mf, &flattened, &flat_size);
+        if (s)
+            fail("MIDI_flatten", s);
+        destroy_MIDI_file(&mf);
+        flat_data = flattened;
+    }
+    MIDI_flat flat;
+    s = init_MIDI_flat(flat_data, flat_size, &flat);
+    if (s)
+        fail("init_MIDI_flat", s);
+
+    std::vector<TimedMessage> messages;
+    for (size_t i = 0; i < flat.event_count; i++) {
+        const MIDI_flat_event *evt = &flat.events[i];
+        if (evt->type != ET_MIDI || evt->data_size > 2)
+            continue;
+        const uint8_t *data = MIDI_flat_event_data(&flat, evt);
+        TimedMessage tm;
+        tm.frame = MIDI_flat_event_sample(evt, sample_rate);
+        if (evt->data_size == 2)
+            tm.message = SmallMessage(evt->status_byte, data[0], data[1]);
+        else if (evt->data_size == 1)
+            tm.message = SmallMessage(evt->status_byte, data[0]);
+        else
+            tm.message = SmallMessage(evt->status_byte);
+        messages.push_back(tm);
+    }
+
+    free(flattened);
+    munmap(addr, st.st_size);
+    close(fd);
+    return messages;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "use: farm [-j threads] [-r rate] [-t tail-msec] "
+            "file[:patch] ...\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned threads = 0;
+    std::uint32_t sample_rate = 44100;
+    std::uint32_t tail_msec = 1000;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:r:t:")) != -1) {
+        switch (opt) {
+
+        case 'j':
+            threads = strtoul(optarg, NULL, 0);
+            break;
+
+        case 'r':
+            sample_rate = strtoul(optarg, NULL, 0);
+            break;
+
+        case 't':
+            tail_msec = strtoul(optarg, NULL, 0);
+            break;
+
+        default:
+            usage();
+        }
+    }
+    if (optind == argc || !sample_rate)
+        usage();
+
+    Config cfg;
+    cfg.set_sample_rate(sample_rate);
+    farm f(cfg);
+    f.thread_count(threads);
+
+    // Read each file and plan each patch once.  The maps own the
+    // shared data; jobs point into them.
+    std::map<std::string, std::vector<TimedMessage>> files;
+    std::map<size_t, std::vector<std::uint8_t>> plans;
+    std::vector<farm::Job> jobs;
+    for (int i = optind; i < argc; i++) {
+        std::string file_name = argv[i];
+        size_t patch = 0;
+        const char *colon = strrchr(argv[i], ':');
+        if (colon && colon[1]) {
+            char *end;
+            unsigned long n = strtoul(colon + 1, &end, 10);
+            if (!*end) {
+                file_name.resize(colon - argv[i]);
+                patch = n;
+            }
+        }
+
+        auto fi = files.find(file_name);
+        if (fi == files.end())
+            fi = files.emplace(file_name,
+                               read_messages(file_name.c_str(),
+                                             sample_rate)).first;
+        auto pi = plans.find(patch);
+        if (pi == plans.end())
+            pi = plans.emplace(patch, f.save_plan(patch)).first;
+
+        const auto& messages = fi->second;
+        std::uint64_t end = messages.empty() ? 0 : messages.back().frame;
+        end += std::uint64_t(tail_msec) * sample_rate / 1000;
+        jobs.push_back(farm::Job{
+            argv[i],
+            messages.data(),
+            messages.size(),
+            patch,
+            end,
+            pi->second.data(),
+            pi->second.size(),
+        });
+    }
+
+    auto report = f.run(jobs);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const auto& r = report.results[i];
+        printf("%016" PRIx64 " %8.3f s  %s\n",
+               r.hash, r.seconds, jobs[i].name.c_str());
+    }
+    printf("%zu job%s, %zu file%s, %" PRIu64 " frames in %.3f s: "
+           "%.0f frames/s, %.1fx real time\n",
+           jobs.size(), &"s"[jobs.size() == 1],
+           files.size(), &"s"[files.size() == 1],
+           report.frames, report.seconds,
+           report.frames_per_second(),
+           report.frames_per_second() / sample_rate);
+    return 0;
+}
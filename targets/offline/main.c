@@ -5,9 +5,11 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 
-#include "midi-file.h"
+#include "midi-flat.h"
+#include "midi-index.h"
 
 static MIDI_file mf;
+static uint32_t start_ticks;
 
 static bool is_text_event(const MIDI_event *evt)
 {
@@ -25,6 +27,69 @@ static bool is_text_event(const MIDI_event *evt)
     return false;
 }
 
+static void print_event(MIDI_event_type type,
+                        uint8_t status_byte,
+                        const uint8_t *data_bytes,
+                        size_t data_size)
+{
+    MIDI_event evt = {
+        .type = type,
+        .status_byte = status_byte,
+        .data_bytes = data_bytes,
+        .data_size = data_size,
+    };
+    printf("event %-7s %x", MIDI_event_name(evt.type), evt.status_byte);
+    if (is_text_event(&evt)) {
+        printf(" \"%.*s\"",
+               (int)evt.data_size, (const char *)evt.data_bytes);
+    } else {
+        for (size_t j = 0; j < evt.data_size; j++)
+            printf(" %x", evt.data_bytes[j]);
+    }
+    printf("\n");
+}
+
+// A flat event file needs no decoding.
+static void play_flat(const void *addr, size_t size)
+{
+    MIDI_flat flat;
+    MIDI_status s = init_MIDI_flat(addr, size, &flat);
+    if (s) {
+        fprintf(stderr, "init_MIDI_flat: %d %s, %s\n",
+                s, MIDI_status_name(s), MIDI_status_description(s));
+        exit(1);
+    }
+
+    printf("MIDI flat events, format %u\n", flat.header->format);
+    for (size_t i = 0; i < flat.event_count; i++) {
+        const MIDI_flat_event *evt = &flat.events[i];
+        print_event(evt->type,
+                    evt->status_byte,
+                    MIDI_flat_event_data(&flat, evt),
+                    evt->data_size);
+    }
+    printf("%zu events\n", flat.event_count);
+}
+
+// Print the controller state a player would send before starting.
+static void print_chase_state(const MIDI_chase_state *cs)
+{
+    printf("start at tick %u\n", cs->time_ticks);
+    for (int c = 0; c < MIDI_CHANNEL_COUNT; c++) {
+        const MIDI_channel_state *ch = &cs->channels[c];
+        if (ch->program != MIDI_UNSET)
+            printf("chase   %x %x\n", 0xC0 | c, ch->program);
+        for (int n = 0; n < MIDI_CONTROLLER_COUNT; n++)
+            if (ch->controllers[n] != MIDI_UNSET)
+                printf("chase   %x %x %x\n", 0xB0 | c, n, ch->controllers[n]);
+        if (ch->channel_pressure != MIDI_UNSET)
+            printf("chase   %x %x\n", 0xD0 | c, ch->channel_pressure);
+        if (ch->pitch_bend != MIDI_UNSET_14)
+            printf("chase   %x %x %x\n",
+                   0xE0 | c, ch->pitch_bend & 0x7F, ch->pitch_bend >> 7);
+    }
+}
+
 static void play_file(const char *file_name)
 {
     MIDI_status s;
@@ -49,6 +114,12 @@ static void play_file(const char *file_name)
         perror("mmap");
         exit(1);
     }
+    if (st.st_size >= 4 && *(const uint32_t *)addr == MIDI_FLAT_MAGIC) {
+        play_flat(addr, st.st_size);
+        munmap(addr, st.st_size);
+        close(fd);
+        return;
+    }
     s = init_MIDI_file(addr, st.st_size, &mf);
     if (s) {
         fprintf(stderr, "init_MIDI_file: %d %s, %s\n",
@@ -60,25 +131,32 @@ static void play_file(const char *file_name)
            mf.format, mf.track_count, &"s"[mf.track_count == 1]);
 
     MIDI_iterator it;
-    s = init_MIDI_file_iterator(&mf, &it);
-    if (s) {
-        fprintf(stderr, "init_MIDI_file_iterator: %d %s, %s\n",
-                s, MIDI_status_name(s), MIDI_status_description(s));
-        exit(1);
+    if (start_ticks) {
+        MIDI_index ix;
+        MIDI_chase_state cs;
+        s = init_MIDI_index(&mf, mf.division * 4, &ix);
+        if (!s)
+            s = MIDI_index_seek(&ix, start_ticks, &it, &cs);
+        if (s) {
+            fprintf(stderr, "MIDI_index_seek: %d %s, %s\n",
+                    s, MIDI_status_name(s), MIDI_status_description(s));
+            exit(1);
+        }
+        print_chase_state(&cs);
+        destroy_MIDI_index(&ix);
+    } else {
+        s = init_MIDI_file_iterator(&mf, &it);
+        if (s) {
+            fprintf(stderr, "init_MIDI_file_iterator: %d %s, %s\n",
+                    s, MIDI_status_name(s), MIDI_status_description(s));
+            exit(1);
+        }
     }
 
     MIDI_event evt;
     int i = 0;
     while (MIDI_iter_next(&it, &evt) != MIDI_ITER_END) {
-        printf("event %-7s %x", MIDI_event_name(evt.type), evt.status_byte);
-        if (is_text_event(&evt)) {
-            printf(" \"%*s\"",
-                   (int)evt.data_size, (const char *)evt.data_bytes);
-        } else {
-            for (size_t j = 0; j < evt.data_size; j++)
-                printf(" %x", evt.data_bytes[j]);
-        }
-        printf("\n");
+        print_event(evt.type, evt.status_byte, evt.data_bytes, evt.data_size);
         i++;
     }
     printf("%d events\n", i);
@@ -89,10 +167,23 @@ static void play_file(const char *file_name)
 
 int main(int argc, char *argv[])
 {
-    if (argc != 2) {
-        fprintf(stderr, "use: offline file.mid\n");
+    int opt;
+    while ((opt = getopt(argc, argv, "s:")) != -1) {
+        switch (opt) {
+
+        case 's':
+            start_ticks = strtoul(optarg, NULL, 0);
+            break;
+
+        default:
+            argc = 0;
+            break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "use: offline [-s start-tick] file.mid|file.mflat\n");
         exit(1);
     }
-    play_file(argv[1]);
+    play_file(argv[optind]);
     return 0;
 }
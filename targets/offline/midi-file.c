@@ -24,7 +24,7 @@ typedef struct cursor {
     size_t size;
 } cursor;
 
-static void init_cursor(const uint8_t *start, const uint8_t size, cursor *c)
+static void init_cursor(const uint8_t *start, size_t size, cursor *c)
 {
     c->start = start;
     c->pos = 0;
@@ -85,7 +85,7 @@ static bool cursor_read_i3(cursor *c, uint32_t *out)
     if (c->pos + 3 > c->size)
         return false;
     const uint8_t *p = c->start + c->pos;
-    uint16_t i = p[0] << 16 | p[1] << 8 | p[2];
+    uint32_t i = p[0] << 16 | p[1] << 8 | p[2];
     c->pos += 3;
     if (out)
         *out = i;
@@ -111,7 +111,7 @@ static bool cursor_read_vlq(cursor *c, uint32_t *out)
 {
     uint32_t vlq = 0;
     for (int i = 0; i < 4; i++) {
-        if (c->pos + i > c->size)
+        if (c->pos + i >= c->size)
             return false;
         uint8_t b = c->start[c->pos + i];
         vlq = vlq << 7 | (b & 0x7F);
@@ -243,8 +243,12 @@ static MIDI_status init_iterator(const MIDI_file *mf,
                                  MIDI_iterator *it_out)
 {
     MIDI_track_state *tracks = calloc(track_count, sizeof *tracks);
-    if (!tracks)
+    uint16_t *heap = calloc(track_count, sizeof *heap);
+    if (!tracks || !heap) {
+        free(tracks);
+        free(heap);
         return MS_NO_MEM;
+    }
 
     memset(it_out, 0, sizeof *it_out);
     it_out->file = mf;
@@ -259,9 +263,75 @@ static MIDI_status init_iterator(const MIDI_file *mf,
 
     it_out->track_count = track_count;
     it_out->tracks = tracks;
+    it_out->heap = heap;
+    it_out->heap_size = 0;
     return MS_OK;
 }
 
+// The iterator keeps the unfinished tracks in a binary min-heap
+// ordered by the time of each track's next event, so finding the
+// earliest event is O(1) and advancing a track is O(log tracks).
+// Ties go to the lowest numbered track, as if the tracks were
+// scanned in order.
+
+static bool track_precedes(const MIDI_iterator *it, uint16_t a, uint16_t b)
+{
+    uint32_t ta = it->tracks[a].time, tb = it->tracks[b].time;
+    return ta < tb || (ta == tb && a < b);
+}
+
+static void heap_sift_down(MIDI_iterator *it, size_t i)
+{
+    uint16_t *heap = it->heap;
+    size_t n = it->heap_size;
+    uint16_t item = heap[i];
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && track_precedes(it, heap[child + 1], heap[child]))
+            child++;
+        if (!track_precedes(it, heap[child], item))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = item;
+}
+
+static void heap_push(MIDI_iterator *it, uint16_t track)
+{
+    uint16_t *heap = it->heap;
+    size_t i = it->heap_size++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!track_precedes(it, track, heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = track;
+}
+
+static void heap_pop(MIDI_iterator *it)
+{
+    assert(it->heap_size);
+    it->heap[0] = it->heap[--it->heap_size];
+    if (it->heap_size)
+        heap_sift_down(it, 0);
+}
+
+// Read the delta time before a track's next event and make it
+// absolute.  A finished track's time is MIDI_ITER_END.
+static void advance_track_time(MIDI_track_state *track, uint32_t now)
+{
+    uint32_t delta = cursor_read_time(&track->cur);
+    if (delta == MIDI_ITER_END || now + delta < now)
+        track->time = MIDI_ITER_END;
+    else
+        track->time = now + delta;
+}
+
 MIDI_status init_MIDI_file_iterator(const MIDI_file *mf, MIDI_iterator *it_out)
 {
     if (mf->format != FORMAT_0 && mf->format != FORMAT_1)
@@ -276,7 +346,9 @@ MIDI_status init_MIDI_file_iterator(const MIDI_file *mf, MIDI_iterator *it_out)
         cursor *tc = &it_out->tracks[i].cur;
         const MIDI_track *track = &mf->tracks[i];
         init_cursor(track->start, track->size, tc);
-        it_out->tracks[i].time = cursor_read_time(tc);
+        advance_track_time(&it_out->tracks[i], 0);
+        if (it_out->tracks[i].time != MIDI_ITER_END)
+            heap_push(it_out, i);
     }
     return MS_OK;
 }
@@ -293,13 +365,16 @@ MIDI_status init_MIDI_track_iterator(const MIDI_file *mf,
     cursor *tc = &it_out->tracks[0].cur;
     const MIDI_track *track = &mf->tracks[track_no];
     init_cursor(track->start, track->size, tc);
-    it_out->tracks[0].time = cursor_read_time(tc);
+    advance_track_time(&it_out->tracks[0], 0);
+    if (it_out->tracks[0].time != MIDI_ITER_END)
+        heap_push(it_out, 0);
     return MS_OK;
 }
 
 void destroy_MIDI_iterator(MIDI_iterator *it)
 {
     free(it->tracks);
+    free(it->heap);
     memset(it, 0, sizeof *it);
 }
 
@@ -345,8 +420,10 @@ static void process_meta_event(const MIDI_event *evt,
     case 0x51:                  // FF 51 03 tttttt Set Tempo
                                 // (in microseconds per MIDI quarter-note)
         if (evt->data_size == 3) {
+            cursor dc;
             uint32_t tmp;
-            if (cursor_read_i3(&track->cur, &tmp))
+            init_cursor(evt->data_bytes, evt->data_size, &dc);
+            if (cursor_read_i3(&dc, &tmp))
                 it->timing.usec_per_quarter = tmp;
         }
         break;
@@ -449,39 +526,159 @@ static bool read_event(MIDI_iterator *it,
 
 uint32_t MIDI_iter_next(MIDI_iterator *it, MIDI_event *evt_out)
 {
-    do {
-
-        // Find track with earliest event.
-        // When tied, take lowest numbered track.
-        size_t best_i = 0;
-        uint32_t best_time = MIDI_ITER_END;
-        for (size_t i = 0; i < it->track_count; i++) {
-            uint32_t t = it->tracks[i].time;
-            if (best_time > t) {
-                best_time = t;
-                best_i = i;
-            }
-        }
+    while (it->heap_size) {
 
-        // All tracks are finished.
-        if (best_time == MIDI_ITER_END)
-            return MIDI_ITER_END;
+        // The heap's root is the track with the earliest event.
+        size_t best_i = it->heap[0];
+        MIDI_track_state *track = &it->tracks[best_i];
+        uint32_t best_time = track->time;
 
         // collect the next event.
-        MIDI_track_state *track = &it->tracks[best_i];
         if (read_event(it, track, evt_out)) {
             if (evt_out) {
                 evt_out->timestamp = best_time;
                 evt_out->track = best_i;
             }
-            uint32_t next_time = cursor_read_time(&track->cur);
-            it->tracks[best_i].time = next_time;
-            return next_time - best_time;
-        } else {
-            track->time = MIDI_ITER_END;
+            advance_track_time(track, best_time);
+            if (track->time == MIDI_ITER_END)
+                heap_pop(it);
+            else
+                heap_sift_down(it, 0);
+            uint32_t delta = best_time - it->time_ticks;
+            it->time_ticks = best_time;
+            return delta;
         }
 
-    } while (1);                // Failed to read event.  Try again.
+        // Failed to read event.  Drop the track and try again.
+        track->time = MIDI_ITER_END;
+        heap_pop(it);
+    }
+
+    // All tracks are finished.
+    return MIDI_ITER_END;
+}
+
+uint32_t MIDI_iter_peek_time(const MIDI_iterator *it)
+{
+    if (!it->heap_size)
+        return MIDI_ITER_END;
+    return it->tracks[it->heap[0]].time;
+}
+
+void MIDI_iter_save(const MIDI_iterator *it,
+                    MIDI_track_position *positions_out)
+{
+    for (size_t i = 0; i < it->track_count; i++) {
+        const MIDI_track_state *track = &it->tracks[i];
+        MIDI_track_position *pos = &positions_out[i];
+        pos->offset = track->cur.pos;
+        pos->time = track->time;
+        pos->running_status = track->running_status;
+        pos->channel = track->channel;
+    }
+}
+
+void MIDI_iter_restore(MIDI_iterator *it,
+                       uint32_t time_ticks,
+                       const MIDI_timing *timing,
+                       const MIDI_track_position *positions)
+{
+    it->timing = *timing;
+    it->time_ticks = time_ticks;
+    it->heap_size = 0;
+    for (size_t i = 0; i < it->track_count; i++) {
+        MIDI_track_state *track = &it->tracks[i];
+        const MIDI_track_position *pos = &positions[i];
+        track->cur.pos = pos->offset;
+        if (track->cur.pos > track->cur.size)
+            track->cur.pos = track->cur.size;
+        track->time = pos->time;
+        track->running_status = pos->running_status;
+        track->channel = pos->channel;
+        if (track->time != MIDI_ITER_END)
+            heap_push(it, i);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// tempo map
+
+static bool is_smpte(uint16_t division)
+{
+    return division & 0x8000;
+}
+
+// SMPTE division is -frames/second in the high byte and ticks/frame
+// in the low byte.
+static uint64_t smpte_ticks_per_sec(uint16_t division)
+{
+    uint64_t fps = (uint8_t)-(int8_t)(division >> 8);
+    uint64_t tpf = division & 0xFF;
+    return fps * tpf;
+}
+
+// Find the last change at or before `ticks`.
+static const MIDI_tempo_change *find_change_ticks(const MIDI_tempo_change *map,
+                                                  size_t count,
+                                                  uint32_t ticks)
+{
+    size_t lo = 0, hi = count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (map[mid].time_ticks <= ticks)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return &map[lo];
+}
+
+// Find the last change at or before `usecs`.
+static const MIDI_tempo_change *find_change_usecs(const MIDI_tempo_change *map,
+                                                  size_t count,
+                                                  uint64_t usecs)
+{
+    size_t lo = 0, hi = count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (map[mid].time_usecs <= usecs)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return &map[lo];
+}
+
+uint64_t MIDI_tempo_ticks_to_usecs(uint16_t division,
+                                   const MIDI_tempo_change *map,
+                                   size_t count,
+                                   uint32_t ticks)
+{
+    if (is_smpte(division)) {
+        uint64_t tps = smpte_ticks_per_sec(division);
+        return tps ? ticks * UINT64_C(1000000) / tps : 0;
+    }
+    if (!count || !division)
+        return 0;
+    const MIDI_tempo_change *c = find_change_ticks(map, count, ticks);
+    uint64_t dt = ticks - c->time_ticks;
+    return c->time_usecs + dt * c->usec_per_quarter / division;
+}
+
+uint32_t MIDI_tempo_usecs_to_ticks(uint16_t division,
+                                   const MIDI_tempo_change *map,
+                                   size_t count,
+                                   uint64_t usecs)
+{
+    if (is_smpte(division))
+        return usecs * smpte_ticks_per_sec(division) / 1000000;
+    if (!count || !map[0].usec_per_quarter)
+        return 0;
+    const MIDI_tempo_change *c = find_change_usecs(map, count, usecs);
+    if (!c->usec_per_quarter)
+        return c->time_ticks;
+    uint64_t du = usecs - c->time_usecs;
+    return c->time_ticks + du * division / c->usec_per_quarter;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -500,6 +697,8 @@ static struct {
     E(MS_INVALID_TRACK_COUNT, "Format 0 file must have one track.")
     E(MS_NOT_ITERABLE, "Format 2 file can't be iterated.")
     E(MS_UNPARSEABLE, "Track data can't be parsed.")
+    E(MS_NOT_FLAT_FILE, "File does not have \"MFLT\" signature.")
+    E(MS_FLAT_VERSION, "Flat file version or byte order differs.")
 #undef E
 };
 const size_t status_strings_size = (&status_strings)[1] - status_strings;
@@ -14,6 +14,8 @@ typedef enum MIDI_status {
     MS_INVALID_TRACK_COUNT,     // Format 0 file must have one track.
     MS_NOT_ITERABLE,            // Format 2 file can't be iterated.
     MS_UNPARSEABLE,             // Track data can't be parsed.
+    MS_NOT_FLAT_FILE,           // File does not have "MFLT" signature.
+    MS_FLAT_VERSION,            // Flat file version or byte order differs.
     MIDI_status_count
 } MIDI_status;
 
@@ -81,6 +83,24 @@ typedef struct MIDI_timing {
     uint8_t             sig_bb;
 } MIDI_timing;
 
+// A tempo map is an array of tempo changes sorted by time.  The
+// first change is at tick 0.  In SMPTE timed files (division < 0),
+// the tempo is ignored.
+typedef struct MIDI_tempo_change {
+    uint64_t            time_usecs;
+    uint32_t            time_ticks;
+    uint32_t            usec_per_quarter;
+} MIDI_tempo_change;
+
+extern uint64_t MIDI_tempo_ticks_to_usecs(uint16_t division,
+                                          const MIDI_tempo_change *map,
+                                          size_t count,
+                                          uint32_t ticks);
+extern uint32_t MIDI_tempo_usecs_to_ticks(uint16_t division,
+                                          const MIDI_tempo_change *map,
+                                          size_t count,
+                                          uint64_t usecs);
+
 typedef struct MIDI_track_state MIDI_track_state;
 
 typedef struct MIDI_iterator {
@@ -90,6 +110,8 @@ typedef struct MIDI_iterator {
     uint64_t            time_usecs;
     size_t              track_count;
     MIDI_track_state   *tracks;
+    uint16_t           *heap;           // unfinished tracks by next time
+    size_t              heap_size;
     // MIDI_cursor        *track_cursors;
     // uint32_t           *track_times;
 } MIDI_iterator;
@@ -101,10 +123,34 @@ extern MIDI_status init_MIDI_track_iterator(const MIDI_file *,
                                             MIDI_iterator *it_out);
 extern void destroy_MIDI_iterator(MIDI_iterator *);
 
-// MIDI_iter_next returns the relative taim (in microseconds) until
-// the event.
+// A track's saved iterator position.
+typedef struct MIDI_track_position {
+    uint32_t            offset;         // from start of track data
+    uint32_t            time;           // next event, MIDI_ITER_END if none
+    uint8_t             running_status;
+    uint8_t             channel;
+} MIDI_track_position;
+
+// MIDI_iter_save stores each track's position in positions_out,
+// which has room for it->track_count positions.  MIDI_iter_restore
+// returns an iterator over the same file to a saved position.
+extern void MIDI_iter_save(const MIDI_iterator *,
+                           MIDI_track_position *positions_out);
+extern void MIDI_iter_restore(MIDI_iterator *,
+                              uint32_t time_ticks,
+                              const MIDI_timing *,
+                              const MIDI_track_position *);
+
+// MIDI_iter_next returns the relative time (in ticks) until the
+// event, i.e., since the previous event.  Event timestamps are in
+// ticks from the start of the file.  Events from different tracks
+// are merged in time order; simultaneous events come in track order.
 // If the iteration is finished, MIDI_iter_next returns MIDI_ITER_END.
 #define MIDI_ITER_END UINT32_MAX
 extern uint32_t MIDI_iter_next(MIDI_iterator *, MIDI_event *);
 
+// MIDI_iter_peek_time returns the time (in ticks) of the next event
+// or MIDI_ITER_END.
+extern uint32_t MIDI_iter_peek_time(const MIDI_iterator *);
+
 #endif /* !MIDI_FILE_included */
@@ -0,0 +1,172 @@
+#include "midi-flat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN8(n) (((n) + 7) & ~(size_t)7)
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDI_flatten
+
+static bool is_tempo_event(const MIDI_event *evt)
+{
+    return evt->type == ET_META &&
+           evt->status_byte == 0x51 &&
+           evt->data_size == 3;
+}
+
+typedef struct sizes {
+    size_t              event_count;
+    size_t              tempo_count;    // upper bound
+    size_t              data_size;
+} sizes;
+
+static MIDI_status count_events(const MIDI_file *mf, sizes *out)
+{
+    MIDI_iterator it;
+    MIDI_status s = init_MIDI_file_iterator(mf, &it);
+    if (s)
+        return s;
+    memset(out, 0, sizeof *out);
+    out->tempo_count = 1;
+    MIDI_event evt;
+    while (MIDI_iter_next(&it, &evt) != MIDI_ITER_END) {
+        out->event_count++;
+        out->data_size += evt.data_size;
+        if (is_tempo_event(&evt))
+            out->tempo_count++;
+    }
+    destroy_MIDI_iterator(&it);
+    if (out->data_size > UINT32_MAX)
+        return MS_UNPARSEABLE;
+    return MS_OK;
+}
+
+MIDI_status MIDI_flatten(const MIDI_file *mf, void **data_out, size_t *size_out)
+{
+    sizes sz;
+    MIDI_status s = count_events(mf, &sz);
+    if (s)
+        return s;
+
+    size_t events_offset = ALIGN8(sizeof (MIDI_flat_header));
+    size_t tempos_offset =
+        ALIGN8(events_offset + sz.event_count * sizeof (MIDI_flat_event));
+    size_t data_offset =
+        ALIGN8(tempos_offset + sz.tempo_count * sizeof (MIDI_flat_tempo));
+    size_t size = ALIGN8(data_offset + sz.data_size);
+
+    uint8_t *base = calloc(1, size);
+    if (!base)
+        return MS_NO_MEM;
+    MIDI_flat_header *hdr = (MIDI_flat_header *)base;
+    MIDI_flat_event *events = (MIDI_flat_event *)(base + events_offset);
+    MIDI_flat_tempo *tempos = (MIDI_flat_tempo *)(base + tempos_offset);
+    uint8_t *data = base + data_offset;
+
+    MIDI_iterator it;
+    s = init_MIDI_file_iterator(mf, &it);
+    if (s) {
+        free(base);
+        return s;
+    }
+
+    // Event times are computed from the start of the current tempo
+    // segment, so rounding errors don't accumulate.
+    MIDI_tempo_change seg = { 0, 0, it.timing.usec_per_quarter };
+    size_t tempo_count = 1;
+    tempos[0] = seg;
+
+    size_t n = 0, data_pos = 0;
+    MIDI_event evt;
+    while (n < sz.event_count &&
+           MIDI_iter_next(&it, &evt) != MIDI_ITER_END) {
+        MIDI_flat_event *fe = &events[n++];
+        fe->time_ticks = evt.timestamp;
+        fe->time_usecs =
+            MIDI_tempo_ticks_to_usecs(mf->division, &seg, 1, evt.timestamp);
+        fe->data_offset = data_pos;
+        fe->data_size = evt.data_size;
+        fe->track = evt.track;
+        fe->type = evt.type;
+        fe->status_byte = evt.status_byte;
+        memcpy(data + data_pos, evt.data_bytes, evt.data_size);
+        data_pos += evt.data_size;
+
+        if (is_tempo_event(&evt) && !(mf->division & 0x8000)) {
+            seg.time_usecs = fe->time_usecs;
+            seg.time_ticks = fe->time_ticks;
+            seg.usec_per_quarter = it.timing.usec_per_quarter;
+            if (tempos[tempo_count - 1].time_ticks != seg.time_ticks)
+                tempo_count++;
+            tempos[tempo_count - 1] = seg;
+        }
+    }
+    destroy_MIDI_iterator(&it);
+
+    hdr->magic = MIDI_FLAT_MAGIC;
+    hdr->version = MIDI_FLAT_VERSION;
+    hdr->format = mf->format;
+    hdr->division = mf->division;
+    hdr->tempo_count = tempo_count;
+    hdr->event_count = n;
+    hdr->events_offset = events_offset;
+    hdr->tempos_offset = tempos_offset;
+    hdr->data_offset = data_offset;
+    hdr->data_size = data_pos;
+
+    *data_out = base;
+    *size_out = size;
+    return MS_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDI_flat
+
+// Is [offset, offset + count * item_size) inside the file?
+static bool section_fits(uint64_t offset,
+                         uint64_t count,
+                         size_t item_size,
+                         size_t file_size)
+{
+    if (offset % 8 || offset > file_size)
+        return false;
+    return count <= (file_size - offset) / item_size;
+}
+
+MIDI_status init_MIDI_flat(const void *data, size_t size, MIDI_flat *flat_out)
+{
+    const MIDI_flat_header *hdr = data;
+    if (size < sizeof *hdr)
+        return MS_FILE_TRUNCATED;
+    if (hdr->magic == MIDI_FLAT_MAGIC_SWAPPED)
+        return MS_FLAT_VERSION;
+    if (hdr->magic != MIDI_FLAT_MAGIC)
+        return MS_NOT_FLAT_FILE;
+    if (hdr->version != MIDI_FLAT_VERSION)
+        return MS_FLAT_VERSION;
+    if (!section_fits(hdr->events_offset, hdr->event_count,
+                      sizeof (MIDI_flat_event), size) ||
+        !section_fits(hdr->tempos_offset, hdr->tempo_count,
+                      sizeof (MIDI_flat_tempo), size) ||
+        !section_fits(hdr->data_offset, hdr->data_size, 1, size))
+        return MS_FILE_TRUNCATED;
+
+    const uint8_t *base = data;
+    flat_out->header = hdr;
+    flat_out->event_count = hdr->event_count;
+    flat_out->events = (const MIDI_flat_event *)(base + hdr->events_offset);
+    flat_out->tempo_count = hdr->tempo_count;
+    flat_out->tempos = (const MIDI_flat_tempo *)(base + hdr->tempos_offset);
+    flat_out->data_size = hdr->data_size;
+    flat_out->data = base + hdr->data_offset;
+    return MS_OK;
+}
+
+uint64_t MIDI_flat_ticks_to_usecs(const MIDI_flat *flat, uint32_t ticks)
+{
+    return MIDI_tempo_ticks_to_usecs(flat->header->division,
+                                     flat->tempos,
+                                     flat->tempo_count,
+                                     ticks);
+}
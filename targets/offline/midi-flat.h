@@ -0,0 +1,91 @@
+#ifndef MIDI_FLAT_included
+#define MIDI_FLAT_included
+
+#include "midi-file.h"
+
+// A flat event file is a MIDI file converted once into a sorted
+// array of fixed size events with absolute times, so it can be
+// mapped into memory and played with no decoding.
+//
+//     header          MIDI_flat_header
+//     events          MIDI_flat_event[event_count]
+//     tempo map       MIDI_flat_tempo[tempo_count]
+//     data            uint8_t[data_size]
+//
+// Each event's data bytes are in the data section.  The file is in
+// the native byte order of the machine that wrote it; a file with
+// the other byte order is rejected.  Sections start on 8 byte
+// boundaries.
+
+#define MIDI_FLAT_MAGIC         0x544c464d      // "MFLT" on little-endian
+#define MIDI_FLAT_MAGIC_SWAPPED 0x4d464c54
+#define MIDI_FLAT_VERSION       1
+
+typedef struct MIDI_flat_header {
+    uint32_t            magic;
+    uint16_t            version;
+    uint16_t            format;         // format of the original file
+    uint16_t            division;
+    uint16_t            reserved;
+    uint32_t            tempo_count;
+    uint64_t            event_count;
+    uint64_t            events_offset;
+    uint64_t            tempos_offset;
+    uint64_t            data_offset;
+    uint64_t            data_size;
+} MIDI_flat_header;
+
+// A channel event's channel is in its status byte.  Meta events'
+// status byte is the meta event type, e.g., 0x51 for Set Tempo.
+typedef struct MIDI_flat_event {
+    uint64_t            time_usecs;
+    uint32_t            time_ticks;
+    uint32_t            data_offset;    // from start of data section
+    uint32_t            data_size;
+    uint16_t            track;
+    uint8_t             type;           // MIDI_event_type
+    uint8_t             status_byte;
+} MIDI_flat_event;
+
+// The tempo map has an entry at tick 0 and one for each tempo
+// change.  SMPTE timed files have only the first entry.
+typedef MIDI_tempo_change MIDI_flat_tempo;
+
+typedef struct MIDI_flat {
+    const MIDI_flat_header *header;
+    size_t              event_count;
+    const MIDI_flat_event *events;
+    size_t              tempo_count;
+    const MIDI_flat_tempo *tempos;
+    size_t              data_size;
+    const uint8_t      *data;
+} MIDI_flat;
+
+// Convert a format 0 or 1 MIDI file.  On success, *data_out is a
+// malloc'd flat event file of *size_out bytes.
+extern MIDI_status MIDI_flatten(const MIDI_file *,
+                                void **data_out,
+                                size_t *size_out);
+
+// Check a flat event file's header and find its sections.  The
+// events are not checked, so the file should come from MIDI_flatten.
+extern MIDI_status init_MIDI_flat(const void *data,
+                                  size_t size,
+                                  MIDI_flat *flat_out);
+
+// Convert ticks to microseconds using the tempo map.
+extern uint64_t MIDI_flat_ticks_to_usecs(const MIDI_flat *, uint32_t ticks);
+
+static inline const uint8_t *MIDI_flat_event_data(const MIDI_flat *flat,
+                                                  const MIDI_flat_event *evt)
+{
+    return flat->data + evt->data_offset;
+}
+
+static inline uint64_t MIDI_flat_event_sample(const MIDI_flat_event *evt,
+                                              uint32_t sample_rate)
+{
+    return evt->time_usecs * sample_rate / 1000000;
+}
+
+#endif /* !MIDI_FLAT_included */
@@ -0,0 +1,79 @@
+// Convert a Standard MIDI File to a flat event file.  See midi-flat.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "midi-flat.h"
+
+static void fail(const char *what, MIDI_status s)
+{
+    fprintf(stderr, "%s: %d %s, %s\n",
+            what, s, MIDI_status_name(s), MIDI_status_description(s));
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "use: midi-flatten file.mid file.mflat\n");
+        exit(1);
+    }
+    const char *in_name = argv[1], *out_name = argv[2];
+
+    int fd = open(in_name, O_RDONLY);
+    if (fd < 0) {
+        perror(in_name);
+        exit(1);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror(in_name);
+        exit(1);
+    }
+    void *addr = mmap(NULL,
+                      st.st_size,
+                      PROT_READ,
+                      MAP_FILE | MAP_PRIVATE,
+                      fd,
+                      0);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+
+    MIDI_file mf;
+    MIDI_status s = init_MIDI_file(addr, st.st_size, &mf);
+    if (s)
+        fail("init_MIDI_file", s);
+    void *flat;
+    size_t flat_size;
+    s = MIDI_flatten(&mf, &flat, &flat_size);
+    if (s)
+        fail("MIDI_flatten", s);
+
+    FILE *out = fopen(out_name, "wb");
+    if (!out) {
+        perror(out_name);
+        exit(1);
+    }
+    if (fwrite(flat, 1, flat_size, out) != flat_size || fclose(out)) {
+        perror(out_name);
+        exit(1);
+    }
+
+    const MIDI_flat_header *hdr = flat;
+    printf("%s: %lu events, %u tempo%s, %lu bytes\n",
+           out_name, (unsigned long)hdr->event_count,
+           hdr->tempo_count, &"s"[hdr->tempo_count == 1],
+           (unsigned long)flat_size);
+
+    free(flat);
+    destroy_MIDI_file(&mf);
+    munmap(addr, st.st_size);
+    close(fd);
+    return 0;
+}
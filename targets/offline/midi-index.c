@@ -0,0 +1,226 @@
+#include "midi-index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDI_chase_state
+
+static void init_chase_state(const MIDI_timing *timing, MIDI_chase_state *cs)
+{
+    memset(cs, 0, sizeof *cs);
+    cs->timing = *timing;
+    for (size_t i = 0; i < MIDI_CHANNEL_COUNT; i++) {
+        MIDI_channel_state *ch = &cs->channels[i];
+        memset(ch->controllers, MIDI_UNSET, sizeof ch->controllers);
+        ch->program = MIDI_UNSET;
+        ch->channel_pressure = MIDI_UNSET;
+        ch->pitch_bend = MIDI_UNSET_14;
+    }
+}
+
+void MIDI_chase_event(MIDI_chase_state *cs, const MIDI_event *evt)
+{
+    if (evt->type != ET_MIDI || !evt->data_size)
+        return;
+    MIDI_channel_state *ch = &cs->channels[evt->status_byte & 0x0F];
+    const uint8_t *d = evt->data_bytes;
+    switch (evt->status_byte & 0xF0) {
+
+    case 0xB0:                  // Control Change
+        if (evt->data_size == 2)
+            ch->controllers[d[0] & 0x7F] = d[1];
+        break;
+
+    case 0xC0:                  // Program Change
+        ch->program = d[0];
+        break;
+
+    case 0xD0:                  // Channel Pressure
+        ch->channel_pressure = d[0];
+        break;
+
+    case 0xE0:                  // Pitch Bend
+        if (evt->data_size == 2)
+            ch->pitch_bend = d[1] << 7 | d[0];
+        break;
+
+    default:
+        break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDI_index
+
+// Make room for `need` items in a malloc'd array.
+static bool reserve(void **array, size_t *alloc, size_t need, size_t size)
+{
+    if (need <= *alloc)
+        return true;
+    size_t n = *alloc ? 2 * *alloc : 16;
+    while (n < need)
+        n *= 2;
+    void *p = realloc(*array, n * size);
+    if (!p)
+        return false;
+    *array = p;
+    *alloc = n;
+    return true;
+}
+
+static bool add_checkpoint(MIDI_index *ix,
+                           size_t *cp_alloc,
+                           size_t *pos_alloc,
+                           const MIDI_iterator *it,
+                           const MIDI_chase_state *cs,
+                           uint32_t ticks)
+{
+    size_t track_count = it->track_count;
+    size_t n = ix->checkpoint_count;
+    if (!reserve((void **)&ix->checkpoints, cp_alloc, n + 1,
+                 sizeof *ix->checkpoints) ||
+        !reserve((void **)&ix->positions, pos_alloc, (n + 1) * track_count,
+                 sizeof *ix->positions))
+        return false;
+    MIDI_checkpoint *cp = &ix->checkpoints[n];
+    cp->state = *cs;
+    cp->state.time_ticks = ticks;
+    cp->state.timing = it->timing;
+    cp->positions = n * track_count;
+    MIDI_iter_save(it, &ix->positions[cp->positions]);
+    ix->checkpoint_count++;
+    return true;
+}
+
+static bool add_tempo_change(MIDI_index *ix,
+                             size_t *tempo_alloc,
+                             uint32_t ticks,
+                             uint32_t usec_per_quarter)
+{
+    uint16_t division = ix->file->division;
+    MIDI_tempo_change c = {
+        MIDI_tempo_ticks_to_usecs(division, ix->tempos, ix->tempo_count, ticks),
+        ticks,
+        usec_per_quarter,
+    };
+    if (ix->tempo_count && ix->tempos[ix->tempo_count - 1].time_ticks == ticks)
+        ix->tempo_count--;
+    if (!reserve((void **)&ix->tempos, tempo_alloc, ix->tempo_count + 1,
+                 sizeof *ix->tempos))
+        return false;
+    ix->tempos[ix->tempo_count++] = c;
+    return true;
+}
+
+MIDI_status init_MIDI_index(const MIDI_file *mf,
+                            uint32_t interval_ticks,
+                            MIDI_index *ix_out)
+{
+    memset(ix_out, 0, sizeof *ix_out);
+    ix_out->file = mf;
+    ix_out->interval_ticks = interval_ticks ? interval_ticks : 1;
+
+    MIDI_iterator it;
+    MIDI_status s = init_MIDI_file_iterator(mf, &it);
+    if (s)
+        return s;
+
+    size_t cp_alloc = 0, pos_alloc = 0, tempo_alloc = 0;
+    MIDI_chase_state cs;
+    init_chase_state(&it.timing, &cs);
+    bool ok = add_tempo_change(ix_out, &tempo_alloc, 0,
+                               it.timing.usec_per_quarter) &&
+              add_checkpoint(ix_out, &cp_alloc, &pos_alloc, &it, &cs, 0);
+
+    uint32_t next_checkpoint = ix_out->interval_ticks;
+    uint32_t t;
+    while (ok && (t = MIDI_iter_peek_time(&it)) != MIDI_ITER_END) {
+
+        // Checkpoint before the first event at or after each interval.
+        if (t >= next_checkpoint) {
+            uint32_t cp_ticks = t - t % ix_out->interval_ticks;
+            ok = add_checkpoint(ix_out, &cp_alloc, &pos_alloc,
+                                &it, &cs, cp_ticks);
+            next_checkpoint = cp_ticks + ix_out->interval_ticks;
+            if (next_checkpoint < cp_ticks)
+                next_checkpoint = MIDI_ITER_END;
+        }
+
+        uint32_t tempo = it.timing.usec_per_quarter;
+        MIDI_event evt;
+        if (MIDI_iter_next(&it, &evt) == MIDI_ITER_END)
+            break;
+        MIDI_chase_event(&cs, &evt);
+        if (it.timing.usec_per_quarter != tempo)
+            ok = add_tempo_change(ix_out, &tempo_alloc, evt.timestamp,
+                                  it.timing.usec_per_quarter);
+    }
+    destroy_MIDI_iterator(&it);
+
+    if (!ok) {
+        destroy_MIDI_index(ix_out);
+        return MS_NO_MEM;
+    }
+    return MS_OK;
+}
+
+void destroy_MIDI_index(MIDI_index *ix)
+{
+    free(ix->checkpoints);
+    free(ix->positions);
+    free(ix->tempos);
+    memset(ix, 0, sizeof *ix);
+}
+
+MIDI_status MIDI_index_seek(const MIDI_index *ix,
+                            uint32_t ticks,
+                            MIDI_iterator *it_out,
+                            MIDI_chase_state *state_out)
+{
+    // Find the last checkpoint at or before `ticks`.
+    size_t lo = 0, hi = ix->checkpoint_count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ix->checkpoints[mid].state.time_ticks <= ticks)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const MIDI_checkpoint *cp = &ix->checkpoints[lo];
+
+    MIDI_status s = init_MIDI_file_iterator(ix->file, it_out);
+    if (s)
+        return s;
+    MIDI_iter_restore(it_out,
+                      cp->state.time_ticks,
+                      &cp->state.timing,
+                      &ix->positions[cp->positions]);
+    *state_out = cp->state;
+
+    // Play forward to the seek time.
+    MIDI_event evt;
+    while (MIDI_iter_peek_time(it_out) < ticks &&
+           MIDI_iter_next(it_out, &evt) != MIDI_ITER_END)
+        MIDI_chase_event(state_out, &evt);
+    it_out->time_ticks = ticks;
+    state_out->time_ticks = ticks;
+    state_out->timing = it_out->timing;
+    return MS_OK;
+}
+
+uint64_t MIDI_index_ticks_to_usecs(const MIDI_index *ix, uint32_t ticks)
+{
+    return MIDI_tempo_ticks_to_usecs(ix->file->division,
+                                     ix->tempos,
+                                     ix->tempo_count,
+                                     ticks);
+}
+
+uint32_t MIDI_index_usecs_to_ticks(const MIDI_index *ix, uint64_t usecs)
+{
+    return MIDI_tempo_usecs_to_ticks(ix->file->division,
+                                     ix->tempos,
+                                     ix->tempo_count,
+                                     usecs);
+}
@@ -0,0 +1,69 @@
+#ifndef MIDI_INDEX_included
+#define MIDI_INDEX_included
+
+#include "midi-file.h"
+
+// A seek index lets a player start in the middle of a MIDI file
+// without iterating from tick 0.  It is built in one pass and holds
+// checkpoints at regular intervals: each track's iterator position,
+// the timing state, and each channel's controllers, program,
+// pressure, and pitch bend.  It also holds the tempo map.
+//
+// MIDI_index_seek finds the checkpoint before the seek time,
+// restores it, and plays forward to the seek time, updating the
+// channel state.  Notes are not chased.
+
+#define MIDI_CHANNEL_COUNT      16
+#define MIDI_CONTROLLER_COUNT   128
+#define MIDI_UNSET              0xFF        // value was never sent
+#define MIDI_UNSET_14           0xFFFF      // 14 bit value was never sent
+
+typedef struct MIDI_channel_state {
+    uint8_t             controllers[MIDI_CONTROLLER_COUNT];
+    uint8_t             program;
+    uint8_t             channel_pressure;
+    uint16_t            pitch_bend;
+} MIDI_channel_state;
+
+typedef struct MIDI_chase_state {
+    uint32_t            time_ticks;
+    MIDI_timing         timing;
+    MIDI_channel_state  channels[MIDI_CHANNEL_COUNT];
+} MIDI_chase_state;
+
+typedef struct MIDI_checkpoint {
+    MIDI_chase_state    state;
+    size_t              positions;      // index of first track position
+} MIDI_checkpoint;
+
+typedef struct MIDI_index {
+    const MIDI_file    *file;
+    uint32_t            interval_ticks;
+    size_t              checkpoint_count;
+    MIDI_checkpoint    *checkpoints;
+    MIDI_track_position *positions;     // track_count per checkpoint
+    size_t              tempo_count;
+    MIDI_tempo_change  *tempos;
+} MIDI_index;
+
+// Index a format 0 or 1 file with a checkpoint every interval_ticks.
+extern MIDI_status init_MIDI_index(const MIDI_file *,
+                                   uint32_t interval_ticks,
+                                   MIDI_index *ix_out);
+extern void destroy_MIDI_index(MIDI_index *);
+
+// Initialize *it_out to iterate from the first event at or after
+// `ticks`, and set *state_out to the state at that time.  Destroy
+// the iterator with destroy_MIDI_iterator.
+extern MIDI_status MIDI_index_seek(const MIDI_index *,
+                                   uint32_t ticks,
+                                   MIDI_iterator *it_out,
+                                   MIDI_chase_state *state_out);
+
+// Update a chase state with an event.
+extern void MIDI_chase_event(MIDI_chase_state *, const MIDI_event *);
+
+extern uint64_t MIDI_index_ticks_to_usecs(const MIDI_index *, uint32_t ticks);
+extern uint32_t MIDI_index_usecs_to_ticks(const MIDI_index *, uint64_t usecs);
+
+#endif /* !MIDI_INDEX_included */
@@ -0,0 +1,44 @@
+#ifndef STATIC_BEEP_included
+#define STATIC_BEEP_included
+
+#include <tuple>
+
+#include "synth/core/config.h"
+#include "synth/core/static-pipeline.h"
+#include "synth/osc/naive-square.h"
+
+// StaticBeep is SimpleBeep as a StaticPipeline: the same square wave
+// into the same output module, planned at compile time.  It has no
+// Synth, so it renders itself.
+
+template <class OutputModule>
+class StaticBeep {
+
+public:
+
+    StaticBeep(const Config& cfg, const OutputModule& out)
+    : m_pipeline{NaiveSquare(), out}
+    {
+        m_pipeline.template link<1>().scale = 440;
+        m_pipeline.configure(cfg);
+    }
+    StaticBeep(const StaticBeep&) = delete;
+    StaticBeep& operator = (const StaticBeep&) = delete;
+
+    void render(size_t frame_count) { m_pipeline.render(frame_count); }
+
+private:
+
+    typedef StaticPipeline<
+        std::tuple<NaiveSquare, OutputModule>,
+        std::tuple<
+            StaticLink<STATIC_PORT(1, OutputModule, in),
+                       STATIC_PORT(0, NaiveSquare, out)>,
+            ScaledLink<STATIC_PORT(0, NaiveSquare, freq)>
+        >> pipeline;
+
+    pipeline m_pipeline;
+
+};
+
+#endif /* !STATIC_BEEP_included */
@@ -1,7 +1,13 @@
 #include "simple-beep.h"
 
+#include <algorithm>
+#include <vector>
+
 #include <cxxtest/TestSuite.h>
 
+#include "synth/core/recorder.h"
+#include "targets/simple-beep/static-beep.h"
+
 class simple_beep_unit_test : public CxxTest::TestSuite {
 
 public:
@@ -21,4 +27,26 @@ public:
         (void)SimpleBeep(cfg, out);
     }
 
+    void test_static_beep()
+    {
+        // StaticBeep renders the same samples as SimpleBeep.
+        const size_t frame_count = 3 * MAX_FRAMES + 5;
+        Config cfg;
+        cfg.set_sample_rate(44100);
+        std::vector<float> expected(frame_count), actual(frame_count);
+        Recorder out1(expected.data(), frame_count);
+        Recorder out2(actual.data(), frame_count);
+        SimpleBeep beep(cfg, out1);
+        StaticBeep<Recorder> static_beep(cfg, out2);
+        Timbre& t = beep.synth().timbres().front();
+        for (size_t frame = 0, n; frame < frame_count; frame += n) {
+            n = std::min<size_t>(MAX_FRAMES, frame_count - frame);
+            t.pre_render(n);
+            t.post_render(n);
+            static_beep.render(n);
+        }
+        TS_ASSERT_EQUALS(actual, expected);
+        TS_ASSERT_EQUALS(expected[0], 1);
+    }
+
 };